@@ -0,0 +1,227 @@
+/***************************************************************************//**
+ * @file
+ * @brief Asynchronous memory copy on the LDMA
+ * Moves large buffers with a DMADRV channel so the CPU can do other work or
+ * sleep in EM1 meanwhile. Small requests are copied by the CPU right away.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "em_core.h"
+#include "dmadrv.h"
+#include "sleep.h"
+#include "dma_copy.h"
+
+typedef struct {
+  uint8_t *dst;
+  // NULL for a fill
+  const uint8_t *src;
+  // Fill pattern, the byte value in every byte of the word
+  uint32_t value;
+  // Bytes not transferred yet
+  uint32_t len;
+  dma_copy_callback_t callback;
+  void *user;
+} dma_copy_request_t;
+
+// Requests in order, the one at head is running on the DMA
+static dma_copy_request_t queue[DMA_COPY_QUEUE_LEN];
+static uint32_t head = 0;
+static volatile uint32_t count = 0;
+static unsigned int channel;
+static bool dma_ready = false;
+// A transfer is running on the DMA, it moves chunk_len bytes
+static volatile bool busy = false;
+static uint32_t chunk_len = 0;
+
+static void dma_copy_start();
+static dma_copy_callback_t dma_copy_pop(void **user);
+static bool dma_copy_chunk(dma_copy_request_t *req);
+static bool dma_copy_transfer_done(unsigned int channel, unsigned int sequenceNo,
+                                   void *userParam);
+static bool dma_copy_request(void *dst, const void *src, uint8_t value, uint32_t len,
+                             dma_copy_callback_t callback, void *user);
+
+bool dma_copy_init()
+{
+  Ecode_t ret = DMADRV_Init();
+
+  if (ret != ECODE_EMDRV_DMADRV_OK && ret != ECODE_EMDRV_DMADRV_ALREADY_INITIALIZED) {
+    return false;
+  }
+  dma_ready = (DMADRV_AllocateChannel(&channel, NULL) == ECODE_EMDRV_DMADRV_OK);
+  return dma_ready;
+}
+
+bool dma_copy_memcpy(void *dst, const void *src, uint32_t len,
+                     dma_copy_callback_t callback, void *user)
+{
+  return dma_copy_request(dst, src, 0, len, callback, user);
+}
+
+bool dma_copy_memset(void *dst, uint8_t value, uint32_t len,
+                     dma_copy_callback_t callback, void *user)
+{
+  return dma_copy_request(dst, NULL, value, len, callback, user);
+}
+
+uint32_t dma_copy_pending()
+{
+  return count;
+}
+
+static bool dma_copy_request(void *dst, const void *src, uint8_t value, uint32_t len,
+                             dma_copy_callback_t callback, void *user)
+{
+  dma_copy_request_t *req;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (!dma_ready || len < DMA_COPY_THRESHOLD) {
+    if (src) {
+      memcpy(dst, src, len);
+    } else {
+      memset(dst, value, len);
+    }
+    if (callback) {
+      callback(user);
+    }
+    return true;
+  }
+
+  CORE_ENTER_ATOMIC();
+  if (count == DMA_COPY_QUEUE_LEN) {
+    CORE_EXIT_ATOMIC();
+    return false;
+  }
+  req = &queue[(head + count) % DMA_COPY_QUEUE_LEN];
+  req->dst = dst;
+  req->src = src;
+  req->value = value * 0x01010101UL;
+  req->len = len;
+  req->callback = callback;
+  req->user = user;
+  count++;
+  if (count == 1) {
+    // LDMA does not run in EM2
+    SLEEP_SleepBlockBegin(sleepEM2);
+  }
+  CORE_EXIT_ATOMIC();
+  dma_copy_start();
+  return true;
+}
+
+// Start the next transfer of the request at head, called with the queue
+// unlocked from thread mode or the LDMA interrupt. The CPU copies and the
+// callbacks run with interrupts enabled, so the radio is not held off.
+static void dma_copy_start()
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  while (count > 0 && !busy) {
+    dma_copy_request_t *req = &queue[head];
+    dma_copy_callback_t callback;
+    void *user;
+
+    busy = true;
+    if (dma_copy_chunk(req)) {
+      break;
+    }
+    // DMADRV refused the transfer, finish the request on the CPU. busy keeps
+    // the request to us meanwhile, new ones queue up behind it.
+    CORE_EXIT_ATOMIC();
+    if (req->src) {
+      memcpy(req->dst, req->src, req->len);
+    } else {
+      memset(req->dst, (uint8_t)req->value, req->len);
+    }
+    CORE_ENTER_ATOMIC();
+    busy = false;
+    callback = dma_copy_pop(&user);
+    if (callback) {
+      CORE_EXIT_ATOMIC();
+      callback(user);
+      CORE_ENTER_ATOMIC();
+    }
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+// Remove the request at head, returns its callback
+static dma_copy_callback_t dma_copy_pop(void **user)
+{
+  dma_copy_callback_t callback = queue[head].callback;
+
+  *user = queue[head].user;
+  head = (head + 1) % DMA_COPY_QUEUE_LEN;
+  count--;
+  if (count == 0) {
+    SLEEP_SleepBlockEnd(sleepEM2);
+  }
+  return callback;
+}
+
+// Move as much of the request as one transfer can, in the widest unit the
+// alignment allows
+static bool dma_copy_chunk(dma_copy_request_t *req)
+{
+  uint32_t addr = (uint32_t)req->dst | (uint32_t)req->src;
+  DMADRV_DataSize_t size;
+  uint32_t shift;
+  uint32_t items;
+
+  if ((addr & 3) == 0 && req->len >= 4) {
+    size = dmadrvDataSize4;
+    shift = 2;
+  } else if ((addr & 1) == 0 && req->len >= 2) {
+    size = dmadrvDataSize2;
+    shift = 1;
+  } else {
+    size = dmadrvDataSize1;
+    shift = 0;
+  }
+  items = req->len >> shift;
+  if (items > DMADRV_MAX_XFER_COUNT) {
+    items = DMADRV_MAX_XFER_COUNT;
+  }
+  chunk_len = items << shift;
+  return DMADRV_MemoryMemory(channel, req->dst,
+                             req->src ? (void *)req->src : (void *)&req->value,
+                             req->src != NULL, items, size,
+                             dma_copy_transfer_done, NULL) == ECODE_EMDRV_DMADRV_OK;
+}
+
+static bool dma_copy_transfer_done(unsigned int channel, unsigned int sequenceNo,
+                                   void *userParam)
+{
+  dma_copy_request_t *req = &queue[head];
+  dma_copy_callback_t callback = NULL;
+  void *user = NULL;
+
+  busy = false;
+  req->dst += chunk_len;
+  if (req->src) {
+    req->src += chunk_len;
+  }
+  req->len -= chunk_len;
+  if (req->len == 0) {
+    callback = dma_copy_pop(&user);
+  }
+  // keep the DMA busy while the callback runs
+  dma_copy_start();
+  if (callback) {
+    callback(user);
+  }
+  return true;
+}
@@ -0,0 +1,126 @@
+/***************************************************************************//**
+ * @file
+ * @brief Asynchronous memory copy on the LDMA
+ * Moves large buffers with a DMADRV channel so the CPU can do other work or
+ * sleep in EM1 meanwhile. Small requests are copied by the CPU right away.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef DMA_COPY_H_
+#define DMA_COPY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Number of requests waiting for or running on the DMA channel
+#ifndef DMA_COPY_QUEUE_LEN
+#define DMA_COPY_QUEUE_LEN           4
+#endif
+
+// Requests shorter than this are copied by the CPU, setting up the LDMA
+// and taking its interrupt costs more than copying a few bytes
+#ifndef DMA_COPY_THRESHOLD
+#define DMA_COPY_THRESHOLD           64
+#endif
+
+// Completion callback, called from the LDMA interrupt for DMA requests and
+// from the requesting function for CPU copies
+typedef void (*dma_copy_callback_t)(void *user);
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the copy service.
+ *
+ * @details
+ *   Allocates a DMADRV channel. If no channel is available every request is
+ *   copied by the CPU.
+ *
+ * @return
+ *   True if requests are handled by the DMA, False otherwise.
+ *
+ ******************************************************************************/
+bool dma_copy_init();
+
+/***************************************************************************//**
+ * @brief
+ *   Copy a buffer asynchronously.
+ *
+ * @details
+ *   Both buffers must stay valid and untouched until the callback is called.
+ *   Requests run one after the other in the order they are queued, copies
+ *   below DMA_COPY_THRESHOLD complete before the function returns, so they
+ *   may overtake queued ones. Aligned buffers are copied by words.
+ *
+ * @param[out] dst
+ *   Destination buffer, must not overlap the source.
+ *
+ * @param[in] src
+ *   Source buffer.
+ *
+ * @param[in] len
+ *   Number of bytes to copy.
+ *
+ * @param[in] callback
+ *   Function to call on completion, may be NULL.
+ *
+ * @param[in] user
+ *   Parameter passed to the callback.
+ *
+ * @return
+ *   True if the copy is done or queued, False if the queue is full.
+ *
+ ******************************************************************************/
+bool dma_copy_memcpy(void *dst, const void *src, uint32_t len,
+                     dma_copy_callback_t callback, void *user);
+
+/***************************************************************************//**
+ * @brief
+ *   Fill a buffer asynchronously.
+ *
+ * @details
+ *   Same rules as dma_copy_memcpy().
+ *
+ * @param[out] dst
+ *   Buffer to fill.
+ *
+ * @param[in] value
+ *   Byte value to write.
+ *
+ * @param[in] len
+ *   Number of bytes to write.
+ *
+ * @param[in] callback
+ *   Function to call on completion, may be NULL.
+ *
+ * @param[in] user
+ *   Parameter passed to the callback.
+ *
+ * @return
+ *   True if the fill is done or queued, False if the queue is full.
+ *
+ ******************************************************************************/
+bool dma_copy_memset(void *dst, uint8_t value, uint32_t len,
+                     dma_copy_callback_t callback, void *user);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of requests not completed yet.
+ *
+ * @return
+ *   Number of queued and running DMA requests.
+ *
+ ******************************************************************************/
+uint32_t dma_copy_pending();
+
+#endif /* DMA_COPY_H_ */
@@ -56,6 +56,15 @@
 #define EMDRV_DMADRV_DMA_CH_COUNT DMA_CHAN_COUNT
 #endif
 
+/// DMADRV scatter-gather descriptor count configuration option.
+/// Number of LDMA descriptors shared by all scatter-gather transfers, at most
+/// 32. A transfer takes one descriptor per buffer, plus one for every
+/// DMADRV_MAX_XFER_COUNT items a buffer is longer. Set to 0 to remove the
+/// scatter-gather pool.
+#ifndef EMDRV_DMADRV_SG_DESC_COUNT
+#define EMDRV_DMADRV_SG_DESC_COUNT 8
+#endif
+
 /// DMADRV native API configuration option.
 /// Use the native emlib api of the DMA controller, but still use DMADRV
 /// housekeeping functions as AllocateChannel/FreeChannel etc.
@@ -1,359 +1,386 @@
-// Copyright 2019 Silicon Laboratories, Inc.
-//
-//
-
-/********************************************************************
- * Autogenerated file, do not edit.
- *******************************************************************/
+// Generated by gattdb.py from gatt.xml, do not edit.
 
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "bg_gattdb_def.h"
+#include "gatt_db.h"
 
 #ifdef __GNUC__
-#define GATT_HEADER(F) F __attribute__ ((section (".gatt_header"))) 
-#define GATT_DATA(F) F __attribute__ ((section (".gatt_data"))) 
+#define GATT_HEADER(F) F __attribute__ ((section (".gatt_header")))
+#define GATT_DATA(F) F __attribute__ ((section (".gatt_data")))
+#define GATT_ARENA(F) F __attribute__ ((aligned (4)))
 #else
 #ifdef __ICCARM__
-#define GATT_HEADER(F) _Pragma("location=\".gatt_header\"") F 
-#define GATT_DATA(F) _Pragma("location=\".gatt_data\"") F 
+#define GATT_HEADER(F) _Pragma("location=\".gatt_header\"") F
+#define GATT_DATA(F) _Pragma("location=\".gatt_data\"") F
+#define GATT_ARENA(F) _Pragma("data_alignment=4") F
 #else
-#define GATT_HEADER(F) F 
-#define GATT_DATA(F) F 
+#define GATT_HEADER(F) F
+#define GATT_DATA(F) F
+#define GATT_ARENA(F) F
 #endif
 #endif
 
-GATT_DATA(const uint16_t bg_gattdb_data_uuidtable_16_map [])=
-{
-    0x2800,
-    0x2801,
-    0x2803,
-    0x1800,
-    0x2a00,
-    0x2a01,
-    0x180d,
-    0x2a37,
-    0x2902,
-    0x2a38,
-    0x2a39,
-    0x180a,
-    0x2a29,
-    0x2a24,
-    0x2a25,
-    0x2a27,
-    0x2a26,
-    0x2a28,
-    0x2a23,
-    0x2a2a,
-    0x2a50,
-    0x1801,
-    0x2a05,
-    0x2b2a,
-    0x2b29,
+GATT_DATA(const uint16_t bg_gattdb_data_uuidtable_16_map[]) = {
+  0x2800,
+  0x2801,
+  0x2803,
+  0x1800,
+  0x2a00,
+  0x2a01,
+  0x180d,
+  0x2a37,
+  0x2902,
+  0x2a38,
+  0x2a39,
+  0x180a,
+  0x2a29,
+  0x2a24,
+  0x2a25,
+  0x2a27,
+  0x2a26,
+  0x2a28,
+  0x2a23,
+  0x2a2a,
+  0x2a50,
+  0x1801,
+  0x2a05,
+  0x2b2a,
+  0x2b29,
 };
 
-GATT_DATA(const uint8_t bg_gattdb_data_uuidtable_128_map [])=
-{
-    0x0 //IAR workaround for empty array
+GATT_DATA(const uint8_t bg_gattdb_data_uuidtable_128_map[]) = {
+  0x0 // IAR workaround for empty array
 };
 
-
-
-
-uint8_t bg_gattdb_data_attribute_field_39_data[7]={0x00,0x00,0x00,0x00,0x00,0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_39 ) = {
-	.properties=0x02,
-	.index=15,
-	.max_len=7,
-	.data=bg_gattdb_data_attribute_field_39_data,
+// Values of the dynamic attributes
+GATT_ARENA(static uint8_t bg_gattdb_data_arena_init[26]) = {
+  0xc6, 0x60, 0x3c, 0xa2, 0x52, 0x06, 0x79, 0x58, 0x6c, 0x49, 0x14, 0xe6, 0x89, 0x53, 0x5d, 0x61,
+  0x42, 0x4c, 0x45, 0x20, 0x44, 0x65, 0x76, 0x69, 0x63, 0x65,
 };
+GATT_ARENA(static uint8_t bg_gattdb_data_arena_zero[37]);
 
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_38 ) = {
-	.len=5,
-	.data={0x02,0x28,0x00,0x50,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_0) = {
+  .len = 2,
+  .data = { 0x01, 0x18, }
 };
-uint8_t bg_gattdb_data_attribute_field_37_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_37 ) = {
-	.properties=0x02,
-	.index=14,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_37_data,
-};
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_36 ) = {
-	.len=5,
-	.data={0x02,0x26,0x00,0x2a,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_1) = {
+  .len = 5,
+  .data = { 0x20, 0x03, 0x00, 0x05, 0x2a, }
 };
-uint8_t bg_gattdb_data_attribute_field_35_data[8]={0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_35 ) = {
-	.properties=0x02,
-	.index=13,
-	.max_len=8,
-	.data=bg_gattdb_data_attribute_field_35_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_2) = {
+  .len = 5,
+  .data = { 0x02, 0x06, 0x00, 0x2a, 0x2b, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_34 ) = {
-	.len=5,
-	.data={0x02,0x24,0x00,0x23,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_3) = {
+  .len = 5,
+  .data = { 0x0a, 0x08, 0x00, 0x29, 0x2b, }
 };
-uint8_t bg_gattdb_data_attribute_field_33_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_33 ) = {
-	.properties=0x02,
-	.index=12,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_33_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_4) = {
+  .len = 2,
+  .data = { 0x00, 0x18, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_32 ) = {
-	.len=5,
-	.data={0x02,0x22,0x00,0x28,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_5) = {
+  .len = 5,
+  .data = { 0x0a, 0x0b, 0x00, 0x00, 0x2a, }
 };
-uint8_t bg_gattdb_data_attribute_field_31_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_31 ) = {
-	.properties=0x02,
-	.index=11,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_31_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_6) = {
+  .len = 5,
+  .data = { 0x02, 0x0d, 0x00, 0x01, 0x2a, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_30 ) = {
-	.len=5,
-	.data={0x02,0x20,0x00,0x26,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_7) = {
+  .len = 2,
+  .data = { 0x00, 0x03, }
 };
-uint8_t bg_gattdb_data_attribute_field_29_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_29 ) = {
-	.properties=0x02,
-	.index=10,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_29_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_8) = {
+  .len = 2,
+  .data = { 0x0d, 0x18, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_28 ) = {
-	.len=5,
-	.data={0x02,0x1e,0x00,0x27,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_9) = {
+  .len = 5,
+  .data = { 0x10, 0x10, 0x00, 0x37, 0x2a, }
 };
-uint8_t bg_gattdb_data_attribute_field_27_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_27 ) = {
-	.properties=0x02,
-	.index=9,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_27_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_10) = {
+  .len = 5,
+  .data = { 0x02, 0x13, 0x00, 0x38, 0x2a, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_26 ) = {
-	.len=5,
-	.data={0x02,0x1c,0x00,0x25,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_11) = {
+  .len = 5,
+  .data = { 0x08, 0x15, 0x00, 0x39, 0x2a, }
 };
-uint8_t bg_gattdb_data_attribute_field_25_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_25 ) = {
-	.properties=0x02,
-	.index=8,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_25_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_12) = {
+  .len = 2,
+  .data = { 0x0a, 0x18, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_24 ) = {
-	.len=5,
-	.data={0x02,0x1a,0x00,0x24,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_13) = {
+  .len = 5,
+  .data = { 0x02, 0x18, 0x00, 0x29, 0x2a, }
 };
-uint8_t bg_gattdb_data_attribute_field_23_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_23 ) = {
-	.properties=0x02,
-	.index=7,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_23_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_14) = {
+  .len = 5,
+  .data = { 0x02, 0x1a, 0x00, 0x24, 0x2a, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_22 ) = {
-	.len=5,
-	.data={0x02,0x18,0x00,0x29,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_15) = {
+  .len = 5,
+  .data = { 0x02, 0x1c, 0x00, 0x25, 0x2a, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_21 ) = {
-	.len=2,
-	.data={0x0a,0x18,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_16) = {
+  .len = 5,
+  .data = { 0x02, 0x1e, 0x00, 0x27, 0x2a, }
 };
-uint8_t bg_gattdb_data_attribute_field_20_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_20 ) = {
-	.properties=0x08,
-	.index=6,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_20_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_17) = {
+  .len = 5,
+  .data = { 0x02, 0x20, 0x00, 0x26, 0x2a, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_19 ) = {
-	.len=5,
-	.data={0x08,0x15,0x00,0x39,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_18) = {
+  .len = 5,
+  .data = { 0x02, 0x22, 0x00, 0x28, 0x2a, }
 };
-uint8_t bg_gattdb_data_attribute_field_18_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_18 ) = {
-	.properties=0x02,
-	.index=5,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_18_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_19) = {
+  .len = 5,
+  .data = { 0x02, 0x24, 0x00, 0x23, 0x2a, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_17 ) = {
-	.len=5,
-	.data={0x02,0x13,0x00,0x38,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_20) = {
+  .len = 5,
+  .data = { 0x02, 0x26, 0x00, 0x2a, 0x2a, }
 };
-uint8_t bg_gattdb_data_attribute_field_15_data[8]={0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_15 ) = {
-	.properties=0x10,
-	.index=4,
-	.max_len=8,
-	.data=bg_gattdb_data_attribute_field_15_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_21) = {
+  .len = 5,
+  .data = { 0x02, 0x28, 0x00, 0x50, 0x2a, }
 };
 
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_14 ) = {
-	.len=5,
-	.data={0x10,0x10,0x00,0x37,0x2a,}
-};
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_13 ) = {
-	.len=2,
-	.data={0x0d,0x18,}
-};
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_12 ) = {
-	.len=2,
-	.data={0x00,0x03,}
-};
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_11 ) = {
-	.len=5,
-	.data={0x02,0x0d,0x00,0x01,0x2a,}
-};
-uint8_t bg_gattdb_data_attribute_field_10_data[10]={0x42,0x4c,0x45,0x20,0x44,0x65,0x76,0x69,0x63,0x65,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_10 ) = {
-	.properties=0x0a,
-	.index=3,
-	.max_len=10,
-	.data=bg_gattdb_data_attribute_field_10_data,
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_0) = {
+  .properties = 0x20,
+  .index = 0,
+  .max_len = 4,
+  .data = &bg_gattdb_data_arena_zero[0],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_1) = {
+  .properties = 0x02,
+  .index = 1,
+  .max_len = 16,
+  .data = &bg_gattdb_data_arena_init[0],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_2) = {
+  .properties = 0x0a,
+  .index = 2,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[20],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_3) = {
+  .properties = 0x0a,
+  .index = 3,
+  .max_len = 10,
+  .data = &bg_gattdb_data_arena_init[16],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_4) = {
+  .properties = 0x10,
+  .index = 4,
+  .max_len = 8,
+  .data = &bg_gattdb_data_arena_zero[4],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_5) = {
+  .properties = 0x02,
+  .index = 5,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[21],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_6) = {
+  .properties = 0x08,
+  .index = 6,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[22],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_7) = {
+  .properties = 0x02,
+  .index = 7,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[23],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_8) = {
+  .properties = 0x02,
+  .index = 8,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[24],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_9) = {
+  .properties = 0x02,
+  .index = 9,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[25],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_10) = {
+  .properties = 0x02,
+  .index = 10,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[26],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_11) = {
+  .properties = 0x02,
+  .index = 11,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[27],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_12) = {
+  .properties = 0x02,
+  .index = 12,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[28],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_13) = {
+  .properties = 0x02,
+  .index = 13,
+  .max_len = 8,
+  .data = &bg_gattdb_data_arena_zero[12],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_14) = {
+  .properties = 0x02,
+  .index = 14,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[29],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_15) = {
+  .properties = 0x02,
+  .index = 15,
+  .max_len = 7,
+  .data = &bg_gattdb_data_arena_zero[30],
 };
 
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_9 ) = {
-	.len=5,
-	.data={0x0a,0x0b,0x00,0x00,0x2a,}
-};
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_8 ) = {
-	.len=2,
-	.data={0x00,0x18,}
-};
-uint8_t bg_gattdb_data_attribute_field_7_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_7 ) = {
-	.properties=0x0a,
-	.index=2,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_7_data,
+GATT_DATA(const struct bg_gattdb_attribute bg_gattdb_data_attributes_map[]) = {
+  { .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_0 }, // 1
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_1 }, // 2
+  { .uuid = 0x0016, .permissions = 0x800, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_0 }, // 3
+  { .uuid = 0x0008, .permissions = 0x807, .caps = 0xffff, .datatype = 0x03, .min_key_size = 0x00, .configdata = { .flags = 0x02, .index = 0x00, .clientconfig_index = 0x00 } }, // 4
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_2 }, // 5
+  { .uuid = 0x0017, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_1 }, // 6
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_3 }, // 7
+  { .uuid = 0x0018, .permissions = 0x803, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_2 }, // 8
+  { .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_4 }, // 9
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_5 }, // 10
+  { .uuid = 0x0004, .permissions = 0x803, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_3 }, // 11
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_6 }, // 12
+  { .uuid = 0x0005, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_7 }, // 13
+  { .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_8 }, // 14
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_9 }, // 15
+  { .uuid = 0x0007, .permissions = 0x800, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_4 }, // 16
+  { .uuid = 0x0008, .permissions = 0x803, .caps = 0xffff, .datatype = 0x03, .min_key_size = 0x00, .configdata = { .flags = 0x01, .index = 0x04, .clientconfig_index = 0x01 } }, // 17
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_10 }, // 18
+  { .uuid = 0x0009, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_5 }, // 19
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_11 }, // 20
+  { .uuid = 0x000a, .permissions = 0x802, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_6 }, // 21
+  { .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_12 }, // 22
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_13 }, // 23
+  { .uuid = 0x000c, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_7 }, // 24
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_14 }, // 25
+  { .uuid = 0x000d, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_8 }, // 26
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_15 }, // 27
+  { .uuid = 0x000e, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_9 }, // 28
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_16 }, // 29
+  { .uuid = 0x000f, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_10 }, // 30
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_17 }, // 31
+  { .uuid = 0x0010, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_11 }, // 32
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_18 }, // 33
+  { .uuid = 0x0011, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_12 }, // 34
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_19 }, // 35
+  { .uuid = 0x0012, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_13 }, // 36
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_20 }, // 37
+  { .uuid = 0x0013, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_14 }, // 38
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_21 }, // 39
+  { .uuid = 0x0014, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_15 }, // 40
 };
 
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_6 ) = {
-	.len=5,
-	.data={0x0a,0x08,0x00,0x29,0x2b,}
-};
-uint8_t bg_gattdb_data_attribute_field_5_data[16]={0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_5 ) = {
-	.properties=0x02,
-	.index=1,
-	.max_len=16,
-	.data=bg_gattdb_data_attribute_field_5_data,
+GATT_DATA(const uint16_t bg_gattdb_data_attributes_dynamic_mapping_map[]) = {
+  0x0003,
+  0x0006,
+  0x0008,
+  0x000b,
+  0x0010,
+  0x0013,
+  0x0015,
+  0x0018,
+  0x001a,
+  0x001c,
+  0x001e,
+  0x0020,
+  0x0022,
+  0x0024,
+  0x0026,
+  0x0028,
 };
 
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_4 ) = {
-	.len=5,
-	.data={0x02,0x06,0x00,0x2a,0x2b,}
-};
-uint8_t bg_gattdb_data_attribute_field_2_data[4]={0x00,0x00,0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_2 ) = {
-	.properties=0x20,
-	.index=0,
-	.max_len=4,
-	.data=bg_gattdb_data_attribute_field_2_data,
-};
+GATT_DATA(const uint8_t bg_gattdb_data_adv_uuid16_map[]) = { 0x0 };
+GATT_DATA(const uint8_t bg_gattdb_data_adv_uuid128_map[]) = { 0x0 };
 
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_1 ) = {
-	.len=5,
-	.data={0x20,0x03,0x00,0x05,0x2a,}
-};
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_0 ) = {
-	.len=2,
-	.data={0x01,0x18,}
-};
-GATT_DATA(const struct bg_gattdb_attribute bg_gattdb_data_attributes_map[])={
-    {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_0},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_1},
-    {.uuid=0x0016,.permissions=0x800,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_2},
-    {.uuid=0x0008,.permissions=0x807,.caps=0xffff,.datatype=0x03,.min_key_size=0x00,.configdata={.flags=0x02,.index=0x00,.clientconfig_index=0x00}},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_4},
-    {.uuid=0x0017,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_5},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_6},
-    {.uuid=0x0018,.permissions=0x803,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_7},
-    {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_8},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_9},
-    {.uuid=0x0004,.permissions=0x803,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_10},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_11},
-    {.uuid=0x0005,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_12},
-    {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_13},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_14},
-    {.uuid=0x0007,.permissions=0x800,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_15},
-    {.uuid=0x0008,.permissions=0x803,.caps=0xffff,.datatype=0x03,.min_key_size=0x00,.configdata={.flags=0x01,.index=0x04,.clientconfig_index=0x01}},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_17},
-    {.uuid=0x0009,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_18},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_19},
-    {.uuid=0x000a,.permissions=0x802,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_20},
-    {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_21},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_22},
-    {.uuid=0x000c,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_23},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_24},
-    {.uuid=0x000d,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_25},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_26},
-    {.uuid=0x000e,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_27},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_28},
-    {.uuid=0x000f,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_29},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_30},
-    {.uuid=0x0010,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_31},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_32},
-    {.uuid=0x0011,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_33},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_34},
-    {.uuid=0x0012,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_35},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_36},
-    {.uuid=0x0013,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_37},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_38},
-    {.uuid=0x0014,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_39},
+GATT_HEADER(const struct bg_gattdb_def bg_gattdb_data) = {
+  .attributes = bg_gattdb_data_attributes_map,
+  .attributes_max = 40,
+  .uuidtable_16_size = 25,
+  .uuidtable_16 = bg_gattdb_data_uuidtable_16_map,
+  .uuidtable_128_size = 0,
+  .uuidtable_128 = bg_gattdb_data_uuidtable_128_map,
+  .attributes_dynamic_max = 16,
+  .attributes_dynamic_mapping = bg_gattdb_data_attributes_dynamic_mapping_map,
+  .adv_uuid16 = bg_gattdb_data_adv_uuid16_map,
+  .adv_uuid16_num = 0,
+  .adv_uuid128 = bg_gattdb_data_adv_uuid128_map,
+  .adv_uuid128_num = 0,
+  .caps_mask = 0xffff,
+  .enabled_caps = 0xffff,
 };
 
-GATT_DATA(const uint16_t bg_gattdb_data_attributes_dynamic_mapping_map[])={
-	0x0003,
-	0x0006,
-	0x0008,
-	0x000b,
-	0x0010,
-	0x0013,
-	0x0015,
-	0x0018,
-	0x001a,
-	0x001c,
-	0x001e,
-	0x0020,
-	0x0022,
-	0x0024,
-	0x0026,
-	0x0028,
+const struct bg_gattdb_def *bg_gattdb = &bg_gattdb_data;
+
+const uint8_t gattdb_database_hash_value[16] = {
+  0xc6, 0x60, 0x3c, 0xa2, 0x52, 0x06, 0x79, 0x58, 0x6c, 0x49, 0x14, 0xe6, 0x89, 0x53, 0x5d, 0x61,
 };
 
-GATT_DATA(const uint8_t bg_gattdb_data_adv_uuid16_map[])={0x0};
-GATT_DATA(const uint8_t bg_gattdb_data_adv_uuid128_map[])={0x0};
-GATT_HEADER(const struct bg_gattdb_def bg_gattdb_data)={
-    .attributes=bg_gattdb_data_attributes_map,
-    .attributes_max=40,
-    .uuidtable_16_size=25,
-    .uuidtable_16=bg_gattdb_data_uuidtable_16_map,
-    .uuidtable_128_size=0,
-    .uuidtable_128=bg_gattdb_data_uuidtable_128_map,
-    .attributes_dynamic_max=16,
-    .attributes_dynamic_mapping=bg_gattdb_data_attributes_dynamic_mapping_map,
-    .adv_uuid16=bg_gattdb_data_adv_uuid16_map,
-    .adv_uuid16_num=0,
-    .adv_uuid128=bg_gattdb_data_adv_uuid128_map,
-    .adv_uuid128_num=0,
-    .caps_mask=0xffff,
-    .enabled_caps=0xffff,
+// UUID and handle, sorted by UUID
+static const uint16_t gattdb_uuid16_index[][2] = {
+  { 0x1800, 9 },
+  { 0x1801, 1 },
+  { 0x180a, 22 },
+  { 0x180d, 14 },
+  { 0x2a00, 11 },
+  { 0x2a01, 13 },
+  { 0x2a05, 3 },
+  { 0x2a23, 36 },
+  { 0x2a24, 26 },
+  { 0x2a25, 28 },
+  { 0x2a26, 32 },
+  { 0x2a27, 30 },
+  { 0x2a28, 34 },
+  { 0x2a29, 24 },
+  { 0x2a2a, 38 },
+  { 0x2a37, 16 },
+  { 0x2a38, 19 },
+  { 0x2a39, 21 },
+  { 0x2a50, 40 },
+  { 0x2b29, 8 },
+  { 0x2b2a, 6 },
 };
 
-const struct bg_gattdb_def *bg_gattdb=&bg_gattdb_data;
+uint16_t gattdb_find_uuid16(uint16_t uuid)
+{
+  uint16_t low = 0;
+  uint16_t high = 21;
+
+  while (low < high) {
+    uint16_t mid = (low + high) / 2;
+
+    if (gattdb_uuid16_index[mid][0] == uuid) {
+      return gattdb_uuid16_index[mid][1];
+    } else if (gattdb_uuid16_index[mid][0] < uuid) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return 0;
+}
+
+uint16_t gattdb_find_uuid128(const uint8_t *uuid)
+{
+  (void)uuid;
+  return 0;
+}
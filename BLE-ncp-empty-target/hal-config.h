@@ -56,6 +56,23 @@
   #define NCP_WAKEUP_POLARITY
 #endif
 
+// Define if COBS/CRC-16 framing of the NCP byte stream is requested,
+// the host must use the same framing (see ncp_frame.h)
+//#define NCP_USART_FRAMING_ENABLED
+
+// Define to use the SPI slave transport (ncp_spi.c) instead of the UART,
+// pins are taken from the SPINCP section of hal-config-board.h
+//#define NCP_SPI_ENABLED
+
+// Pins of the additional NCP channels when NCP_CHANNEL_COUNT (see ncp.h) is
+// defined project wide, one UART without flow control per channel
+#if defined(NCP_CHANNEL_COUNT) && (NCP_CHANNEL_COUNT > 1)
+  #define BSP_UARTNCP1_USART_PORT
+  #define BSP_UARTNCP1_TX_LOC
+  #define BSP_UARTNCP1_RX_LOC
+  #define HAL_UARTNCP1_BAUD_RATE          (115200)
+#endif
+
 // Define if NCP wakeup functionality is requested
 //#define NCP_HOST_WAKEUP_ENABLED
 
@@ -0,0 +1,52 @@
+/***************************************************************************//**
+ * @file
+ * @brief Bluetooth stack heap usage monitor
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "heap_monitor.h"
+
+static uint8_t *monitored_heap = NULL;
+static uint32_t monitored_size = 0;
+
+// Pattern byte at an offset, the pattern is aligned to the heap start
+#define PATTERN_BYTE(offset)  ((uint8_t)(HEAP_MONITOR_PATTERN >> (8 * ((offset) & 3))))
+
+void heap_monitor_init(uint8_t *heap, uint32_t size)
+{
+  for (uint32_t i = 0; i < size; i++) {
+    heap[i] = PATTERN_BYTE(i);
+  }
+  monitored_heap = heap;
+  monitored_size = size;
+}
+
+void heap_monitor_read(heap_monitor_stats_t *stats)
+{
+  uint32_t last = 0;
+  uint32_t used = 0;
+
+  for (uint32_t i = 0; i < monitored_size; i++) {
+    if (monitored_heap[i] != PATTERN_BYTE(i)) {
+      last = i;
+      used++;
+    }
+  }
+  stats->size = monitored_size;
+  stats->used = used;
+  stats->high_water = (used > 0) ? last + 1 : 0;
+  stats->recommended = (stats->high_water
+                        + stats->high_water * HEAP_MONITOR_HEADROOM / 100 + 7) & ~7UL;
+}
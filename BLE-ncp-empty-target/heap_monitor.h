@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * @file
+ * @brief Bluetooth stack heap usage monitor
+ * Fills the stack heap with a known pattern before gecko_init() and finds
+ * the part the stack has written since, so the heap can be sized to the
+ * real workload instead of DEFAULT_BLUETOOTH_HEAP().
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef HEAP_MONITOR_H_
+#define HEAP_MONITOR_H_
+
+#include <stdint.h>
+
+// Pattern written to the heap, repeated every 4 bytes
+#define HEAP_MONITOR_PATTERN         0x5aa5c33cUL
+
+// Headroom added to the high-water mark for the recommended heap size, in
+// percent of the high-water mark
+#ifndef HEAP_MONITOR_HEADROOM
+#define HEAP_MONITOR_HEADROOM        10
+#endif
+
+// With HEAP_MONITOR_PROFILE defined the heap is over-allocated by this factor
+// so the recommendation is not limited by the current size
+#ifndef HEAP_MONITOR_PROFILE_FACTOR
+#define HEAP_MONITOR_PROFILE_FACTOR  2
+#endif
+
+typedef struct {
+  // Size of the heap
+  uint32_t size;
+  // Bytes which no longer hold the pattern
+  uint32_t used;
+  // Offset past the last byte written, the heap cannot be smaller than this
+  uint32_t high_water;
+  // High-water mark plus HEAP_MONITOR_HEADROOM, rounded up to 8 bytes
+  uint32_t recommended;
+} heap_monitor_stats_t;
+
+/***************************************************************************//**
+ * @brief
+ *   Fill the heap with the pattern.
+ *
+ * @details
+ *   Must be called before gecko_init(), afterwards the heap belongs to the
+ *   stack.
+ *
+ * @param[in] heap
+ *   Bluetooth stack heap.
+ *
+ * @param[in] size
+ *   Size of the heap.
+ *
+ ******************************************************************************/
+void heap_monitor_init(uint8_t *heap, uint32_t size);
+
+/***************************************************************************//**
+ * @brief
+ *   Measure the heap usage.
+ *
+ * @details
+ *   Scans the whole heap, so it is meant for diagnostics on demand rather
+ *   than for every event. A pattern byte the stack happens to write with the
+ *   same value is not counted, which can make the figures a few bytes low.
+ *
+ * @param[out] stats
+ *   Heap usage since heap_monitor_init().
+ *
+ ******************************************************************************/
+void heap_monitor_read(heap_monitor_stats_t *stats);
+
+#endif /* HEAP_MONITOR_H_ */
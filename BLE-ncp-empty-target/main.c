@@ -27,7 +27,15 @@
 #include "bg_types.h"
 #include "ncp_gecko.h"
 #include "gatt_db.h"
+#if defined(NCP_SPI_ENABLED)
+#include "ncp_spi.h"
+#else
 #include "ncp_usart.h"
+#endif
+#include "ncp_evt_filter.h"
+#include "scan_agg.h"
+#include "heap_monitor.h"
+#include "stack_monitor.h"
 #include "em_core.h"
 
 /* libraries containing default gecko configuration values */
@@ -61,7 +69,16 @@
 #ifndef MAX_ADVERTISERS
 #define MAX_ADVERTISERS 2
 #endif
-uint8_t bluetooth_stack_heap[DEFAULT_BLUETOOTH_HEAP(MAX_CONNECTIONS)];
+#ifndef BLUETOOTH_HEAP_SIZE
+#define BLUETOOTH_HEAP_SIZE DEFAULT_BLUETOOTH_HEAP(MAX_CONNECTIONS)
+#endif
+// A HEAP_MONITOR_PROFILE build over-allocates the heap, so the heap monitor
+// can recommend a BLUETOOTH_HEAP_SIZE for the workload
+#if defined(HEAP_MONITOR_PROFILE)
+uint8_t bluetooth_stack_heap[BLUETOOTH_HEAP_SIZE * HEAP_MONITOR_PROFILE_FACTOR];
+#else
+uint8_t bluetooth_stack_heap[BLUETOOTH_HEAP_SIZE];
+#endif
 
 // Gecko configuration parameters (see gecko_configuration.h)
 static const gecko_configuration_t config = {
@@ -102,6 +119,8 @@ static uint32_t local_handle_event(struct gecko_cmd_packet *evt)
 
 int main(void)
 {
+  // Mark the free stack to measure its peak use
+  stack_monitor_init();
   // Initialize device
   initMcu();
   // Initialize board
@@ -109,11 +128,18 @@ int main(void)
   // Initialize application
   initApp();
 
+  // Mark the heap to measure its usage
+  heap_monitor_init(bluetooth_stack_heap, sizeof(bluetooth_stack_heap));
   // Initialize stack
   gecko_init(&config);
 
+#if defined(NCP_SPI_ENABLED)
+  // NCP SPI init
+  ncp_spi_init();
+#else
   // NCP USART init
   ncp_usart_init();
+#endif
 
   while (1) {
     struct gecko_cmd_packet *evt;
@@ -123,7 +149,12 @@ int main(void)
     while (evt) {
       if (!ncp_handle_event(evt) && !local_handle_event(evt)) {
         // send out the event if not handled either by NCP or locally
-        ncp_transmit_enqueue(evt);
+        // to every host which subscribed to it, unless folded into a summary
+        for (uint8_t channel = 0; channel < NCP_CHANNEL_COUNT; channel++) {
+          if (ncp_evt_filter_accept(channel, evt) && !scan_agg_report(channel, evt)) {
+            ncp_channel_transmit_enqueue(channel, evt);
+          }
+        }
       }
       // if a command is received, break and handle the command
       if (ncp_command_received()) {
@@ -131,12 +162,18 @@ int main(void)
       }
       evt = gecko_peek_event();
     }
+    scan_agg_poll();
     ncp_transmit();
 
     // If an NCP command received, do not sleep
     if (!ncp_command_received()) {
+      uint32_t sleep_ms;
+      uint32_t window_ms;
       CORE_CRITICAL_IRQ_DISABLE();
-      gecko_sleep_for_ms(gecko_can_sleep_ms());
+      // wake up to close the next scan aggregation window
+      sleep_ms = gecko_can_sleep_ms();
+      window_ms = scan_agg_sleep_ms();
+      gecko_sleep_for_ms((window_ms < sleep_ms) ? window_ms : sleep_ms);
       CORE_CRITICAL_IRQ_ENABLE();
     }
   }
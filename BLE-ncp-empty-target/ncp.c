@@ -19,9 +19,12 @@
 #include "em_assert.h"
 #include "em_core.h"
 #include "ncp.h"
+#include "ncp_frame.h"
 
 typedef struct {
   uint32_t len;
+  // Number of buffers following this one in the same packet
+  uint8_t remaining;
   uint8_t data[NCP_BUF_SIZE];
 } ncp_buf;
 
@@ -31,28 +34,38 @@ typedef struct {
   volatile uint16_t end;
   volatile uint16_t queued;
   volatile uint16_t used;
+  // The buffer at read is in the middle of a packet
+  volatile bool partial;
+  volatile uint32_t dropped;
   const uint16_t size;
+  const uint8_t drop_policy;
   ncp_buf  fifo[];
 } ncp_queue;
 
-#define DEFINE_NCP_QUEUE(qSize, qName) \
-  typedef struct {                     \
-    volatile uint16_t write;           \
-    volatile uint16_t read;            \
-    volatile uint16_t end;             \
-    volatile uint16_t queued;          \
-    volatile uint16_t used;            \
-    const uint16_t size;               \
-    ncp_buf fifo[qSize];               \
-  } _##qName;                          \
-  static volatile _##qName qName =     \
-  {                                    \
-    .write = 0,                        \
-    .read = 0,                         \
-    .end = 0,                          \
-    .queued = 0,                       \
-    .used = 0,                         \
-    .size = qSize,                     \
+#define DEFINE_NCP_QUEUE(qSize, qPolicy, qName) \
+  typedef struct {                              \
+    volatile uint16_t write;                    \
+    volatile uint16_t read;                     \
+    volatile uint16_t end;                      \
+    volatile uint16_t queued;                   \
+    volatile uint16_t used;                     \
+    volatile bool partial;                      \
+    volatile uint32_t dropped;                  \
+    const uint16_t size;                        \
+    const uint8_t drop_policy;                  \
+    ncp_buf fifo[qSize];                        \
+  } _##qName;                                   \
+  static volatile _##qName qName =              \
+  {                                             \
+    .write = 0,                                 \
+    .read = 0,                                  \
+    .end = 0,                                   \
+    .queued = 0,                                \
+    .used = 0,                                  \
+    .partial = false,                           \
+    .dropped = 0,                               \
+    .size = qSize,                              \
+    .drop_policy = qPolicy,                     \
   }
 
 typedef struct {
@@ -64,26 +77,56 @@ typedef struct {
   uint8_t data[NCP_CMD_SIZE];
 } rx_queue_t;
 
-static volatile rx_queue_t rx_queue =
+#define RX_QUEUE_INIT(n)                  \
+  {                                       \
+    .len = 0,                             \
+    .receiving_header = true,             \
+    .remaining = BGLIB_MSG_HEADER_LEN     \
+  },
+
+static volatile rx_queue_t rx_queues[NCP_CHANNEL_COUNT] =
 {
-  .len = 0,
-  .receiving_header = true,
-  .remaining = BGLIB_MSG_HEADER_LEN
+  NCP_CHANNEL_FOREACH(RX_QUEUE_INIT)
+};
+
+#define DEFINE_NCP_CHANNEL_QUEUES(n)                                          \
+  DEFINE_NCP_QUEUE(NCP_TX_RSP_QUEUE_LEN, NCP_TX_DROP_NEWEST, tx_rsp_queue_##n); \
+  DEFINE_NCP_QUEUE(NCP_TX_EVT_QUEUE_LEN, NCP_TX_EVT_DROP_POLICY, tx_evt_queue_##n); \
+  DEFINE_NCP_QUEUE(NCP_TX_BULK_QUEUE_LEN, NCP_TX_BULK_DROP_POLICY, tx_bulk_queue_##n);
+#define NCP_CHANNEL_LANES(n)                                                  \
+  { (ncp_queue*)&tx_rsp_queue_##n, (ncp_queue*)&tx_evt_queue_##n, (ncp_queue*)&tx_bulk_queue_##n },
+
+NCP_CHANNEL_FOREACH(DEFINE_NCP_CHANNEL_QUEUES)
+// TX lanes of every channel indexed by ncp_tx_lane_t, in the order of their priority
+static ncp_queue* const tx_lanes[NCP_CHANNEL_COUNT][ncp_tx_lane_count] = {
+  NCP_CHANNEL_FOREACH(NCP_CHANNEL_LANES)
 };
 
-DEFINE_NCP_QUEUE(NCP_TX_QUEUE_LEN, tx_queue_t);
-static ncp_queue* tx_queue = (ncp_queue*)&tx_queue_t;
+typedef struct {
+  uint32_t (*transmit_callback)(uint8_t* data, uint8_t len);
+  uint32_t (*transmit_encoder)(const uint8_t* data, uint32_t len, uint8_t* out);
+  uint8_t* encoder_scratch;
+  uint32_t encoder_scratch_len;
+  // Only the response lane is served, see ncp_channel_transmit_hold()
+  bool hold;
+} ncp_channel;
 
-static uint32_t (*transmit_callback)(uint8_t* data, uint8_t len) = 0;
+static ncp_channel channels[NCP_CHANNEL_COUNT];
+// Channel of the command handled last, the next one is searched after it
+static uint8_t command_channel = 0;
 
 //Enqueue accepted data into RX queue
-static void rx_enqueue(uint8_t* data, uint32_t len);
+static void rx_enqueue(volatile rx_queue_t* rx_queue, uint8_t* data, uint32_t len);
 //Reset the RX queue
-static void rx_queue_reset();
+static void rx_queue_reset(volatile rx_queue_t* rx_queue);
 //Reset the TX queue
-static void tx_queue_reset();
+static void tx_queue_reset(uint8_t channel);
 
-static bool ncp_enqueue(ncp_queue* queue, uint8_t* buf, uint32_t len, uint8_t rsp_not_evt);
+static bool ncp_enqueue(uint8_t channel, ncp_queue* queue, uint8_t* buf, uint32_t len);
+//Drop the oldest packet, while the lane is idle
+static void ncp_queue_evict(ncp_queue* queue);
+//Get the lane of a channel to transmit from next, NULL if nothing is queued
+static ncp_queue* ncp_transmit_next_queue(uint8_t channel);
 //Get the first item from queue, the item will stay in the queue
 static ncp_buf* ncp_queue_read(ncp_queue* queue);
 //Confirm the last read action from queue, the item will stay in the queue
@@ -91,190 +134,370 @@ static void ncp_queue_confirm_read(ncp_queue* queue);
 //Remove the first item from queue
 static void ncp_dequeue(ncp_queue* queue);
 
-static void rx_queue_reset()
+static void rx_queue_reset(volatile rx_queue_t* rx_queue)
 {
-  rx_queue.receiving_header = true;
-  rx_queue.remaining = BGLIB_MSG_HEADER_LEN;
-  rx_queue.len = 0;
+  rx_queue->receiving_header = true;
+  rx_queue->remaining = BGLIB_MSG_HEADER_LEN;
+  rx_queue->len = 0;
 }
 
-static void tx_queue_reset()
+static void tx_queue_reset(uint8_t channel)
 {
-  tx_queue->write = 0;
-  tx_queue->read = 0;
-  tx_queue->end = 0;
-  tx_queue->queued = 0;
-  tx_queue->used = 0;
-  memset((void*)tx_queue->fifo, 0, sizeof(ncp_buf) * NCP_TX_QUEUE_LEN);
+  for (int i = 0; i < ncp_tx_lane_count; i++) {
+    ncp_queue* queue = tx_lanes[channel][i];
+    queue->write = 0;
+    queue->read = 0;
+    queue->end = 0;
+    queue->queued = 0;
+    queue->used = 0;
+    queue->partial = false;
+    queue->dropped = 0;
+    memset((void*)queue->fifo, 0, sizeof(ncp_buf) * queue->size);
+  }
 }
 
 void ncp_set_transmit_callback(uint32_t (*_transmit_callback)(uint8_t* data, uint8_t len))
 {
+  ncp_channel_set_transmit_callback(0, _transmit_callback);
+}
+
+void ncp_channel_set_transmit_callback(uint8_t channel,
+                                       uint32_t (*_transmit_callback)(uint8_t* data, uint8_t len))
+{
+  EFM_ASSERT(channel < NCP_CHANNEL_COUNT);
   EFM_ASSERT(_transmit_callback != NULL);
-  transmit_callback = _transmit_callback;
-  rx_queue_reset();
-  tx_queue_reset();
+  channels[channel].transmit_callback = _transmit_callback;
+  rx_queue_reset(&rx_queues[channel]);
+  tx_queue_reset(channel);
+}
+
+void ncp_set_transmit_encoder(uint32_t (*encoder)(const uint8_t* data, uint32_t len, uint8_t* out),
+                              uint8_t* scratch, uint32_t scratch_len)
+{
+  ncp_channel_set_transmit_encoder(0, encoder, scratch, scratch_len);
+}
+
+void ncp_channel_set_transmit_encoder(uint8_t channel,
+                                      uint32_t (*encoder)(const uint8_t* data, uint32_t len, uint8_t* out),
+                                      uint8_t* scratch, uint32_t scratch_len)
+{
+  EFM_ASSERT(channel < NCP_CHANNEL_COUNT);
+  EFM_ASSERT(encoder == NULL || scratch != NULL);
+  channels[channel].transmit_encoder = encoder;
+  channels[channel].encoder_scratch = scratch;
+  channels[channel].encoder_scratch_len = scratch_len;
 }
 
 void ncp_handle_command()
 {
   struct gecko_cmd_packet * rsp;
 
-  if (ncp_command_received()) {
-    uint32_t *cmd_header = (uint32_t *)rx_queue.data;
+  // Take the channels in turn starting after the one served last, so a
+  // busy host cannot starve the others
+  for (uint8_t i = 1; i <= NCP_CHANNEL_COUNT; i++) {
+    uint8_t channel = (command_channel + i) % NCP_CHANNEL_COUNT;
+    volatile rx_queue_t* rx_queue = &rx_queues[channel];
+    if (!ncp_channel_command_received(channel)) {
+      continue;
+    }
+    command_channel = channel;
+    uint32_t *cmd_header = (uint32_t *)rx_queue->data;
     if (BGLIB_MSG_ID(*cmd_header) == gecko_cmd_user_message_to_target_id) {
       // call user command handler:
-      handle_user_command((uint8_t*)&rx_queue.data[BGLIB_MSG_HEADER_LEN]);
+      handle_user_command((uint8_t*)&rx_queue->data[BGLIB_MSG_HEADER_LEN]);
     } else {
-      gecko_handle_command(*cmd_header, (void*)&rx_queue.data[BGLIB_MSG_HEADER_LEN]);
+      gecko_handle_command(*cmd_header, (void*)&rx_queue->data[BGLIB_MSG_HEADER_LEN]);
     }
     rsp = (struct gecko_cmd_packet *)gecko_rsp_msg_buf;
-    if (!ncp_enqueue(tx_queue, (uint8_t*)rsp, BGLIB_MSG_LEN(rsp->header) + BGLIB_MSG_HEADER_LEN, 1)) {
+    if (!ncp_enqueue(channel, tx_lanes[channel][ncp_tx_lane_response], (uint8_t*)rsp,
+                     BGLIB_MSG_LEN(rsp->header) + BGLIB_MSG_HEADER_LEN)) {
       EFM_ASSERT(false);
       // TX queue is full, should never reach here
     }
     //reset the buffer after the command is handled
-    rx_queue_reset();
+    rx_queue_reset(rx_queue);
+    break;
   }
   ncp_transmit();
 }
 
+uint8_t ncp_command_channel()
+{
+  return command_channel;
+}
+
 void ncp_receive_command(uint8_t* data, uint32_t len)
 {
-  memcpy((void*)rx_queue.data, data, len);
-  rx_queue.len = len;
-  rx_queue.receiving_header = false;
-  rx_queue.remaining = 0;
+  ncp_channel_receive_command(0, data, len);
+}
+
+void ncp_channel_receive_command(uint8_t channel, uint8_t* data, uint32_t len)
+{
+  volatile rx_queue_t* rx_queue = &rx_queues[channel];
+  memcpy((void*)rx_queue->data, data, len);
+  rx_queue->len = len;
+  rx_queue->receiving_header = false;
+  rx_queue->remaining = 0;
 }
 
 uint32_t ncp_receive(uint8_t* data, uint32_t len)
 {
+  return ncp_channel_receive(0, data, len);
+}
+
+uint32_t ncp_channel_receive(uint8_t channel, uint8_t* data, uint32_t len)
+{
+  volatile rx_queue_t* rx_queue = &rx_queues[channel];
   uint32_t received = 0;
 
   if (data == NULL || len == 0) {
     return received;
   }
 
-  if (ncp_command_received()) {
+  if (ncp_channel_command_received(channel)) {
     return received; //wait until current command is handled
   }
-  if (len <= rx_queue.remaining) {
-    rx_enqueue(data, len);
+  if (len <= rx_queue->remaining) {
+    rx_enqueue(rx_queue, data, len);
     return len;
   } else {
-    if (rx_queue.receiving_header) {
-      received += rx_queue.remaining;
-      rx_enqueue(data, rx_queue.remaining);
+    if (rx_queue->receiving_header) {
+      received += rx_queue->remaining;
+      rx_enqueue(rx_queue, data, rx_queue->remaining);
     }
     // after receiving header and there is still more data
     // try to consume them as command parameters
-    rx_enqueue(data + received, rx_queue.remaining);
-    received += rx_queue.remaining;
+    rx_enqueue(rx_queue, data + received, rx_queue->remaining);
+    received += rx_queue->remaining;
     return received;
   }
 }
 
 uint32_t ncp_calc_expecting()
 {
-  return (rx_queue.remaining > 0) ? rx_queue.remaining : BGLIB_MSG_HEADER_LEN;
+  return (rx_queues[0].remaining > 0) ? rx_queues[0].remaining : BGLIB_MSG_HEADER_LEN;
+}
+
+ncp_tx_lane_t ncp_transmit_lane(struct gecko_cmd_packet *evt)
+{
+  switch (BGLIB_MSG_ID(evt->header)) {
+    case gecko_evt_le_gap_scan_response_id:
+    case gecko_evt_le_gap_extended_scan_response_id:
+    case gecko_evt_le_gap_scan_request_id:
+    case gecko_evt_sync_data_id:
+    case gecko_evt_cte_receiver_iq_report_id:
+      return ncp_tx_lane_bulk;
+    default:
+      return ncp_tx_lane_event;
+  }
+}
+
+uint32_t ncp_transmit_dropped(ncp_tx_lane_t lane)
+{
+  return ncp_channel_transmit_dropped(0, lane);
+}
+
+uint32_t ncp_channel_transmit_dropped(uint8_t channel, ncp_tx_lane_t lane)
+{
+  EFM_ASSERT(channel < NCP_CHANNEL_COUNT);
+  EFM_ASSERT(lane < ncp_tx_lane_count);
+  return tx_lanes[channel][lane]->dropped;
 }
 
 bool ncp_transmit_enqueue(struct gecko_cmd_packet *evt)
 {
-  if (evt == NULL) {
+  return ncp_channel_transmit_enqueue(0, evt);
+}
+
+bool ncp_channel_transmit_enqueue(uint8_t channel, struct gecko_cmd_packet *evt)
+{
+  if (evt == NULL || channels[channel].transmit_callback == NULL) {
     return false;
   }
-  return ncp_enqueue(tx_queue, (uint8_t*)evt, BGLIB_MSG_LEN(evt->header) + BGLIB_MSG_HEADER_LEN, 0);
+  return ncp_enqueue(channel, tx_lanes[channel][ncp_transmit_lane(evt)], (uint8_t*)evt,
+                     BGLIB_MSG_LEN(evt->header) + BGLIB_MSG_HEADER_LEN);
 }
 
 void ncp_transmit_dequeue(uint8_t* data, uint32_t len)
 {
-  ncp_dequeue(tx_queue);
+  // Transfers complete in the order they were started, so the buffer
+  // is always the oldest one in flight of the lane owning it
+  for (int channel = 0; channel < NCP_CHANNEL_COUNT; channel++) {
+    for (int i = 0; i < ncp_tx_lane_count; i++) {
+      ncp_queue* queue = tx_lanes[channel][i];
+      if (data >= (uint8_t*)&queue->fifo[0]
+          && data < (uint8_t*)&queue->fifo[queue->size]) {
+        ncp_dequeue(queue);
+        return;
+      }
+    }
+  }
+  EFM_ASSERT(false);
 }
 
 uint32_t ncp_transmit_queue_len()
 {
-  return tx_queue->queued;
+  return ncp_channel_transmit_queue_len(0);
+}
+
+uint32_t ncp_channel_transmit_queue_len(uint8_t channel)
+{
+  uint32_t queued = 0;
+  for (int i = 0; i < ncp_tx_lane_count; i++) {
+    queued += tx_lanes[channel][i]->queued;
+  }
+  return queued;
+}
+
+void ncp_channel_transmit_hold(uint8_t channel, bool hold)
+{
+  channels[channel].hold = hold;
+}
+
+bool ncp_channel_transmit_pending(uint8_t channel)
+{
+  bool pending;
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  pending = (ncp_transmit_next_queue(channel) != NULL);
+  CORE_EXIT_ATOMIC();
+  return pending;
 }
 
 void ncp_transmit()
 {
-  while (tx_queue->queued > 0) {
-    ncp_buf* buf = ncp_queue_read(tx_queue);
-    if (transmit_callback(buf->data, buf->len)) {
-      break;
+  for (uint8_t channel = 0; channel < NCP_CHANNEL_COUNT; channel++) {
+    ncp_queue* queue;
+    if (channels[channel].transmit_callback == NULL) {
+      continue;
+    }
+    while ((queue = ncp_transmit_next_queue(channel)) != NULL) {
+      ncp_buf* buf = ncp_queue_read(queue);
+      if (channels[channel].transmit_callback(buf->data, buf->len)) {
+        break;
+      }
+      ncp_queue_confirm_read(queue);
     }
-    ncp_queue_confirm_read(tx_queue);
   }
 }
 
-static void rx_enqueue(uint8_t* data, uint32_t len)
+static void rx_enqueue(volatile rx_queue_t* rx_queue, uint8_t* data, uint32_t len)
 {
-  memcpy((void*)&rx_queue.data[rx_queue.len], data, len);
-  rx_queue.len += len;
-  rx_queue.receiving_header = rx_queue.len < BGLIB_MSG_HEADER_LEN ? true : false;
-  if (rx_queue.receiving_header) {
-    rx_queue.remaining = BGLIB_MSG_HEADER_LEN - rx_queue.len;
+  memcpy((void*)&rx_queue->data[rx_queue->len], data, len);
+  rx_queue->len += len;
+  rx_queue->receiving_header = rx_queue->len < BGLIB_MSG_HEADER_LEN ? true : false;
+  if (rx_queue->receiving_header) {
+    rx_queue->remaining = BGLIB_MSG_HEADER_LEN - rx_queue->len;
   } else {
-    uint32_t *cmd_header = (uint32_t*)rx_queue.data;
+    uint32_t *cmd_header = (uint32_t*)rx_queue->data;
     uint32_t cmd_len = BGLIB_MSG_LEN(*cmd_header) + BGLIB_MSG_HEADER_LEN;
-    rx_queue.remaining = cmd_len - rx_queue.len;
+    rx_queue->remaining = cmd_len - rx_queue->len;
   }
 }
 
 bool ncp_command_received()
 {
-  if (rx_queue.receiving_header == false && rx_queue.remaining == 0) {
+  for (uint8_t channel = 0; channel < NCP_CHANNEL_COUNT; channel++) {
+    if (ncp_channel_command_received(channel)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ncp_channel_command_received(uint8_t channel)
+{
+  volatile rx_queue_t* rx_queue = &rx_queues[channel];
+  if (rx_queue->receiving_header == false && rx_queue->remaining == 0) {
     return true;
   } else {
     return false;
   }
 }
 
-static bool ncp_enqueue(ncp_queue* queue, uint8_t* buf, uint32_t len, uint8_t rsp_not_evt)
+static bool ncp_enqueue(uint8_t channel, ncp_queue* queue, uint8_t* buf, uint32_t len)
 {
-  uint16_t available_size = queue->size - (rsp_not_evt ? 0 : NCP_TX_QUEUE_RESERVED_LEN);
+  ncp_channel* ch = &channels[channel];
+  uint16_t needed;
+  uint32_t left;
+  uint8_t* src;
+
+  if (ch->transmit_encoder != NULL) {
+    if (NCP_FRAME_ENCODED_LEN(len) > ch->encoder_scratch_len) {
+      queue->dropped++;
+      return false;
+    }
+    len = ch->transmit_encoder(buf, len, ch->encoder_scratch);
+    buf = ch->encoder_scratch;
+  }
+  needed = (len + NCP_BUF_SIZE - 1) / NCP_BUF_SIZE;
+  left = len;
+  src = buf;
 
   CORE_DECLARE_IRQ_STATE;
   CORE_ENTER_ATOMIC();
-  if (queue->used >= available_size) {
-    CORE_EXIT_ATOMIC();
-    return false;
+  if (queue->size - queue->used < needed) {
+    //not enough space in the lane, apply its drop policy. Evicting only
+    //frees space while nothing is in flight, otherwise drop the new packet
+    //rather than the queued ones for nothing.
+    if (queue->drop_policy != NCP_TX_DROP_OLDEST || queue->end != queue->read
+        || queue->partial || queue->size - queue->used + queue->queued < needed) {
+      queue->dropped++;
+      CORE_EXIT_ATOMIC();
+      return false;
+    }
+    while (queue->size - queue->used < needed) {
+      ncp_queue_evict(queue);
+    }
   }
-  if (len <= NCP_BUF_SIZE) {
-    //data fit into single TX buffer
+  while (left > 0) {
+    uint32_t count = (left > NCP_BUF_SIZE) ? NCP_BUF_SIZE : left;
     memcpy((void*)queue->fifo[queue->write].data,
-           (const void*)buf, len);
-    queue->fifo[queue->write].len = len;
+           (const void*)src, count);
+    queue->fifo[queue->write].len = count;
+    queue->fifo[queue->write].remaining = --needed;
     queue->write = (queue->write + 1) % queue->size;
     queue->queued++;
     queue->used++;
-    CORE_EXIT_ATOMIC();
-    return true;
-  } else {
-    uint32_t space = (available_size - queue->used) * NCP_BUF_SIZE;
-    if (len > space) {
-      //not enough space in the queue
-      CORE_EXIT_ATOMIC();
-      return false;
-    } else {
-      uint32_t left = len;
-      uint8_t* src = buf;
-      while (left > 0) {
-        uint32_t count = (left > NCP_BUF_SIZE) ? NCP_BUF_SIZE : left;
-        memcpy((void*)queue->fifo[queue->write].data,
-               (const void*)src, count);
-        queue->fifo[queue->write].len = count;
-        queue->write = (queue->write + 1) % queue->size;
-        queue->queued++;
-        queue->used++;
-        src += count;
-        left -= count;
-      }
-      CORE_EXIT_ATOMIC();
-      return true;
+    src += count;
+    left -= count;
+  }
+  CORE_EXIT_ATOMIC();
+  return true;
+}
+
+// Must be called with interrupts disabled, a packet queued and nothing in
+// flight
+static void ncp_queue_evict(ncp_queue* queue)
+{
+  uint16_t count = queue->fifo[queue->read].remaining + 1;
+
+  queue->read = (queue->read + count) % queue->size;
+  queue->queued -= count;
+  queue->end = queue->read;
+  queue->used -= count;
+  queue->dropped++;
+}
+
+static ncp_queue* ncp_transmit_next_queue(uint8_t channel)
+{
+  ncp_queue* const* lanes = tx_lanes[channel];
+  int i;
+  // Packets must not be interleaved, finish the one already started
+  for (i = 0; i < ncp_tx_lane_count; i++) {
+    if (lanes[i]->partial && lanes[i]->queued > 0) {
+      return lanes[i];
+    }
+  }
+  for (i = 0; i < ncp_tx_lane_count; i++) {
+    if (channels[channel].hold && i != ncp_tx_lane_response) {
+      break;
+    }
+    if (lanes[i]->queued > 0) {
+      return lanes[i];
     }
   }
+  return NULL;
 }
 
 static ncp_buf* ncp_queue_read(ncp_queue* queue)
@@ -294,6 +517,7 @@ static void ncp_queue_confirm_read(ncp_queue* queue)
 {
   CORE_DECLARE_IRQ_STATE;
   CORE_ENTER_ATOMIC();
+  queue->partial = (queue->fifo[queue->read].remaining != 0);
   queue->read = (queue->read + 1) % queue->size;
   queue->queued--;
   CORE_EXIT_ATOMIC();
@@ -29,18 +29,78 @@
 #define NCP_CMD_SIZE                 360
 #endif
 
-// Length of TX queue
-#ifndef NCP_TX_QUEUE_LEN
-#define NCP_TX_QUEUE_LEN             42
+// Number of independent NCP channels. Each channel has its own command
+// receive state and TX queue and is served by its own transport link, so
+// several hosts can drive the target concurrently. Commands of all channels
+// are handed to the stack one at a time, round robin over the channels.
+// The functions without a channel argument operate on channel 0.
+#ifndef NCP_CHANNEL_COUNT
+#define NCP_CHANNEL_COUNT            1
 #endif
-// Length of the area in the TX queue reserved
-// for responses only (no events buffered here)
-#define NCP_TX_QUEUE_RESERVED_LEN    12
+
+// Expand X(n) for every channel n
+#if NCP_CHANNEL_COUNT == 1
+#define NCP_CHANNEL_FOREACH(X)       X(0)
+#elif NCP_CHANNEL_COUNT == 2
+#define NCP_CHANNEL_FOREACH(X)       X(0) X(1)
+#elif NCP_CHANNEL_COUNT == 3
+#define NCP_CHANNEL_FOREACH(X)       X(0) X(1) X(2)
+#elif NCP_CHANNEL_COUNT == 4
+#define NCP_CHANNEL_FOREACH(X)       X(0) X(1) X(2) X(3)
+#else
+#error "NCP_CHANNEL_COUNT must be between 1 and 4"
+#endif
+
+// The TX queue of each channel is split into lanes which are served in strict priority
+// order: command responses first, then connection/GATT events, and the
+// high-volume scan/advertising report events last. Each lane has its own
+// number of buffers so a flood of bulk events can never delay a response.
+
+// Length of the TX lane for command responses, must hold the largest response
+// plus the overhead of a transmit encoder, if any
+#ifndef NCP_TX_RSP_QUEUE_LEN
+#define NCP_TX_RSP_QUEUE_LEN         13
+#endif
+// Length of the TX lane for connection, GATT and other events
+#ifndef NCP_TX_EVT_QUEUE_LEN
+#define NCP_TX_EVT_QUEUE_LEN         18
+#endif
+// Length of the TX lane for scan report and other bulk events
+#ifndef NCP_TX_BULK_QUEUE_LEN
+#define NCP_TX_BULK_QUEUE_LEN        12
+#endif
+// Total length of the TX queue of a channel
+#define NCP_TX_QUEUE_LEN             (NCP_TX_RSP_QUEUE_LEN  \
+                                      + NCP_TX_EVT_QUEUE_LEN \
+                                      + NCP_TX_BULK_QUEUE_LEN)
+
+// Drop policies of a TX lane when it is full: either refuse the new packet
+// or evict the oldest packets. Eviction only happens while nothing of the
+// lane is in flight and it frees enough space, otherwise the new packet is
+// refused.
+#define NCP_TX_DROP_NEWEST           0
+#define NCP_TX_DROP_OLDEST           1
+
+#ifndef NCP_TX_EVT_DROP_POLICY
+#define NCP_TX_EVT_DROP_POLICY       NCP_TX_DROP_NEWEST
+#endif
+#ifndef NCP_TX_BULK_DROP_POLICY
+#define NCP_TX_BULK_DROP_POLICY      NCP_TX_DROP_OLDEST
+#endif
+
 // Size of each NCP buffer
 #ifndef NCP_BUF_SIZE
 #define NCP_BUF_SIZE                 30
 #endif
 
+// TX lanes, in the order of their priority
+typedef enum {
+  ncp_tx_lane_response = 0,
+  ncp_tx_lane_event    = 1,
+  ncp_tx_lane_bulk     = 2,
+  ncp_tx_lane_count
+} ncp_tx_lane_t;
+
 /***************************************************************************//**
  * @brief
  *   Set callback function for transmit.
@@ -56,6 +116,29 @@
  ******************************************************************************/
 void ncp_set_transmit_callback(uint32_t (*transmit_callback)(uint8_t* data, uint8_t len));
 
+/***************************************************************************//**
+ * @brief
+ *   Set encoder applied to every packet before it is queued for transmit.
+ *
+ * @details
+ *   This function can be called by NCP connection drivers which wrap packets
+ *   into frames, after ncp_set_transmit_callback(). An encoded packet stays
+ *   contiguous in the TX queue. Packets whose worst case encoded length does
+ *   not fit into the scratch buffer are dropped.
+ *
+ * @param[in] encoder
+ *   Encoder function pointer, returns the encoded length. NULL to disable.
+ *
+ * @param[in] scratch
+ *   Buffer the encoder writes into.
+ *
+ * @param[in] scratch_len
+ *   Size of the scratch buffer.
+ *
+ ******************************************************************************/
+void ncp_set_transmit_encoder(uint32_t (*encoder)(const uint8_t* data, uint32_t len, uint8_t* out),
+                              uint8_t* scratch, uint32_t scratch_len);
+
 /***************************************************************************//**
  * @brief
  *   Get the number of buffers currently queued in NCP transmit queue.
@@ -76,7 +159,8 @@ uint32_t ncp_transmit_queue_len();
  *
  * @details
  *   This function will check NCP receive queue and if a command is received it
- *   will forward it to stack to handle.
+ *   will forward it to stack to handle. With several channels, one command is
+ *   handled per call, taking the channels in turn.
  *
  ******************************************************************************/
 void ncp_handle_command();
@@ -164,7 +248,8 @@ uint32_t ncp_calc_expecting();
  *   Get the status of current NCP command.
  *
  * @details
- *   This function will return true if a full NCP command is received.
+ *   This function will return true if a full NCP command is received on any
+ *   channel.
  *
  * @return
  *   True if full command is received, otherwise False
@@ -172,12 +257,48 @@ uint32_t ncp_calc_expecting();
  ******************************************************************************/
 bool ncp_command_received();
 
+/***************************************************************************//**
+ * @brief
+ *   Get the TX lane an event is queued in.
+ *
+ * @details
+ *   Scan reports, periodic advertising data and other high-volume events go
+ *   to the bulk lane, every other event goes to the event lane.
+ *
+ * @param[in] evt
+ *   Pointer to the event received from the Bluetooth stack.
+ *
+ * @return
+ *   TX lane of the event.
+ *
+ ******************************************************************************/
+ncp_tx_lane_t ncp_transmit_lane(struct gecko_cmd_packet *evt);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of packets dropped in a TX lane.
+ *
+ * @details
+ *   Both packets refused because the lane was full and packets evicted by
+ *   the NCP_TX_DROP_OLDEST policy are counted.
+ *
+ * @param[in] lane
+ *   TX lane to query.
+ *
+ * @return
+ *   Number of packets dropped since the transmit callback was set.
+ *
+ ******************************************************************************/
+uint32_t ncp_transmit_dropped(ncp_tx_lane_t lane);
+
 /***************************************************************************//**
  * @brief
  *   This function appends response or event packets to TX queue.
  *
  * @details
- *   In case TX queue is full, this function will simply drop the event.
+ *   The event is queued in the lane returned by ncp_transmit_lane(). In case
+ *   the lane is full, the drop policy of the lane decides whether the event
+ *   or the oldest packet waiting in the lane is dropped.
  *
  * @param[in] evt
  *   Pointer to the event received from the Bluetooth stack.
@@ -211,9 +332,203 @@ void ncp_transmit_dequeue(uint8_t* data, uint32_t len);
  *   received events are handled or enqueued.
  *
  * @details
- *   This function starts transmitting of enqueued events in TX queue.
+ *   This function starts transmitting of enqueued events in TX queue. Lanes
+ *   are served in priority order, a packet already partially handed to the
+ *   transport is always finished first.
  *
  ******************************************************************************/
 void ncp_transmit();
 
+/***************************************************************************//**
+ * @brief
+ *   Set callback function for transmit on a channel.
+ *
+ * @details
+ *   Same as ncp_set_transmit_callback() for the transport link of the given
+ *   channel. Resets the receive state and TX queue of the channel.
+ *
+ * @param[in] channel
+ *   NCP channel, less than NCP_CHANNEL_COUNT.
+ *
+ * @param[in] transmit_callback
+ *   Callback function pointer.
+ *
+ ******************************************************************************/
+void ncp_channel_set_transmit_callback(uint8_t channel,
+                                       uint32_t (*transmit_callback)(uint8_t* data, uint8_t len));
+
+/***************************************************************************//**
+ * @brief
+ *   Set encoder applied to every packet queued on a channel.
+ *
+ * @details
+ *   Same as ncp_set_transmit_encoder() for the given channel.
+ *
+ * @param[in] channel
+ *   NCP channel.
+ *
+ * @param[in] encoder
+ *   Encoder function pointer, returns the encoded length. NULL to disable.
+ *
+ * @param[in] scratch
+ *   Buffer the encoder writes into.
+ *
+ * @param[in] scratch_len
+ *   Size of the scratch buffer.
+ *
+ ******************************************************************************/
+void ncp_channel_set_transmit_encoder(uint8_t channel,
+                                      uint32_t (*encoder)(const uint8_t* data, uint32_t len, uint8_t* out),
+                                      uint8_t* scratch, uint32_t scratch_len);
+
+/***************************************************************************//**
+ * @brief
+ *   Write a complete NCP command received on a channel.
+ *
+ * @details
+ *   Same as ncp_receive_command() for the given channel.
+ *
+ * @param[in] channel
+ *   NCP channel.
+ *
+ * @param[in] data
+ *   Pointer to byte stream data received.
+ *
+ * @param[in] len
+ *   Length of the byte stream data received.
+ *
+ ******************************************************************************/
+void ncp_channel_receive_command(uint8_t channel, uint8_t* data, uint32_t len);
+
+/***************************************************************************//**
+ * @brief
+ *   Write NCP data stream received on a channel.
+ *
+ * @details
+ *   Same as ncp_receive() for the given channel.
+ *
+ * @param[in] channel
+ *   NCP channel.
+ *
+ * @param[in] data
+ *   Pointer to byte stream data received.
+ *
+ * @param[in] len
+ *   Length of the byte stream data received.
+ *
+ * @return
+ *   The number of bytes accepted.
+ *
+ ******************************************************************************/
+uint32_t ncp_channel_receive(uint8_t channel, uint8_t* data, uint32_t len);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the status of the NCP command of a channel.
+ *
+ * @param[in] channel
+ *   NCP channel.
+ *
+ * @return
+ *   True if a full command is received on the channel and waits to be
+ *   handled, otherwise False
+ *
+ ******************************************************************************/
+bool ncp_channel_command_received(uint8_t channel);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the channel of the command being handled.
+ *
+ * @details
+ *   Valid while the stack or handle_user_command() handles a command, the
+ *   response goes back on this channel.
+ *
+ * @return
+ *   NCP channel of the command.
+ *
+ ******************************************************************************/
+uint8_t ncp_command_channel();
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of buffers queued in the TX queue of a channel.
+ *
+ * @param[in] channel
+ *   NCP channel.
+ *
+ * @return
+ *   Number of buffers in the TX queue of the channel.
+ *
+ ******************************************************************************/
+uint32_t ncp_channel_transmit_queue_len(uint8_t channel);
+
+/***************************************************************************//**
+ * @brief
+ *   Hold back the events of a channel.
+ *
+ * @details
+ *   While held, ncp_transmit() only sends the command responses of the
+ *   channel, and the rest of a packet already started. Events stay queued,
+ *   subject to the drop policy of their lane, until the hold is released.
+ *
+ * @param[in] channel
+ *   NCP channel.
+ *
+ * @param[in] hold
+ *   True to hold the event and bulk lanes, False to serve them again.
+ *
+ ******************************************************************************/
+void ncp_channel_transmit_hold(uint8_t channel, bool hold);
+
+/***************************************************************************//**
+ * @brief
+ *   Check whether ncp_transmit() has something to send on a channel.
+ *
+ * @param[in] channel
+ *   NCP channel.
+ *
+ * @return
+ *   True if a buffer of the channel can be sent, taking a hold into
+ *   account, otherwise False.
+ *
+ ******************************************************************************/
+bool ncp_channel_transmit_pending(uint8_t channel);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of packets dropped in a TX lane of a channel.
+ *
+ * @param[in] channel
+ *   NCP channel.
+ *
+ * @param[in] lane
+ *   TX lane to query.
+ *
+ * @return
+ *   Number of packets dropped since the transmit callback was set.
+ *
+ ******************************************************************************/
+uint32_t ncp_channel_transmit_dropped(uint8_t channel, ncp_tx_lane_t lane);
+
+/***************************************************************************//**
+ * @brief
+ *   Append an event to the TX queue of a channel.
+ *
+ * @details
+ *   Same as ncp_transmit_enqueue() for the given channel. Events are routed
+ *   to the channels by calling this once for every subscribed channel.
+ *
+ * @param[in] channel
+ *   NCP channel.
+ *
+ * @param[in] evt
+ *   Pointer to the event received from the Bluetooth stack.
+ *
+ * @return
+ *   True if the event is queued, otherwise False
+ *
+ ******************************************************************************/
+bool ncp_channel_transmit_enqueue(uint8_t channel, struct gecko_cmd_packet *evt);
+
 #endif /* NCP_H_ */
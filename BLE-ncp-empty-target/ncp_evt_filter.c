@@ -0,0 +1,128 @@
+/***************************************************************************//**
+ * @file
+ * @brief Silabs Network Co-Processor (NCP) event subscription filter
+ * This library drops stack events the host did not subscribe to before
+ * they are queued for transmission.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "ncp_evt_filter.h"
+
+// Class and index of an event, see BGLIB_MSG_ID()
+#define EVT_CLASS(HDR)  ((uint8_t)((HDR) >> 16))
+#define EVT_INDEX(HDR)  ((uint8_t)((HDR) >> 24))
+
+// Event indices beyond the mask width share the last bit
+#define EVT_BIT(index)  (1 << (((index) < 15) ? (index) : 15))
+
+// Filter of one NCP channel. Zero initialized so that every event is
+// forwarded until the host configures the filter.
+typedef struct {
+  // One bit per event index, a set bit drops the event
+  uint16_t drop_mask[NCP_EVT_FILTER_CLASSES];
+  bool scan_enabled;
+  int8_t rssi_min;
+  uint8_t prefix_len;
+  uint8_t prefix[NCP_EVT_FILTER_PREFIX_LEN];
+  uint32_t dropped;
+} evt_filter_t;
+
+static evt_filter_t filters[NCP_CHANNEL_COUNT];
+
+static bool scan_report_accept(const evt_filter_t* filter, int8_t rssi, bd_addr *address);
+
+void ncp_evt_filter_reset(uint8_t channel)
+{
+  memset(&filters[channel], 0, sizeof(filters[channel]));
+}
+
+bool ncp_evt_filter_set(uint8_t channel, uint8_t evt_class, uint8_t evt_index, bool forward)
+{
+  evt_filter_t* filter = &filters[channel];
+  uint16_t bits;
+
+  if (evt_class >= NCP_EVT_FILTER_CLASSES) {
+    return false;
+  }
+  bits = (evt_index == NCP_EVT_FILTER_ALL_EVENTS) ? 0xffff : EVT_BIT(evt_index);
+  if (forward) {
+    filter->drop_mask[evt_class] &= ~bits;
+  } else {
+    filter->drop_mask[evt_class] |= bits;
+  }
+  return true;
+}
+
+bool ncp_evt_filter_set_scan(uint8_t channel, int8_t rssi_min, uint8_t prefix_len,
+                             const uint8_t* prefix)
+{
+  evt_filter_t* filter = &filters[channel];
+
+  if (prefix_len > NCP_EVT_FILTER_PREFIX_LEN) {
+    return false;
+  }
+  filter->scan_enabled = true;
+  filter->rssi_min = rssi_min;
+  filter->prefix_len = prefix_len;
+  memcpy(filter->prefix, prefix, prefix_len);
+  return true;
+}
+
+bool ncp_evt_filter_accept(uint8_t channel, struct gecko_cmd_packet *evt)
+{
+  evt_filter_t* filter = &filters[channel];
+  uint8_t evt_class = EVT_CLASS(evt->header);
+  bool accept = true;
+
+  if (evt_class < NCP_EVT_FILTER_CLASSES
+      && (filter->drop_mask[evt_class] & EVT_BIT(EVT_INDEX(evt->header)))) {
+    accept = false;
+  } else if (filter->scan_enabled) {
+    switch (BGLIB_MSG_ID(evt->header)) {
+      case gecko_evt_le_gap_scan_response_id:
+        accept = scan_report_accept(filter, evt->data.evt_le_gap_scan_response.rssi,
+                                    &evt->data.evt_le_gap_scan_response.address);
+        break;
+      case gecko_evt_le_gap_extended_scan_response_id:
+        accept = scan_report_accept(filter, evt->data.evt_le_gap_extended_scan_response.rssi,
+                                    &evt->data.evt_le_gap_extended_scan_response.address);
+        break;
+      default:
+        break;
+    }
+  }
+  if (!accept) {
+    filter->dropped++;
+  }
+  return accept;
+}
+
+uint32_t ncp_evt_filter_dropped(uint8_t channel)
+{
+  return filters[channel].dropped;
+}
+
+static bool scan_report_accept(const evt_filter_t* filter, int8_t rssi, bd_addr *address)
+{
+  if (rssi < filter->rssi_min) {
+    return false;
+  }
+  // bd_addr is stored least significant byte first
+  for (uint8_t i = 0; i < filter->prefix_len; i++) {
+    if (address->addr[5 - i] != filter->prefix[i]) {
+      return false;
+    }
+  }
+  return true;
+}
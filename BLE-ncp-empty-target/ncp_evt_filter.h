@@ -0,0 +1,131 @@
+/***************************************************************************//**
+ * @file
+ * @brief Silabs Network Co-Processor (NCP) event subscription filter
+ * This library drops stack events the host did not subscribe to before
+ * they are queued for transmission.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef NCP_EVT_FILTER_H_
+#define NCP_EVT_FILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ncp.h"
+
+// Number of BGAPI classes covered by the filter bitmap. Events of classes
+// beyond this are always forwarded.
+#ifndef NCP_EVT_FILTER_CLASSES
+#define NCP_EVT_FILTER_CLASSES       0x46
+#endif
+// Event index covering every event of a class
+#define NCP_EVT_FILTER_ALL_EVENTS    0xff
+// Maximum length of the scan report address prefix
+#define NCP_EVT_FILTER_PREFIX_LEN    6
+
+/***************************************************************************//**
+ * @brief
+ *   Forward every event to the host of a channel again.
+ *
+ * @details
+ *   Clears the subscription bitmap and the scan report predicates. Each NCP
+ *   channel has its own filter, so every host subscribes to the events it
+ *   needs independently of the others.
+ *
+ * @param[in] channel
+ *   NCP channel of the host.
+ *
+ ******************************************************************************/
+void ncp_evt_filter_reset(uint8_t channel);
+
+/***************************************************************************//**
+ * @brief
+ *   Subscribe to or unsubscribe from an event.
+ *
+ * @param[in] channel
+ *   NCP channel of the host.
+ *
+ * @param[in] evt_class
+ *   BGAPI class of the event.
+ *
+ * @param[in] evt_index
+ *   Index of the event in its class, or NCP_EVT_FILTER_ALL_EVENTS.
+ *
+ * @param[in] forward
+ *   True to forward the event to the host, False to drop it.
+ *
+ * @return
+ *   True on success, False if the event is out of range of the filter.
+ *
+ ******************************************************************************/
+bool ncp_evt_filter_set(uint8_t channel, uint8_t evt_class, uint8_t evt_index, bool forward);
+
+/***************************************************************************//**
+ * @brief
+ *   Set the predicates applied to scan report events.
+ *
+ * @details
+ *   Scan reports weaker than the RSSI threshold or not matching the address
+ *   prefix are dropped. The prefix is given most significant byte first, as
+ *   the address is printed.
+ *
+ * @param[in] channel
+ *   NCP channel of the host.
+ *
+ * @param[in] rssi_min
+ *   Minimum RSSI to forward, -128 forwards every report.
+ *
+ * @param[in] prefix_len
+ *   Length of the address prefix, 0 disables address matching.
+ *
+ * @param[in] prefix
+ *   Address prefix to match.
+ *
+ * @return
+ *   True on success, False if the prefix is too long.
+ *
+ ******************************************************************************/
+bool ncp_evt_filter_set_scan(uint8_t channel, int8_t rssi_min, uint8_t prefix_len,
+                             const uint8_t* prefix);
+
+/***************************************************************************//**
+ * @brief
+ *   Check if an event should be sent to the host of a channel.
+ *
+ * @param[in] channel
+ *   NCP channel of the host.
+ *
+ * @param[in] evt
+ *   Pointer to the event received from the Bluetooth stack.
+ *
+ * @return
+ *   True if the event passes the filter, False if it should be dropped.
+ *
+ ******************************************************************************/
+bool ncp_evt_filter_accept(uint8_t channel, struct gecko_cmd_packet *evt);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of events dropped by the filter of a channel.
+ *
+ * @param[in] channel
+ *   NCP channel of the host.
+ *
+ * @return
+ *   Number of events dropped since the last reset.
+ *
+ ******************************************************************************/
+uint32_t ncp_evt_filter_dropped(uint8_t channel);
+
+#endif /* NCP_EVT_FILTER_H_ */
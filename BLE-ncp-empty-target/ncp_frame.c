@@ -0,0 +1,102 @@
+/***************************************************************************//**
+ * @file
+ * @brief Silabs Network Co-Processor (NCP) frame codec
+ * Self-synchronizing framing for the NCP byte stream. Every BGAPI packet is
+ * followed by a CRC-16, COBS encoded and terminated by a zero byte, so a
+ * receiver resynchronizes on the next delimiter after any corruption.
+ * The codec has no hardware dependencies and can be built on the host.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include "ncp_frame.h"
+
+// CRC-16/CCITT-FALSE, processed a nibble at a time to keep the table small
+static const uint16_t crc16_table[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+  0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+uint16_t ncp_frame_crc16(uint16_t crc, const uint8_t* data, uint32_t len)
+{
+  while (len--) {
+    crc = (crc << 4) ^ crc16_table[(crc >> 12) ^ (*data >> 4)];
+    crc = (crc << 4) ^ crc16_table[(crc >> 12) ^ (*data & 0x0f)];
+    data++;
+  }
+  return crc;
+}
+
+uint32_t ncp_frame_encode(const uint8_t* payload, uint32_t len, uint8_t* frame)
+{
+  uint16_t crc = ncp_frame_crc16(0xffff, payload, len);
+  uint8_t crc_bytes[NCP_FRAME_CRC_LEN] = { (uint8_t)crc, (uint8_t)(crc >> 8) };
+  uint32_t code_pos = 0;
+  uint32_t out = 1;
+  uint8_t code = 1;
+
+  // COBS: each block starts with the distance to the next zero byte
+  for (uint32_t i = 0; i < len + NCP_FRAME_CRC_LEN; i++) {
+    uint8_t byte = (i < len) ? payload[i] : crc_bytes[i - len];
+    if (byte == 0) {
+      frame[code_pos] = code;
+      code_pos = out++;
+      code = 1;
+    } else {
+      frame[out++] = byte;
+      if (++code == 0xff) {
+        frame[code_pos] = code;
+        code_pos = out++;
+        code = 1;
+      }
+    }
+  }
+  frame[code_pos] = code;
+  frame[out++] = NCP_FRAME_DELIMITER;
+  return out;
+}
+
+uint32_t ncp_frame_decode(const uint8_t* frame, uint32_t len, uint8_t* payload, uint32_t size)
+{
+  uint32_t in = 0;
+  uint32_t out = 0;
+  uint16_t crc;
+
+  while (in < len) {
+    uint8_t code = frame[in++];
+    if (code == 0) {
+      return 0;
+    }
+    for (uint8_t i = 1; i < code; i++) {
+      if (in >= len || out >= size || frame[in] == 0) {
+        return 0;
+      }
+      payload[out++] = frame[in++];
+    }
+    // a full block is not followed by a zero, neither is the last block
+    if (code != 0xff && in < len) {
+      if (out >= size) {
+        return 0;
+      }
+      payload[out++] = 0;
+    }
+  }
+  if (out < NCP_FRAME_CRC_LEN) {
+    return 0;
+  }
+  out -= NCP_FRAME_CRC_LEN;
+  crc = ncp_frame_crc16(0xffff, payload, out);
+  if (payload[out] != (uint8_t)crc || payload[out + 1] != (uint8_t)(crc >> 8)) {
+    return 0;
+  }
+  return out;
+}
@@ -0,0 +1,102 @@
+/***************************************************************************//**
+ * @file
+ * @brief Silabs Network Co-Processor (NCP) frame codec
+ * Self-synchronizing framing for the NCP byte stream. Every BGAPI packet is
+ * followed by a CRC-16, COBS encoded and terminated by a zero byte, so a
+ * receiver resynchronizes on the next delimiter after any corruption.
+ * The codec has no hardware dependencies and can be built on the host.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef NCP_FRAME_H_
+#define NCP_FRAME_H_
+
+#include <stdint.h>
+
+// Frame delimiter, never present inside an encoded frame
+#define NCP_FRAME_DELIMITER          0x00
+// Length of the CRC appended to the payload
+#define NCP_FRAME_CRC_LEN            2
+// Worst case encoded length of a payload, including CRC and delimiter
+#define NCP_FRAME_ENCODED_LEN(len)   ((len) + NCP_FRAME_CRC_LEN                 \
+                                      + ((len) + NCP_FRAME_CRC_LEN) / 254 + 1 \
+                                      + 1)
+
+/***************************************************************************//**
+ * @brief
+ *   Calculate CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xffff).
+ *
+ * @param[in] crc
+ *   CRC of the preceding data, 0xffff to start a new calculation.
+ *
+ * @param[in] data
+ *   Pointer to the data.
+ *
+ * @param[in] len
+ *   Length of the data.
+ *
+ * @return
+ *   Updated CRC.
+ *
+ ******************************************************************************/
+uint16_t ncp_frame_crc16(uint16_t crc, const uint8_t* data, uint32_t len);
+
+/***************************************************************************//**
+ * @brief
+ *   Encode a payload into a frame.
+ *
+ * @param[in] payload
+ *   Pointer to the payload, usually a complete BGAPI packet.
+ *
+ * @param[in] len
+ *   Length of the payload.
+ *
+ * @param[out] frame
+ *   Buffer for the frame, at least NCP_FRAME_ENCODED_LEN(len) bytes. Must
+ *   not overlap the payload.
+ *
+ * @return
+ *   Length of the frame including the trailing delimiter.
+ *
+ ******************************************************************************/
+uint32_t ncp_frame_encode(const uint8_t* payload, uint32_t len, uint8_t* frame);
+
+/***************************************************************************//**
+ * @brief
+ *   Decode a frame and verify its CRC.
+ *
+ * @details
+ *   The frame is given without its delimiter. Decoding can be done in place
+ *   by passing the same buffer as frame and payload.
+ *
+ * @param[in] frame
+ *   Pointer to the encoded frame.
+ *
+ * @param[in] len
+ *   Length of the encoded frame, without delimiter.
+ *
+ * @param[out] payload
+ *   Buffer for the decoded payload.
+ *
+ * @param[in] size
+ *   Size of the payload buffer.
+ *
+ * @return
+ *   Length of the payload, or 0 if the frame is malformed, too long or its
+ *   CRC does not match.
+ *
+ ******************************************************************************/
+uint32_t ncp_frame_decode(const uint8_t* frame, uint32_t len, uint8_t* payload, uint32_t size);
+
+#endif /* NCP_FRAME_H_ */
@@ -0,0 +1,307 @@
+/***************************************************************************//**
+ * @file
+ * @brief Silabs Network Co-Processor (NCP) library SPI slave driver
+ * This library allows customers create applications work in NCP mode.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include "hal-config.h"
+
+#if defined(NCP_SPI_ENABLED)
+
+#include <string.h>
+#include "em_assert.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_usart.h"
+#include "em_core.h"
+#include "dmadrv.h"
+#include "gpiointerrupt.h"
+#include "sleep.h"
+#include "ncp_spi.h"
+
+typedef struct {
+  uint8_t* data;
+  uint8_t len;
+} ncp_spi_buf;
+
+// Transfer buffers, both start with the length of the data following it
+static uint8_t rxbuf[NCP_SPI_MAX_TRANSFER];
+static uint8_t txbuf[NCP_SPI_MAX_TRANSFER];
+// Bytes of the NCP stream in txbuf, and how many of them the TX DMA sends
+static uint32_t tx_len = 0;
+static uint32_t tx_armed = 0;
+// Bytes still to come of the last packet in txbuf
+static uint32_t tx_packet_left = 0;
+// TX queue buffers copied into txbuf. The first tx_bufs_done of them were
+// clocked out and are released to the TX queue from the main loop, as
+// ncp_transmit() may be between reading and confirming a buffer.
+static ncp_spi_buf tx_bufs[NCP_TX_QUEUE_LEN];
+static volatile uint32_t tx_bufs_len = 0;
+static volatile uint32_t tx_bufs_armed = 0;
+static volatile uint32_t tx_bufs_done = 0;
+
+static unsigned int rx_channel;
+static unsigned int tx_channel;
+static volatile bool transfer_active = false;
+static volatile uint32_t transfers = 0;
+static volatile uint32_t rx_errors = 0;
+static volatile uint32_t tx_aborts = 0;
+
+static uint32_t ncp_spi_transmit(uint8_t* data, uint8_t len);
+static void ncp_spi_arm_rx();
+static void ncp_spi_arm_tx();
+static void ncp_spi_transfer_end();
+static void ncp_spi_release();
+static void ncp_spi_cs_changed(uint8_t pin);
+
+void ncp_spi_init()
+{
+  USART_InitSync_TypeDef init = USART_INITSYNC_DEFAULT;
+  Ecode_t retVal;
+
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  CMU_ClockEnable(NCP_SPI_CLK, true);
+
+  init.enable = usartDisable;
+  init.master = false;
+  init.msbf = true;
+  init.clockMode = NCP_SPI_CLOCK_MODE;
+  USART_InitSync(NCP_SPI_USART, &init);
+
+  GPIO_PinModeSet(BSP_SPINCP_MOSI_PORT, BSP_SPINCP_MOSI_PIN, gpioModeInput, 0);
+  GPIO_PinModeSet(BSP_SPINCP_MISO_PORT, BSP_SPINCP_MISO_PIN, gpioModePushPull, 0);
+  GPIO_PinModeSet(BSP_SPINCP_CLK_PORT, BSP_SPINCP_CLK_PIN, gpioModeInput, 0);
+  GPIO_PinModeSet(BSP_SPINCP_CS_PORT, BSP_SPINCP_CS_PIN, gpioModeInputPull, 1);
+  // As a slave the USART receives on MOSI and transmits on MISO
+  NCP_SPI_USART->ROUTELOC0 = (BSP_SPINCP_MOSI_LOC << _USART_ROUTELOC0_RXLOC_SHIFT)
+                             | (BSP_SPINCP_MISO_LOC << _USART_ROUTELOC0_TXLOC_SHIFT)
+                             | (BSP_SPINCP_CS_LOC << _USART_ROUTELOC0_CSLOC_SHIFT)
+                             | (BSP_SPINCP_CLK_LOC << _USART_ROUTELOC0_CLKLOC_SHIFT);
+  NCP_SPI_USART->ROUTEPEN = USART_ROUTEPEN_RXPEN | USART_ROUTEPEN_TXPEN
+                            | USART_ROUTEPEN_CSPEN | USART_ROUTEPEN_CLKPEN;
+
+  retVal = DMADRV_Init();
+  EFM_ASSERT(retVal == ECODE_EMDRV_DMADRV_OK
+             || retVal == ECODE_EMDRV_DMADRV_ALREADY_INITIALIZED);
+  retVal = DMADRV_AllocateChannel(&rx_channel, NULL);
+  EFM_ASSERT(retVal == ECODE_EMDRV_DMADRV_OK);
+  retVal = DMADRV_AllocateChannel(&tx_channel, NULL);
+  EFM_ASSERT(retVal == ECODE_EMDRV_DMADRV_OK);
+
+  ncp_set_transmit_callback(ncp_spi_transmit);
+  GPIO_PinModeSet(NCP_SPI_HOST_INT_PORT, NCP_SPI_HOST_INT_PIN, gpioModePushPull,
+                  NCP_SPI_HOST_INT_POLARITY ? 0 : 1);
+  ncp_spi_arm_rx();
+  ncp_spi_arm_tx();
+  USART_Enable(NCP_SPI_USART, usartEnable);
+
+  // Chip select edges start and end a transfer
+  GPIOINT_Init();
+  GPIOINT_CallbackRegister(BSP_SPINCP_CS_PIN, ncp_spi_cs_changed);
+  GPIO_ExtIntConfig(BSP_SPINCP_CS_PORT, BSP_SPINCP_CS_PIN, BSP_SPINCP_CS_PIN,
+                    true, true, true);
+  // The USART needs its clock to be clocked as a slave
+  SLEEP_SleepBlockBegin(sleepEM2);
+}
+
+// Must be called with interrupts disabled and chip select deasserted
+static void ncp_spi_arm_rx()
+{
+  DMADRV_StopTransfer(rx_channel);
+  NCP_SPI_USART->CMD = USART_CMD_CLEARRX;
+  DMADRV_PeripheralMemory(rx_channel, NCP_SPI_RX_SIGNAL, rxbuf,
+                          (void*)&NCP_SPI_USART->RXDATA, true, NCP_SPI_MAX_TRANSFER,
+                          dmadrvDataSize1, NULL, NULL);
+}
+
+// Must be called with interrupts disabled and chip select deasserted
+static void ncp_spi_arm_tx()
+{
+  DMADRV_StopTransfer(tx_channel);
+  NCP_SPI_USART->CMD = USART_CMD_CLEARTX;
+  txbuf[0] = (uint8_t)tx_len;
+  txbuf[1] = (uint8_t)(tx_len >> 8);
+  tx_armed = tx_len;
+  tx_bufs_armed = tx_bufs_len;
+  DMADRV_MemoryPeripheral(tx_channel, NCP_SPI_TX_SIGNAL, (void*)&NCP_SPI_USART->TXDATA,
+                          txbuf, true, NCP_SPI_HEADER_LEN + tx_armed,
+                          dmadrvDataSize1, NULL, NULL);
+}
+
+static uint32_t ncp_spi_transmit(uint8_t* data, uint8_t len)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (transfer_active) {
+    // txbuf is being clocked out, retry once the transfer ends
+    CORE_EXIT_ATOMIC();
+    return 1;
+  }
+  if (NCP_SPI_HEADER_LEN + tx_len + len > NCP_SPI_MAX_TRANSFER) {
+    // full, the rest goes into the next transfer
+    if (tx_armed < tx_len) {
+      ncp_spi_arm_tx();
+    }
+    CORE_EXIT_ATOMIC();
+    ncp_spi_status_update();
+    return 1;
+  }
+  if (tx_packet_left == 0) {
+    // first buffer of a packet always holds the whole header
+    EFM_ASSERT(len >= BGLIB_MSG_HEADER_LEN);
+    tx_packet_left = BGLIB_MSG_LEN(data[0] | (data[1] << 8)) + BGLIB_MSG_HEADER_LEN;
+  }
+  memcpy(&txbuf[NCP_SPI_HEADER_LEN + tx_len], data, len);
+  tx_len += len;
+  tx_packet_left -= len;
+  tx_bufs[tx_bufs_len].data = data;
+  tx_bufs[tx_bufs_len].len = len;
+  tx_bufs_len++;
+  // Rearm on packet boundaries only, so the transfer covers every packet
+  // queued so far without restarting the DMA for each buffer
+  if (tx_packet_left == 0) {
+    ncp_spi_arm_tx();
+  }
+  CORE_EXIT_ATOMIC();
+  ncp_spi_status_update();
+  return 0;
+}
+
+static void ncp_spi_transfer_end()
+{
+  int rx_left = 0;
+  uint32_t clocked;
+
+  DMADRV_TransferRemainingCount(rx_channel, &rx_left);
+  clocked = NCP_SPI_MAX_TRANSFER - rx_left;
+  transfers++;
+
+  if (clocked >= NCP_SPI_HEADER_LEN) {
+    uint32_t host_len = rxbuf[0] | (rxbuf[1] << 8);
+    uint8_t* data = &rxbuf[NCP_SPI_HEADER_LEN];
+    uint32_t accepted;
+    if (host_len > clocked - NCP_SPI_HEADER_LEN) {
+      // host ended the transfer early
+      rx_errors++;
+      host_len = 0;
+    }
+    // Hand the data over in the pieces the parser expects: given a header
+    // and parameters at once, ncp_receive() only counts the header
+    while (host_len > 0) {
+      accepted = ncp_calc_expecting();
+      if (accepted > host_len) {
+        accepted = host_len;
+      }
+      if (ncp_receive(data, accepted) != accepted) {
+        break;
+      }
+      data += accepted;
+      host_len -= accepted;
+    }
+    if (host_len > 0) {
+      // host sent more than the command being received
+      rx_errors++;
+    }
+  }
+
+  if (tx_armed > 0) {
+    if (clocked >= NCP_SPI_HEADER_LEN + tx_armed) {
+      // keep what was copied after the DMA was armed
+      memmove(&txbuf[NCP_SPI_HEADER_LEN], &txbuf[NCP_SPI_HEADER_LEN + tx_armed],
+              tx_len - tx_armed);
+      tx_len -= tx_armed;
+      tx_bufs_done = tx_bufs_armed;
+    } else {
+      // host did not clock everything out, send it again
+      tx_aborts++;
+    }
+  }
+  ncp_spi_arm_rx();
+  ncp_spi_arm_tx();
+  gecko_external_signal(NCP_SPI_UPDATE_SIGNAL);
+}
+
+// Release the buffers clocked out to the TX queue
+static void ncp_spi_release()
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  for (uint32_t i = 0; i < tx_bufs_done; i++) {
+    ncp_transmit_dequeue(tx_bufs[i].data, tx_bufs[i].len);
+  }
+  memmove(tx_bufs, &tx_bufs[tx_bufs_done],
+          (tx_bufs_len - tx_bufs_done) * sizeof(tx_bufs[0]));
+  tx_bufs_len -= tx_bufs_done;
+  tx_bufs_armed -= tx_bufs_done;
+  tx_bufs_done = 0;
+  CORE_EXIT_ATOMIC();
+}
+
+static void ncp_spi_cs_changed(uint8_t pin)
+{
+  (void)pin;
+  if (GPIO_PinInGet(BSP_SPINCP_CS_PORT, BSP_SPINCP_CS_PIN) == 0) {
+    transfer_active = true;
+  } else if (transfer_active) {
+    transfer_active = false;
+    ncp_spi_transfer_end();
+  }
+}
+
+uint32_t ncp_spi_transfers()
+{
+  return transfers;
+}
+
+uint32_t ncp_spi_rx_errors()
+{
+  return rx_errors;
+}
+
+uint32_t ncp_spi_tx_aborts()
+{
+  return tx_aborts;
+}
+
+void ncp_spi_status_update()
+{
+  // Same logic as the UART host wakeup: asserted while data is waiting
+  if (tx_armed > 0) {
+    NCP_SPI_HOST_INT_POLARITY ? GPIO_PinOutSet(NCP_SPI_HOST_INT_PORT, NCP_SPI_HOST_INT_PIN)
+    : GPIO_PinOutClear(NCP_SPI_HOST_INT_PORT, NCP_SPI_HOST_INT_PIN);
+  } else {
+    NCP_SPI_HOST_INT_POLARITY ? GPIO_PinOutClear(NCP_SPI_HOST_INT_PORT, NCP_SPI_HOST_INT_PIN)
+    : GPIO_PinOutSet(NCP_SPI_HOST_INT_PORT, NCP_SPI_HOST_INT_PIN);
+  }
+}
+
+bool ncp_handle_event(struct gecko_cmd_packet *evt)
+{
+  bool evt_handled = false;
+  switch (BGLIB_MSG_ID(evt->header)) {
+    case gecko_evt_system_external_signal_id:
+      if (evt->data.evt_system_external_signal.extsignals & NCP_SPI_UPDATE_SIGNAL) {
+        ncp_spi_release();
+        ncp_spi_status_update();
+        evt_handled = true;
+      }
+      break;
+    default:
+      break;
+  }
+  return evt_handled;
+}
+
+#endif // NCP_SPI_ENABLED
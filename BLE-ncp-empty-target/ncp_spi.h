@@ -0,0 +1,180 @@
+/***************************************************************************//**
+ * @file
+ * @brief Silabs Network Co-Processor (NCP) library SPI slave driver
+ * This library allows customers create applications work in NCP mode.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef NCP_SPI_H_
+#define NCP_SPI_H_
+
+#include "hal-config.h"
+#include "ncp.h"
+
+/*
+ * Transfer protocol
+ *
+ * The host is the SPI master and starts every transfer. Both directions of a
+ * transfer start with a 16-bit little-endian length followed by that many
+ * bytes of the NCP byte stream, the same stream the UART transport carries.
+ * The host clocks 2 bytes, reads the length of the target data and keeps
+ * chip select asserted while clocking 2 + max(host length, target length)
+ * bytes in total. Bytes past either length are padding.
+ *
+ * The target asserts the host interrupt line while it has data waiting, the
+ * host then runs a transfer, with a zero length if it has nothing to send.
+ * If the host deasserts chip select before all target data was clocked out,
+ * the host drops what it got and the target sends the data again in the
+ * next transfer. The host must wait NCP_SPI_CS_SETUP_US after asserting chip
+ * select before clocking the first byte.
+ */
+
+#if BSP_SPINCP_USART_PORT == HAL_SPI_PORT_USART0
+// USART0
+#define NCP_SPI_USART         USART0
+#define NCP_SPI_CLK           cmuClock_USART0
+#define NCP_SPI_RX_SIGNAL     dmadrvPeripheralSignal_USART0_RXDATAV
+#define NCP_SPI_TX_SIGNAL     dmadrvPeripheralSignal_USART0_TXBL
+#elif BSP_SPINCP_USART_PORT == HAL_SPI_PORT_USART1
+// USART1
+#define NCP_SPI_USART         USART1
+#define NCP_SPI_CLK           cmuClock_USART1
+#define NCP_SPI_RX_SIGNAL     dmadrvPeripheralSignal_USART1_RXDATAV
+#define NCP_SPI_TX_SIGNAL     dmadrvPeripheralSignal_USART1_TXBL
+#elif BSP_SPINCP_USART_PORT == HAL_SPI_PORT_USART2
+// USART2
+#define NCP_SPI_USART         USART2
+#define NCP_SPI_CLK           cmuClock_USART2
+#define NCP_SPI_RX_SIGNAL     dmadrvPeripheralSignal_USART2_RXDATAV
+#define NCP_SPI_TX_SIGNAL     dmadrvPeripheralSignal_USART2_TXBL
+#elif BSP_SPINCP_USART_PORT == HAL_SPI_PORT_USART3
+// USART3
+#define NCP_SPI_USART         USART3
+#define NCP_SPI_CLK           cmuClock_USART3
+#define NCP_SPI_RX_SIGNAL     dmadrvPeripheralSignal_USART3_RXDATAV
+#define NCP_SPI_TX_SIGNAL     dmadrvPeripheralSignal_USART3_TXBL
+#else
+#error "Unsupported SPI port!"
+#endif
+
+#if NCP_CHANNEL_COUNT > 1
+#error "The SPI transport supports a single NCP channel only"
+#endif
+
+// The host interrupt line reuses the host wakeup pin when it is configured
+#if defined(NCP_HOST_WAKEUP_ENABLED)
+#define NCP_SPI_HOST_INT_PORT           NCP_HOST_WAKEUP_PORT
+#define NCP_SPI_HOST_INT_PIN            NCP_HOST_WAKEUP_PIN
+#define NCP_SPI_HOST_INT_POLARITY       NCP_HOST_WAKEUP_POLARITY
+#else
+#define NCP_SPI_HOST_INT_PORT           BSP_SPINCP_NHOSTINT_PORT
+#define NCP_SPI_HOST_INT_PIN            BSP_SPINCP_NHOSTINT_PIN
+#define NCP_SPI_HOST_INT_POLARITY       0
+#endif
+
+#define NCP_SPI_UPDATE_SIGNAL           (1 << 1)
+
+// Length prefix of each direction of a transfer
+#define NCP_SPI_HEADER_LEN              2
+
+// Maximum number of bytes clocked in a transfer, including the length
+#ifndef NCP_SPI_MAX_TRANSFER
+#define NCP_SPI_MAX_TRANSFER            (NCP_SPI_HEADER_LEN + NCP_CMD_SIZE)
+#endif
+#if NCP_SPI_MAX_TRANSFER < NCP_SPI_HEADER_LEN + NCP_CMD_SIZE
+#error "NCP_SPI_MAX_TRANSFER must hold a full NCP command"
+#endif
+
+// SPI clock polarity and phase
+#ifndef NCP_SPI_CLOCK_MODE
+#define NCP_SPI_CLOCK_MODE              usartClockMode0
+#endif
+
+// Time the host waits between asserting chip select and the first clock, in us
+#ifndef NCP_SPI_CS_SETUP_US
+#define NCP_SPI_CS_SETUP_US             20
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize SPI slave for NCP.
+ *
+ * @details
+ *   This function will initialize the USART in synchronous slave mode with
+ *   LDMA on both directions and start receiving NCP commands.
+ *
+ ******************************************************************************/
+void ncp_spi_init();
+
+/***************************************************************************//**
+ * @brief
+ *   Update the host interrupt line.
+ *
+ * @details
+ *   This function will handle SPI_UPDATE signal and assert the host interrupt
+ *   line while target data is waiting for a transfer.
+ *
+ ******************************************************************************/
+void ncp_spi_status_update();
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of completed transfers.
+ *
+ * @return
+ *   Number of transfers since initialization.
+ *
+ ******************************************************************************/
+uint32_t ncp_spi_transfers();
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of receive errors.
+ *
+ * @return
+ *   Number of transfers whose host data was truncated or could not be
+ *   accepted since initialization.
+ *
+ ******************************************************************************/
+uint32_t ncp_spi_rx_errors();
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of aborted transfers.
+ *
+ * @return
+ *   Number of transfers which ended before the target data was clocked out
+ *   since initialization.
+ *
+ ******************************************************************************/
+uint32_t ncp_spi_tx_aborts();
+
+/***************************************************************************//**
+ * @brief
+ *   This function should be called in application's event loop.
+ *
+ * @details
+ *   This function will handle an event and return if the event was processed by
+ *    the library or not.
+ *
+ * @param[in] evt
+ *   Pointer to the event received from the Bluetooth stack.
+ *
+ * @return
+ *   True if the event was processed, False otherwise.
+ *
+ ******************************************************************************/
+bool ncp_handle_event(struct gecko_cmd_packet *evt);
+
+#endif /* NCP_SPI_H_ */
@@ -15,20 +15,56 @@
  * sections of the MSLA applicable to Source Code.
  *
  ******************************************************************************/
+#include "hal-config.h"
+
+#if !defined(NCP_SPI_ENABLED)
+
 #include "ble-configuration.h"
 #include "board_features.h"
 
+#include <string.h>
 #include "em_assert.h"
 #include "em_device.h"
+#include "em_cmu.h"
 #include "uartdrv.h"
 #include "em_core.h"
 #include "ncp_usart.h"
 #include "gpiointerrupt.h"
 #include "sleep.h"
+#if defined(NCP_USART_FRAMING_ENABLED)
+#include "ncp_frame.h"
+#endif
+
+#if NCP_CHANNEL_COUNT > EMDRV_UARTDRV_MAX_DRIVER_INSTANCES
+#error "Each NCP channel needs its own UARTDRV instance"
+#endif
+
+#if defined(NCP_USART_FRAMING_ENABLED)
+// Room for a leading delimiter and a worst case encoded command
+#define NCP_USART_RX_BUF_SIZE  (1 + NCP_FRAME_ENCODED_LEN(NCP_CMD_SIZE))
+// Shared by all channels, events and responses are only encoded in main context
+static uint8_t txframe[NCP_FRAME_ENCODED_LEN(NCP_CMD_SIZE)];
+static volatile uint32_t frame_errors = 0;
+static bool ncp_usart_frame_received(uint8_t channel, uint32_t received);
+#else
+#define NCP_USART_RX_BUF_SIZE  NCP_CMD_SIZE
+#endif
 
-// temporary buffer for receiving data from UART
-static uint8_t rxbuf[NCP_CMD_SIZE];
-static uint32_t* cmd_header = (uint32_t*)rxbuf;
+// Receive state of a channel
+typedef struct {
+  UARTDRV_HandleData_t handle_data;
+  // temporary buffer for receiving data from UART
+  uint8_t rxbuf[NCP_USART_RX_BUF_SIZE];
+  uint32_t timeout_reset;
+  volatile uint32_t timeout;
+#if defined(NCP_USART_FRAMING_ENABLED)
+  // Start of the frame being received and scan position in rxbuf
+  uint32_t rx_frame_start;
+  uint32_t rx_frame_scan;
+#endif
+} ncp_usart_channel_t;
+
+static ncp_usart_channel_t usart_channels[NCP_CHANNEL_COUNT];
 #if defined(NCP_DEEP_SLEEP_ENABLED)
 static void ncp_enable_deep_sleep();
 static volatile bool sleep_requested = false;
@@ -36,12 +72,27 @@ static volatile bool sleep_requested = false;
 #if defined(NCP_HOST_WAKEUP_ENABLED)
 static void ncp_enable_host_wakeup();
 #endif
-static volatile uint32_t cmd_len = 0;
-static uint32_t timeout_reset = 0;
-static volatile uint32_t timeout = 0;
+// Runtime baud rate switch, primary channel only
+static uint32_t baudrate = HAL_UARTNCP_BAUD_RATE;
+static uint32_t baudrate_fallback = HAL_UARTNCP_BAUD_RATE;
+static uint32_t baudrate_pending = 0;
+static volatile bool baudrate_probing = false;
+static volatile uint32_t probe_errors = 0;
+static volatile uint32_t link_errors = 0;
 
 static uint32_t ncp_usart_transmit(uint8_t* data, uint8_t len);
-static void ncp_usart_receive_next();
+static uint32_t ncp_usart_channel_transmit(uint8_t channel, uint8_t* data, uint8_t len);
+static void ncp_usart_channel_start(uint8_t channel, uint32_t baudrate,
+                                    uint32_t (*transmit)(uint8_t*, uint8_t),
+                                    IRQn_Type rx_irqn, void* rx_handler,
+                                    IRQn_Type tx_irqn, void* tx_handler);
+static void ncp_usart_receive_next(uint8_t channel);
+static void ncp_usart_rx_irq(uint8_t channel);
+static void ncp_usart_tx_irq(uint8_t channel);
+static uint32_t ncp_usart_baudrate_calc(uint32_t requested);
+static void ncp_usart_baudrate_apply(uint32_t requested);
+static void ncp_usart_baudrate_probe_end(bool keep);
+static void ncp_usart_baudrate_update();
 static void uart_rx_callback(UARTDRV_Handle_t handle, Ecode_t transferStatus, uint8_t *data,
                              UARTDRV_Count_t transferCount);
 static void uart_tx_callback(UARTDRV_Handle_t handle, Ecode_t transferStatus, uint8_t *data,
@@ -49,13 +100,99 @@ static void uart_tx_callback(UARTDRV_Handle_t handle, Ecode_t transferStatus, ui
 void NCP_USART_IRQ_NAME(void);
 void NCP_USART_TX_IRQ_NAME(void);
 
-// UART driver instance handle
-UARTDRV_HandleData_t handleData;
-UARTDRV_Handle_t handle = &handleData;
+// UART driver instance handle of the primary channel
+UARTDRV_Handle_t handle = &usart_channels[0].handle_data;
+
+// Define receive/transmit operation queues of each channel
+#define DEFINE_CHANNEL_BUF_QUEUES(n)                                          \
+  DEFINE_BUF_QUEUE(EMDRV_UARTDRV_MAX_CONCURRENT_RX_BUFS, rxBufferQueueI##n); \
+  DEFINE_BUF_QUEUE(EMDRV_UARTDRV_MAX_CONCURRENT_TX_BUFS, txBufferQueueI##n);
+NCP_CHANNEL_FOREACH(DEFINE_CHANNEL_BUF_QUEUES)
 
-// Define receive/transmit operation queues
-DEFINE_BUF_QUEUE(EMDRV_UARTDRV_MAX_CONCURRENT_RX_BUFS, rxBufferQueueI0);
-DEFINE_BUF_QUEUE(EMDRV_UARTDRV_MAX_CONCURRENT_TX_BUFS, txBufferQueueI0);
+// Additional channels run on their own UART at a fixed baud rate without flow
+// control, configured by BSP_UARTNCPn_* and HAL_UARTNCPn_BAUD_RATE
+#define DEFINE_AUX_CHANNEL(n)                                                 \
+  static uint32_t ncp_usart_transmit_##n(uint8_t* data, uint8_t len)          \
+  {                                                                           \
+    return ncp_usart_channel_transmit(n, data, len);                          \
+  }                                                                           \
+  static void ncp_usart_rx_irq_##n(void)                                      \
+  {                                                                           \
+    ncp_usart_rx_irq(n);                                                      \
+  }                                                                           \
+  static void ncp_usart_tx_irq_##n(void)                                      \
+  {                                                                           \
+    ncp_usart_tx_irq(n);                                                      \
+  }                                                                           \
+  static void ncp_usart_init_##n(void)                                        \
+  {                                                                           \
+    UARTDRV_InitUart_t initData = { 0 };                                      \
+    IRQn_Type rx_irqn;                                                        \
+    IRQn_Type tx_irqn;                                                        \
+    Ecode_t retVal;                                                           \
+    initData.port = ncp_usart_port_lookup(BSP_UARTNCP##n##_USART_PORT,        \
+                                          &rx_irqn, &tx_irqn);                \
+    EFM_ASSERT(initData.port != NULL);                                        \
+    initData.portLocationTx = BSP_UARTNCP##n##_TX_LOC;                        \
+    initData.portLocationRx = BSP_UARTNCP##n##_RX_LOC;                        \
+    initData.baudRate = HAL_UARTNCP##n##_BAUD_RATE;                           \
+    initData.stopBits = NCP_USART_STOPBITS;                                   \
+    initData.parity = NCP_USART_PARITY;                                       \
+    initData.oversampling = NCP_USART_OVS;                                    \
+    initData.mvdis = NCP_USART_MVDIS;                                         \
+    initData.fcType = uartdrvFlowControlNone;                                 \
+    initData.rxQueue = (UARTDRV_Buffer_FifoQueue_t*)&rxBufferQueueI##n;       \
+    initData.txQueue = (UARTDRV_Buffer_FifoQueue_t*)&txBufferQueueI##n;       \
+    retVal = UARTDRV_InitUart(&usart_channels[n].handle_data, &initData);     \
+    EFM_ASSERT(retVal == ECODE_EMDRV_UARTDRV_OK);                             \
+    ncp_usart_channel_start(n, initData.baudRate, ncp_usart_transmit_##n,     \
+                            rx_irqn, (void *)ncp_usart_rx_irq_##n,            \
+                            tx_irqn, (void *)ncp_usart_tx_irq_##n);           \
+  }
+
+#if NCP_CHANNEL_COUNT > 1
+// USART peripheral and interrupts of a HAL_SERIAL_PORT_USARTn port
+static USART_TypeDef* ncp_usart_port_lookup(uint8_t port, IRQn_Type* rx_irqn,
+                                            IRQn_Type* tx_irqn)
+{
+  switch (port) {
+#if defined(USART0)
+    case HAL_SERIAL_PORT_USART0:
+      *rx_irqn = USART0_RX_IRQn;
+      *tx_irqn = USART0_TX_IRQn;
+      return USART0;
+#endif
+#if defined(USART1)
+    case HAL_SERIAL_PORT_USART1:
+      *rx_irqn = USART1_RX_IRQn;
+      *tx_irqn = USART1_TX_IRQn;
+      return USART1;
+#endif
+#if defined(USART2)
+    case HAL_SERIAL_PORT_USART2:
+      *rx_irqn = USART2_RX_IRQn;
+      *tx_irqn = USART2_TX_IRQn;
+      return USART2;
+#endif
+#if defined(USART3)
+    case HAL_SERIAL_PORT_USART3:
+      *rx_irqn = USART3_RX_IRQn;
+      *tx_irqn = USART3_TX_IRQn;
+      return USART3;
+#endif
+    default:
+      return NULL;
+  }
+}
+
+DEFINE_AUX_CHANNEL(1)
+#endif
+#if NCP_CHANNEL_COUNT > 2
+DEFINE_AUX_CHANNEL(2)
+#endif
+#if NCP_CHANNEL_COUNT > 3
+DEFINE_AUX_CHANNEL(3)
+#endif
 
 void ncp_usart_init()
 {
@@ -88,8 +225,6 @@ void ncp_usart_init()
 
   retVal = UARTDRV_InitUart(handle, &initData);
   EFM_ASSERT(retVal == ECODE_EMDRV_UARTDRV_OK);
-  timeout_reset = initData.baudRate / 64;
-  ncp_set_transmit_callback(ncp_usart_transmit);
   ncp_usart_status_update();
 
 #if defined(NCP_DEEP_SLEEP_ENABLED)
@@ -104,75 +239,175 @@ void ncp_usart_init()
 #if defined(NCP_HOST_WAKEUP_ENABLED)
   ncp_enable_host_wakeup();
 #endif  // NCP_HOST_WAKEUP_ENABLED
-  CORE_SetNvicRamTableHandler(NCP_USART_IRQn, (void *)NCP_USART_IRQ_NAME);
-  CORE_SetNvicRamTableHandler(NCP_USART_TX_IRQn, (void *)NCP_USART_TX_IRQ_NAME);
-  NVIC_ClearPendingIRQ(NCP_USART_IRQn);           // Clear pending RX interrupt flag in NVIC
-  NVIC_ClearPendingIRQ(NCP_USART_TX_IRQn);        // Clear pending TX interrupt flag in NVIC
-  NVIC_EnableIRQ(NCP_USART_IRQn);
-  NVIC_EnableIRQ(NCP_USART_TX_IRQn);
+  ncp_usart_channel_start(0, initData.baudRate, ncp_usart_transmit,
+                          NCP_USART_IRQn, (void *)NCP_USART_IRQ_NAME,
+                          NCP_USART_TX_IRQn, (void *)NCP_USART_TX_IRQ_NAME);
+#if NCP_CHANNEL_COUNT > 1
+  ncp_usart_init_1();
+#endif
+#if NCP_CHANNEL_COUNT > 2
+  ncp_usart_init_2();
+#endif
+#if NCP_CHANNEL_COUNT > 3
+  ncp_usart_init_3();
+#endif
+}
+
+// Attach an initialized UART to its NCP channel and start receiving commands
+static void ncp_usart_channel_start(uint8_t channel, uint32_t baudrate,
+                                    uint32_t (*transmit)(uint8_t*, uint8_t),
+                                    IRQn_Type rx_irqn, void* rx_handler,
+                                    IRQn_Type tx_irqn, void* tx_handler)
+{
+  ncp_usart_channel_t* ch = &usart_channels[channel];
+  UARTDRV_Handle_t h = &ch->handle_data;
+
+  ch->timeout_reset = baudrate / 64;
+  ncp_channel_set_transmit_callback(channel, transmit);
+#if defined(NCP_USART_FRAMING_ENABLED)
+  ncp_channel_set_transmit_encoder(channel, ncp_frame_encode, txframe, sizeof(txframe));
+#endif
+  CORE_SetNvicRamTableHandler(rx_irqn, rx_handler);
+  CORE_SetNvicRamTableHandler(tx_irqn, tx_handler);
+  NVIC_ClearPendingIRQ(rx_irqn);           // Clear pending RX interrupt flag in NVIC
+  NVIC_ClearPendingIRQ(tx_irqn);           // Clear pending TX interrupt flag in NVIC
+  NVIC_EnableIRQ(rx_irqn);
+  NVIC_EnableIRQ(tx_irqn);
 
   //Setup RX timeout
-  handle->peripheral.uart->TIMECMP1 = USART_TIMECMP1_RESTARTEN
-                                      | USART_TIMECMP1_TSTOP_RXACT
-                                      | USART_TIMECMP1_TSTART_RXEOF
-                                      | (0x30 << _USART_TIMECMP1_TCMPVAL_SHIFT);
+  h->peripheral.uart->TIMECMP1 = USART_TIMECMP1_RESTARTEN
+                                 | USART_TIMECMP1_TSTOP_RXACT
+                                 | USART_TIMECMP1_TSTART_RXEOF
+                                 | (0x30 << _USART_TIMECMP1_TCMPVAL_SHIFT);
   //IRQ
-  USART_IntClear(handle->peripheral.uart, _USART_IF_MASK);       // Clear any USART interrupt flags
-  USART_IntEnable(handle->peripheral.uart, USART_IF_TXIDLE | USART_IF_TCMP1);
+  USART_IntClear(h->peripheral.uart, _USART_IF_MASK);       // Clear any USART interrupt flags
+  USART_IntEnable(h->peripheral.uart, USART_IF_TXIDLE | USART_IF_TCMP1
+                  | USART_IF_FERR | USART_IF_PERR);
   /* RX the next command header*/
-  UARTDRV_Receive(handle, rxbuf, NCP_CMD_SIZE, uart_rx_callback);
-  timeout = timeout_reset;
+  UARTDRV_Receive(h, ch->rxbuf, NCP_USART_RX_BUF_SIZE, uart_rx_callback);
+  ch->timeout = ch->timeout_reset;
 }
 
-static void ncp_usart_receive_next()
+static void ncp_usart_receive_next(uint8_t channel)
 {
+  ncp_usart_channel_t* ch = &usart_channels[channel];
+  UARTDRV_Handle_t h = &ch->handle_data;
+
   gecko_external_signal(NCP_USART_UPDATE_SIGNAL);
   //stop the timer
-  handle->peripheral.uart->TIMECMP1 &= ~_USART_TIMECMP1_TSTART_MASK;
-  handle->peripheral.uart->TIMECMP1 |= USART_TIMECMP1_TSTART_RXEOF;
-  USART_IntClear(handle->peripheral.uart, USART_IF_TCMP1);
+  h->peripheral.uart->TIMECMP1 &= ~_USART_TIMECMP1_TSTART_MASK;
+  h->peripheral.uart->TIMECMP1 |= USART_TIMECMP1_TSTART_RXEOF;
+  USART_IntClear(h->peripheral.uart, USART_IF_TCMP1);
   //abort receive operation
-  UARTDRV_Abort(handle, uartdrvAbortReceive);
+  UARTDRV_Abort(h, uartdrvAbortReceive);
   //enqueue next receive buffer
-  UARTDRV_Receive(handle, rxbuf, NCP_CMD_SIZE, uart_rx_callback);
-  timeout = timeout_reset;
+  UARTDRV_Receive(h, ch->rxbuf, NCP_USART_RX_BUF_SIZE, uart_rx_callback);
+#if defined(NCP_USART_FRAMING_ENABLED)
+  ch->rx_frame_start = 0;
+  ch->rx_frame_scan = 0;
+#endif
+  ch->timeout = ch->timeout_reset;
 }
 
-void NCP_USART_IRQ_NAME()
+#if defined(NCP_USART_FRAMING_ENABLED)
+// Decode the frames completed in rxbuf, returns true once rxbuf can be reused
+static bool ncp_usart_frame_received(uint8_t channel, uint32_t received)
 {
-  if (handle->peripheral.uart->IF & USART_IF_TCMP1) {
+  ncp_usart_channel_t* ch = &usart_channels[channel];
+
+  for (; ch->rx_frame_scan < received; ch->rx_frame_scan++) {
+    if (ch->rxbuf[ch->rx_frame_scan] != NCP_FRAME_DELIMITER) {
+      continue;
+    }
+    if (ch->rx_frame_scan > ch->rx_frame_start) {
+      uint8_t* frame = &ch->rxbuf[ch->rx_frame_start];
+      // the CRC is decoded into the buffer too before it is stripped, the
+      // encoded frame is always longer so it fits in place
+      uint32_t len = ncp_frame_decode(frame, ch->rx_frame_scan - ch->rx_frame_start,
+                                      frame, NCP_CMD_SIZE + NCP_FRAME_CRC_LEN);
+      if (len >= BGLIB_MSG_HEADER_LEN
+          && len == BGLIB_MSG_LEN(frame[0] | (frame[1] << 8)) + BGLIB_MSG_HEADER_LEN) {
+        ncp_channel_receive_command(channel, frame, len);
+        return true;
+      }
+      // corrupted frame, resynchronize on this delimiter
+      frame_errors++;
+    }
+    ch->rx_frame_start = ch->rx_frame_scan + 1;
+  }
+  if (received == NCP_USART_RX_BUF_SIZE) {
+    // no delimiter in a full buffer
+    frame_errors++;
+    return true;
+  }
+  return received > 0 && ch->rx_frame_start == received;
+}
+#endif
+
+static void ncp_usart_rx_irq(uint8_t channel)
+{
+  ncp_usart_channel_t* ch = &usart_channels[channel];
+  UARTDRV_Handle_t h = &ch->handle_data;
+
+  if (h->peripheral.uart->IF & (USART_IF_FERR | USART_IF_PERR)) {
+    USART_IntClear(h->peripheral.uart, USART_IF_FERR | USART_IF_PERR);
+    link_errors++;
+    if (channel == 0 && baudrate_probing
+        && ++probe_errors == NCP_USART_BAUD_PROBE_ERRORS) {
+      gecko_external_signal(NCP_USART_FALLBACK_SIGNAL);
+    }
+  }
+  if (h->peripheral.uart->IF & USART_IF_TCMP1) {
     /* RX timeout, stop transfer and handle what we got in buffer */
-    USART_IntClear(handle->peripheral.uart, USART_IF_TCMP1);
-    if (timeout > 0) {
-      timeout--;
+    USART_IntClear(h->peripheral.uart, USART_IF_TCMP1);
+    if (ch->timeout > 0) {
+      ch->timeout--;
       uint8_t* buffer = NULL;
       uint32_t received = 0;
       uint32_t remaining = 0;
-      UARTDRV_GetReceiveStatus(handle, &buffer, &received, &remaining);
+      UARTDRV_GetReceiveStatus(h, &buffer, &received, &remaining);
+#if defined(NCP_USART_FRAMING_ENABLED)
+      if (buffer && ncp_usart_frame_received(channel, received)) {
+        ncp_usart_receive_next(channel);
+      }
+#else
       if (buffer && received >= BGLIB_MSG_HEADER_LEN) {
-        cmd_len = BGLIB_MSG_LEN(*cmd_header) + BGLIB_MSG_HEADER_LEN;
+        uint32_t cmd_len = BGLIB_MSG_LEN(buffer[0] | (buffer[1] << 8)) + BGLIB_MSG_HEADER_LEN;
         if (received >= cmd_len) {
           EFM_ASSERT(received <= NCP_CMD_SIZE);
           //current command is received
-          ncp_receive_command(buffer, cmd_len);
-          ncp_usart_receive_next();
+          ncp_channel_receive_command(channel, buffer, cmd_len);
+          ncp_usart_receive_next(channel);
         }
       }
+#endif
     } else {
       gecko_external_signal(NCP_USART_TIMEOUT_SIGNAL);
-      ncp_usart_receive_next();
+      ncp_usart_receive_next(channel);
     }
   }
 }
 
-void NCP_USART_TX_IRQ_NAME()
+static void ncp_usart_tx_irq(uint8_t channel)
 {
-  if (handle->peripheral.uart->IF & USART_IF_TXIDLE) {
+  UARTDRV_Handle_t h = &usart_channels[channel].handle_data;
+
+  if (h->peripheral.uart->IF & USART_IF_TXIDLE) {
     gecko_external_signal(NCP_USART_UPDATE_SIGNAL);
-    USART_IntClear(handle->peripheral.uart, USART_IF_TXIDLE);
+    USART_IntClear(h->peripheral.uart, USART_IF_TXIDLE);
   }
 }
 
+void NCP_USART_IRQ_NAME()
+{
+  ncp_usart_rx_irq(0);
+}
+
+void NCP_USART_TX_IRQ_NAME()
+{
+  ncp_usart_tx_irq(0);
+}
+
 static void uart_rx_callback(UARTDRV_Handle_t handle, Ecode_t transferStatus, uint8_t *data, UARTDRV_Count_t transferCount)
 {
   //let RX timeout handle it
@@ -184,9 +419,141 @@ static void uart_tx_callback(UARTDRV_Handle_t handle, Ecode_t transferStatus, ui
 }
 
 static uint32_t ncp_usart_transmit(uint8_t* data, uint8_t len)
+{
+  return ncp_usart_channel_transmit(0, data, len);
+}
+
+static uint32_t ncp_usart_channel_transmit(uint8_t channel, uint8_t* data, uint8_t len)
 {
   ncp_usart_status_update();
-  return UARTDRV_Transmit(handle, data, len, uart_tx_callback);
+  return UARTDRV_Transmit(&usart_channels[channel].handle_data, data, len, uart_tx_callback);
+}
+
+uint32_t ncp_usart_baudrate_request(uint32_t requested)
+{
+  uint32_t actual = ncp_usart_baudrate_calc(requested);
+  if (actual == 0 || baudrate_probing) {
+    return 0;
+  }
+  baudrate_pending = actual;
+  // the host switches as soon as it reads the response, events must not
+  // follow it at the old baud rate
+  ncp_channel_transmit_hold(0, true);
+  return actual;
+}
+
+bool ncp_usart_baudrate_confirm(const uint8_t* pattern, uint8_t len)
+{
+  static const uint8_t expected[NCP_USART_BAUD_PATTERN_LEN] = NCP_USART_BAUD_PATTERN;
+  if (!baudrate_probing || len != NCP_USART_BAUD_PATTERN_LEN
+      || memcmp(pattern, expected, len) != 0) {
+    return false;
+  }
+  ncp_usart_baudrate_probe_end(true);
+  return true;
+}
+
+uint32_t ncp_usart_baudrate_get()
+{
+  return baudrate;
+}
+
+uint32_t ncp_usart_link_errors()
+{
+  return link_errors;
+}
+
+uint32_t ncp_usart_frame_errors()
+{
+#if defined(NCP_USART_FRAMING_ENABLED)
+  return frame_errors;
+#else
+  return 0;
+#endif
+}
+
+// Baud rate the USART runs at for a requested one, 0 if out of tolerance
+static uint32_t ncp_usart_baudrate_calc(uint32_t requested)
+{
+  uint32_t refFreq = CMU_ClockFreqGet(cmuClock_HFPER);
+  uint32_t oversample;
+  uint32_t clkdiv;
+  uint32_t actual;
+  uint32_t deviation;
+
+  switch (NCP_USART_OVS) {
+    case usartOVS8:
+      oversample = 8;
+      break;
+    case usartOVS6:
+      oversample = 6;
+      break;
+    case usartOVS4:
+      oversample = 4;
+      break;
+    default:
+      oversample = 16;
+      break;
+  }
+  if (requested < NCP_USART_BAUD_RATE_MIN || requested > NCP_USART_BAUD_RATE_MAX
+      || requested > refFreq / oversample) {
+    return 0;
+  }
+  // Same divider as USART_BaudrateAsyncSet(), 5 fractional bits
+  clkdiv = (32 * refFreq + (oversample * requested) / 2) / (oversample * requested);
+  clkdiv = (clkdiv - 32) * 8;
+  if (clkdiv > _USART_CLKDIV_DIV_MASK) {
+    return 0;
+  }
+  actual = USART_BaudrateCalc(refFreq, clkdiv, false, NCP_USART_OVS);
+  deviation = (actual > requested) ? actual - requested : requested - actual;
+  if ((uint64_t)deviation * 1000 > (uint64_t)requested * NCP_USART_BAUD_RATE_TOLERANCE) {
+    return 0;
+  }
+  return actual;
+}
+
+static void ncp_usart_baudrate_apply(uint32_t requested)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  USART_BaudrateAsyncSet(handle->peripheral.uart, 0, requested, NCP_USART_OVS);
+  baudrate = requested;
+  usart_channels[0].timeout_reset = requested / 64;
+  // anything partially received belongs to the old baud rate
+  ncp_usart_receive_next(0);
+  CORE_EXIT_ATOMIC();
+}
+
+static void ncp_usart_baudrate_probe_end(bool keep)
+{
+  gecko_cmd_hardware_set_soft_timer(0, NCP_USART_BAUD_TIMER_HANDLE, 0);
+  baudrate_probing = false;
+  if (keep) {
+    baudrate_fallback = baudrate;
+  } else {
+    ncp_usart_baudrate_apply(baudrate_fallback);
+  }
+}
+
+// Switch to the pending baud rate once the response went out, then send the
+// events held back meanwhile at the new one
+static void ncp_usart_baudrate_update()
+{
+  if (baudrate_pending == 0
+      || ncp_channel_transmit_pending(0)
+      || UARTDRV_GetTransmitDepth(handle) != 0
+      || !(UARTDRV_GetPeripheralStatus(handle) & UARTDRV_STATUS_TXC)) {
+    return;
+  }
+  baudrate_fallback = baudrate;
+  probe_errors = 0;
+  baudrate_probing = true;
+  ncp_usart_baudrate_apply(baudrate_pending);
+  baudrate_pending = 0;
+  ncp_channel_transmit_hold(0, false);
+  gecko_cmd_hardware_set_soft_timer(NCP_USART_BAUD_PROBE_MS * 32768 / 1000,
+                                    NCP_USART_BAUD_TIMER_HANDLE, 1);
 }
 
 #if defined(NCP_DEEP_SLEEP_ENABLED)
@@ -226,7 +593,7 @@ static void ncp_enable_host_wakeup()
 void ncp_usart_status_update()
 {
 #if defined(NCP_HOST_WAKEUP_ENABLED)
-  if (ncp_transmit_queue_len() > 0
+  if (ncp_channel_transmit_queue_len(0) > 0
       || (UARTDRV_GetTransmitDepth(handle) != 0)) {
     NCP_HOST_WAKEUP_POLARITY ? GPIO_PinOutSet(NCP_HOST_WAKEUP_PORT, NCP_HOST_WAKEUP_PIN)
     : GPIO_PinOutClear(NCP_HOST_WAKEUP_PORT, NCP_HOST_WAKEUP_PIN);
@@ -245,7 +612,7 @@ void ncp_usart_status_update()
       && (status & UARTDRV_STATUS_TXIDLE)
       && ((status & UARTDRV_STATUS_RXDATAV) == 0)
       && ((status & _USART_STATUS_TXBUFCNT_MASK) == 0)
-      && ncp_transmit_queue_len() == 0) {
+      && ncp_channel_transmit_queue_len(0) == 0) {
     if (sleepStatus != true) {
       SLEEP_SleepBlockEnd(sleepEM2);
 #if defined(NCP_USART_FLOW_CONTROL_ENABLED)
@@ -289,6 +656,23 @@ bool ncp_handle_event(struct gecko_cmd_packet *evt)
       }
       if (evt->data.evt_system_external_signal.extsignals & NCP_USART_UPDATE_SIGNAL) {
         ncp_usart_status_update();
+        ncp_usart_baudrate_update();
+        evt_handled = true;
+      }
+      if (evt->data.evt_system_external_signal.extsignals & NCP_USART_FALLBACK_SIGNAL) {
+        // Too many receive errors at the baud rate being probed
+        if (baudrate_probing) {
+          ncp_usart_baudrate_probe_end(false);
+        }
+        evt_handled = true;
+      }
+      break;
+    case gecko_evt_hardware_soft_timer_id:
+      if (evt->data.evt_hardware_soft_timer.handle == NCP_USART_BAUD_TIMER_HANDLE) {
+        // Host did not confirm the new baud rate in time
+        if (baudrate_probing) {
+          ncp_usart_baudrate_probe_end(false);
+        }
         evt_handled = true;
       }
       break;
@@ -296,4 +680,6 @@ bool ncp_handle_event(struct gecko_cmd_packet *evt)
       break;
   }
   return evt_handled;
-}
\ No newline at end of file
+}
+
+#endif // !NCP_SPI_ENABLED
@@ -62,9 +62,43 @@
 #error "Unsupported UART port!"
 #endif
 
+// The UART sleeps with the host of the primary channel, which would stall
+// the other channels
+#if defined(NCP_DEEP_SLEEP_ENABLED) && (NCP_CHANNEL_COUNT > 1)
+#error "NCP_DEEP_SLEEP_ENABLED supports a single NCP channel only"
+#endif
+
 #define NCP_USART_WAKEUP_SIGNAL         (1 << 0)
 #define NCP_USART_UPDATE_SIGNAL         (1 << 1)
 #define NCP_USART_TIMEOUT_SIGNAL        (1 << 2)
+#define NCP_USART_FALLBACK_SIGNAL       (1 << 3)
+
+// Limits of the baud rate the host can switch to at runtime
+#ifndef NCP_USART_BAUD_RATE_MIN
+#define NCP_USART_BAUD_RATE_MIN         9600
+#endif
+#ifndef NCP_USART_BAUD_RATE_MAX
+#define NCP_USART_BAUD_RATE_MAX         2000000
+#endif
+// Maximum deviation of the achievable baud rate from the requested one, in 0.1%
+#ifndef NCP_USART_BAUD_RATE_TOLERANCE
+#define NCP_USART_BAUD_RATE_TOLERANCE   20
+#endif
+// Time the host has to confirm a new baud rate before falling back, in ms
+#ifndef NCP_USART_BAUD_PROBE_MS
+#define NCP_USART_BAUD_PROBE_MS         500
+#endif
+// Number of framing or parity errors during the probe that cause a fallback
+#ifndef NCP_USART_BAUD_PROBE_ERRORS
+#define NCP_USART_BAUD_PROBE_ERRORS     4
+#endif
+// Soft timer handle reserved for the baud rate probe
+#define NCP_USART_BAUD_TIMER_HANDLE     0xfe
+
+// Test pattern the host sends to confirm a new baud rate, mixing
+// alternating bits, long runs and nibble edges
+#define NCP_USART_BAUD_PATTERN_LEN      8
+#define NCP_USART_BAUD_PATTERN          { 0x55, 0xaa, 0x00, 0xff, 0x0f, 0xf0, 0x33, 0xcc }
 
 /***************************************************************************//**
  * @brief
@@ -86,6 +120,77 @@ void ncp_usart_init();
  ******************************************************************************/
 void ncp_usart_status_update();
 
+/***************************************************************************//**
+ * @brief
+ *   Request a switch to another baud rate.
+ *
+ * @details
+ *   The switch takes place once the TX queue is drained, so the response to
+ *   the request still goes out at the current baud rate. The host must then
+ *   confirm the new baud rate with ncp_usart_baudrate_confirm() within
+ *   NCP_USART_BAUD_PROBE_MS, otherwise the USART falls back to the previous
+ *   baud rate. Repeated framing errors during that time fall back right away.
+ *
+ * @param[in] baudrate
+ *   Requested baud rate.
+ *
+ * @return
+ *   Baud rate the USART will actually run at, or 0 if the requested baud
+ *   rate cannot be reached.
+ *
+ ******************************************************************************/
+uint32_t ncp_usart_baudrate_request(uint32_t baudrate);
+
+/***************************************************************************//**
+ * @brief
+ *   Confirm the baud rate being probed.
+ *
+ * @param[in] pattern
+ *   Test pattern received from the host, must match NCP_USART_BAUD_PATTERN.
+ *
+ * @param[in] len
+ *   Length of the test pattern.
+ *
+ * @return
+ *   True if the new baud rate is kept, False if no probe is running or the
+ *   pattern is corrupted.
+ *
+ ******************************************************************************/
+bool ncp_usart_baudrate_confirm(const uint8_t* pattern, uint8_t len);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the current baud rate.
+ *
+ * @return
+ *   Baud rate the USART is running at.
+ *
+ ******************************************************************************/
+uint32_t ncp_usart_baudrate_get();
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of receive errors.
+ *
+ * @return
+ *   Number of framing and parity errors since initialization.
+ *
+ ******************************************************************************/
+uint32_t ncp_usart_link_errors();
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of corrupted frames.
+ *
+ * @details
+ *   Only counted when NCP_USART_FRAMING_ENABLED is defined.
+ *
+ * @return
+ *   Number of frames dropped for a CRC or encoding error since initialization.
+ *
+ ******************************************************************************/
+uint32_t ncp_usart_frame_errors();
+
 /***************************************************************************//**
  * @brief
  *   This function should be called in application's event loop.
@@ -57,6 +57,7 @@ extern "C" {
 #define ECODE_EMDRV_DMADRV_IN_USE              (ECODE_EMDRV_DMADRV_BASE | 0x00000005)   ///< DMA is in use.
 #define ECODE_EMDRV_DMADRV_ALREADY_FREED       (ECODE_EMDRV_DMADRV_BASE | 0x00000006)   ///< A DMA channel was free.
 #define ECODE_EMDRV_DMADRV_CH_NOT_ALLOCATED    (ECODE_EMDRV_DMADRV_BASE | 0x00000007)   ///< A channel is not reserved.
+#define ECODE_EMDRV_DMADRV_DESC_EXHAUSTED      (ECODE_EMDRV_DMADRV_BASE | 0x00000008)   ///< No scatter-gather descriptors available.
 
 /***************************************************************************//**
  * @brief
@@ -83,6 +84,12 @@ typedef bool (*DMADRV_Callback_t)(unsigned int channel,
                                   unsigned int sequenceNo,
                                   void *userParam);
 
+/// One buffer of a scatter-gather transfer.
+typedef struct {
+  void *buf;                          ///< Buffer address.
+  int  len;                           ///< Number of items (of transfer item size) in the buffer.
+} DMADRV_Segment_t;
+
 #if defined(DMA_PRESENT) && (DMA_COUNT == 1)
 
 /// Maximum length of one DMA transfer.
@@ -954,6 +961,34 @@ Ecode_t DMADRV_PeripheralMemoryPingPong(unsigned int          channelId,
                                         void                  *cbUserParam);
 #endif
 
+#if (defined(EMDRV_DMADRV_LDMA) && !defined(EMDRV_DMADRV_USE_NATIVE_API)) \
+  || defined(DOXY_DOC_ONLY)
+Ecode_t DMADRV_MemoryPeripheralGather(unsigned int          channelId,
+                                      DMADRV_PeripheralSignal_t peripheralSignal,
+                                      void                  *dst,
+                                      const DMADRV_Segment_t *src,
+                                      int                   count,
+                                      DMADRV_DataSize_t     size,
+                                      DMADRV_Callback_t     callback,
+                                      void                  *cbUserParam);
+Ecode_t DMADRV_MemoryMemory(unsigned int          channelId,
+                            void                  *dst,
+                            void                  *src,
+                            bool                  srcInc,
+                            int                   len,
+                            DMADRV_DataSize_t     size,
+                            DMADRV_Callback_t     callback,
+                            void                  *cbUserParam);
+Ecode_t DMADRV_PeripheralMemoryScatter(unsigned int          channelId,
+                                       DMADRV_PeripheralSignal_t peripheralSignal,
+                                       const DMADRV_Segment_t *dst,
+                                       void                  *src,
+                                       int                   count,
+                                       DMADRV_DataSize_t     size,
+                                       DMADRV_Callback_t     callback,
+                                       void                  *cbUserParam);
+#endif
+
 #if defined(EMDRV_DMADRV_LDMA) && defined(EMDRV_DMADRV_USE_NATIVE_API)
 
 Ecode_t DMADRV_LdmaStartTransfer(
@@ -42,7 +42,8 @@ typedef enum {
 
 typedef enum {
   dmaModeBasic,
-  dmaModePingPong
+  dmaModePingPong,
+  dmaModeScatterGather
 } DmaMode_t;
 
 #if defined(EMDRV_DMADRV_USE_NATIVE_API) && defined(EMDRV_DMADRV_UDMA)
@@ -69,6 +70,7 @@ typedef struct {
   bool              allocated;
 #if defined(EMDRV_DMADRV_LDMA)
   DmaMode_t         mode;
+  uint32_t          sgDescMask;
 #endif
 } ChTable_t;
 #endif
@@ -84,12 +86,29 @@ static DMA_CB_TypeDef dmaCallBack[EMDRV_DMADRV_DMA_CH_COUNT];
 const LDMA_TransferCfg_t xferCfg = LDMA_TRANSFER_CFG_PERIPHERAL(0);
 const LDMA_Descriptor_t m2p = LDMA_DESCRIPTOR_SINGLE_M2P_BYTE(NULL, NULL, 1UL);
 const LDMA_Descriptor_t p2m = LDMA_DESCRIPTOR_SINGLE_P2M_BYTE(NULL, NULL, 1UL);
+const LDMA_TransferCfg_t m2mCfg = LDMA_TRANSFER_CFG_MEMORY();
+const LDMA_Descriptor_t m2m = LDMA_DESCRIPTOR_SINGLE_M2M_BYTE(NULL, NULL, 1UL);
 
 typedef struct {
   LDMA_Descriptor_t desc[2];
 } DmaXfer_t;
 
 static DmaXfer_t dmaXfer[EMDRV_DMADRV_DMA_CH_COUNT];
+
+#if !defined(EMDRV_DMADRV_SG_DESC_COUNT)
+#define EMDRV_DMADRV_SG_DESC_COUNT 0
+#endif
+#if (EMDRV_DMADRV_SG_DESC_COUNT > 32)
+#error "EMDRV_DMADRV_SG_DESC_COUNT must not exceed 32"
+#endif
+#if (EMDRV_DMADRV_SG_DESC_COUNT > 0)
+#define SG_DESC_ALL ((uint32_t)(0xFFFFFFFFULL >> (32 - EMDRV_DMADRV_SG_DESC_COUNT)))
+
+/* Descriptor pool of scatter-gather transfers, a set bit in sgDescFree is a
+   free descriptor. */
+static LDMA_Descriptor_t sgDesc[EMDRV_DMADRV_SG_DESC_COUNT];
+static uint32_t sgDescFree = SG_DESC_ALL;
+#endif
 #endif
 
 #if !defined(EMDRV_DMADRV_USE_NATIVE_API)
@@ -108,6 +127,20 @@ static Ecode_t StartTransfer(DmaMode_t             mode,
                              void                  *cbUserParam);
 #endif
 
+#if defined(EMDRV_DMADRV_LDMA) && !defined(EMDRV_DMADRV_USE_NATIVE_API)
+static Ecode_t StartScatterGather(DmaDirection_t        direction,
+                                  unsigned int          channelId,
+                                  DMADRV_PeripheralSignal_t
+                                  peripheralSignal,
+                                  void                  *periph,
+                                  const DMADRV_Segment_t *segments,
+                                  int                   count,
+                                  DMADRV_DataSize_t     size,
+                                  DMADRV_Callback_t     callback,
+                                  void                  *cbUserParam);
+static void ReleaseDescriptors(ChTable_t *ch);
+#endif
+
 /// @endcond
 
 /***************************************************************************//**
@@ -226,6 +259,9 @@ Ecode_t DMADRV_FreeChannel(unsigned int channelId)
   CORE_ENTER_ATOMIC();
   if ( chTable[channelId].allocated ) {
     chTable[channelId].allocated = false;
+#if defined(EMDRV_DMADRV_LDMA) && !defined(EMDRV_DMADRV_USE_NATIVE_API)
+    ReleaseDescriptors(&chTable[channelId]);
+#endif
     CORE_EXIT_ATOMIC();
     return ECODE_EMDRV_DMADRV_OK;
   }
@@ -270,7 +306,14 @@ Ecode_t DMADRV_Init(void)
 
   for ( i = 0; i < (int)EMDRV_DMADRV_DMA_CH_COUNT; i++ ) {
     chTable[i].allocated = false;
+#if defined(EMDRV_DMADRV_LDMA) && !defined(EMDRV_DMADRV_USE_NATIVE_API)
+    chTable[i].sgDescMask = 0;
+#endif
   }
+#if defined(EMDRV_DMADRV_LDMA) && !defined(EMDRV_DMADRV_USE_NATIVE_API) \
+  && (EMDRV_DMADRV_SG_DESC_COUNT > 0)
+  sgDescFree = SG_DESC_ALL;
+#endif
 
 #if defined(EMDRV_DMADRV_UDMA)
   NVIC_SetPriority(DMA_IRQn, EMDRV_DMADRV_DMA_IRQ_PRIORITY);
@@ -611,6 +654,237 @@ Ecode_t DMADRV_PeripheralMemoryPingPong(
 }
 #endif /* !defined( EMDRV_DMADRV_USE_NATIVE_API ) */
 
+#if (defined(EMDRV_DMADRV_LDMA) && !defined(EMDRV_DMADRV_USE_NATIVE_API)) \
+  || defined(DOXY_DOC_ONLY)
+/***************************************************************************//**
+ * @brief
+ *  Start a memory to a peripheral DMA transfer gathering several buffers.
+ *
+ * @details
+ *  The buffers are chained with linked LDMA descriptors taken from a pool of
+ *  @ref EMDRV_DMADRV_SG_DESC_COUNT descriptors, so a frame made of separate
+ *  parts, a header, a payload and a checksum for example, goes out without
+ *  copying it together first. The callback is called once, when the last
+ *  buffer is transferred. The descriptors are returned to the pool on
+ *  completion or when the transfer is stopped.
+ *
+ *  This function is only available on LDMA.
+ *
+ * @param[in] channelId
+ *  The channel ID to use for the transfer.
+ *
+ * @param[in] peripheralSignal
+ *  Selects which peripheral/peripheralsignal to use.
+ *
+ * @param[in] dst
+ *  A destination (peripheral register) memory address.
+ *
+ * @param[in] src
+ *  An array of source buffers. Only the descriptors refer to the array, it
+ *  may be reused as soon as the function returns. The buffers must stay
+ *  valid until the transfer is complete.
+ *
+ * @param[in] count
+ *  A number of buffers in @a src.
+ *
+ * @param[in] size
+ *  An item size, byte, halfword or word.
+ *
+ * @param[in] callback
+ *  A function to call on DMA completion, use NULL if not needed.
+ *
+ * @param[in] cbUserParam
+ *  An optional user parameter to feed to the callback function. Use NULL if
+ *  not needed.
+ *
+ * @return
+ *   @ref ECODE_EMDRV_DMADRV_OK on success. @ref ECODE_EMDRV_DMADRV_IN_USE if
+ *   the channel still runs a scatter-gather transfer,
+ *   @ref ECODE_EMDRV_DMADRV_DESC_EXHAUSTED if the descriptor pool is too small
+ *   for the buffers. On other failures, an appropriate DMADRV @ref Ecode_t is
+ *   returned.
+ ******************************************************************************/
+Ecode_t DMADRV_MemoryPeripheralGather(unsigned int          channelId,
+                                      DMADRV_PeripheralSignal_t
+                                      peripheralSignal,
+                                      void                  *dst,
+                                      const DMADRV_Segment_t *src,
+                                      int                   count,
+                                      DMADRV_DataSize_t     size,
+                                      DMADRV_Callback_t     callback,
+                                      void                  *cbUserParam)
+{
+  return StartScatterGather(dmaDirectionMemToPeripheral,
+                            channelId,
+                            peripheralSignal,
+                            dst,
+                            src,
+                            count,
+                            size,
+                            callback,
+                            cbUserParam);
+}
+
+/***************************************************************************//**
+ * @brief
+ *  Start a memory to memory DMA transfer.
+ *
+ * @details
+ *  The transfer runs without a peripheral request, as fast as the LDMA
+ *  arbitration allows. With @a srcInc false the item at @a src is repeated,
+ *  which fills the destination like memset().
+ *
+ *  This function is only available on LDMA.
+ *
+ * @param[in] channelId
+ *  The channel ID to use for the transfer.
+ *
+ * @param[in] dst
+ *  A destination memory address.
+ *
+ * @param[in] src
+ *  A source memory address.
+ *
+ * @param[in] srcInc
+ *  Set to true to enable source address increment (increments according to
+ *  @a size parameter).
+ *
+ * @param[in] len
+ *  A number of items (of @a size size) to transfer.
+ *
+ * @param[in] size
+ *  An item size, byte, halfword or word.
+ *
+ * @param[in] callback
+ *  A function to call on DMA completion, use NULL if not needed.
+ *
+ * @param[in] cbUserParam
+ *  An optional user parameter to feed to the callback function. Use NULL if
+ *  not needed.
+ *
+ * @return
+ *   @ref ECODE_EMDRV_DMADRV_OK on success. On failure, an appropriate
+ *   DMADRV @ref Ecode_t is returned.
+ ******************************************************************************/
+Ecode_t DMADRV_MemoryMemory(unsigned int          channelId,
+                            void                  *dst,
+                            void                  *src,
+                            bool                  srcInc,
+                            int                   len,
+                            DMADRV_DataSize_t     size,
+                            DMADRV_Callback_t     callback,
+                            void                  *cbUserParam)
+{
+  ChTable_t *ch;
+  LDMA_TransferCfg_t xfer;
+  LDMA_Descriptor_t *desc;
+
+  if ( !initialized ) {
+    return ECODE_EMDRV_DMADRV_NOT_INITIALIZED;
+  }
+
+  if ( (channelId >= EMDRV_DMADRV_DMA_CH_COUNT)
+       || (dst == NULL)
+       || (src == NULL)
+       || (len <= 0)
+       || (len > DMADRV_MAX_XFER_COUNT) ) {
+    return ECODE_EMDRV_DMADRV_PARAM_ERROR;
+  }
+
+  ch = &chTable[channelId];
+  if ( ch->allocated == false ) {
+    return ECODE_EMDRV_DMADRV_CH_NOT_ALLOCATED;
+  }
+
+  xfer = m2mCfg;
+  desc = &dmaXfer[channelId].desc[0];
+  *desc = m2m;
+  if ( !srcInc ) {
+    desc->xfer.srcInc = ldmaCtrlSrcIncNone;
+  }
+  desc->xfer.xferCnt = len - 1;
+  desc->xfer.dstAddr = (uint32_t)(uint8_t *)dst;
+  desc->xfer.srcAddr = (uint32_t)(uint8_t *)src;
+  desc->xfer.size    = size;
+
+  /* Whether an interrupt is needed. */
+  if ( callback == NULL ) {
+    desc->xfer.doneIfs = 0;
+  }
+
+  ch->callback      = callback;
+  ch->userParam     = cbUserParam;
+  ch->callbackCount = 0;
+  ch->mode          = dmaModeBasic;
+  ReleaseDescriptors(ch);
+
+  LDMA_StartTransfer(channelId, &xfer, desc);
+
+  return ECODE_EMDRV_DMADRV_OK;
+}
+
+/***************************************************************************//**
+ * @brief
+ *  Start a peripheral to memory DMA transfer scattering into several buffers.
+ *
+ * @details
+ *  Counterpart of @ref DMADRV_MemoryPeripheralGather(), the received items
+ *  fill the buffers in order.
+ *
+ *  This function is only available on LDMA.
+ *
+ * @param[in] channelId
+ *  The channel ID to use for the transfer.
+ *
+ * @param[in] peripheralSignal
+ *  Selects which peripheral/peripheralsignal to use.
+ *
+ * @param[in] dst
+ *  An array of destination buffers. Only the descriptors refer to the array,
+ *  it may be reused as soon as the function returns.
+ *
+ * @param[in] src
+ *  A source (peripheral register) memory address.
+ *
+ * @param[in] count
+ *  A number of buffers in @a dst.
+ *
+ * @param[in] size
+ *  An item size, byte, halfword or word.
+ *
+ * @param[in] callback
+ *  A function to call on DMA completion, use NULL if not needed.
+ *
+ * @param[in] cbUserParam
+ *  An optional user parameter to feed to the callback function. Use NULL if
+ *  not needed.
+ *
+ * @return
+ *   @ref ECODE_EMDRV_DMADRV_OK on success. On failure, an appropriate
+ *   DMADRV @ref Ecode_t is returned, see @ref DMADRV_MemoryPeripheralGather().
+ ******************************************************************************/
+Ecode_t DMADRV_PeripheralMemoryScatter(unsigned int          channelId,
+                                       DMADRV_PeripheralSignal_t
+                                       peripheralSignal,
+                                       const DMADRV_Segment_t *dst,
+                                       void                  *src,
+                                       int                   count,
+                                       DMADRV_DataSize_t     size,
+                                       DMADRV_Callback_t     callback,
+                                       void                  *cbUserParam)
+{
+  return StartScatterGather(dmaDirectionPeripheralToMem,
+                            channelId,
+                            peripheralSignal,
+                            src,
+                            dst,
+                            count,
+                            size,
+                            callback,
+                            cbUserParam);
+}
+#endif
+
 /***************************************************************************//**
  * @brief
  *  Pause an ongoing DMA transfer.
@@ -708,6 +982,9 @@ Ecode_t DMADRV_StopTransfer(unsigned int channelId)
   DMA_ChannelEnable(channelId, false);
 #elif defined(EMDRV_DMADRV_LDMA)
   LDMA_StopTransfer(channelId);
+#if !defined(EMDRV_DMADRV_USE_NATIVE_API)
+  ReleaseDescriptors(&chTable[channelId]);
+#endif
 #endif
 
   return ECODE_EMDRV_DMADRV_OK;
@@ -963,6 +1240,12 @@ void LDMA_IRQHandler(void)
 #endif
 
       ch = &chTable[chnum];
+#if !defined(EMDRV_DMADRV_USE_NATIVE_API)
+      /* The chain is complete, the callback may start the next one. */
+      if ( ch->mode == dmaModeScatterGather ) {
+        ReleaseDescriptors(ch);
+      }
+#endif
       if ( ch->callback != NULL ) {
         ch->callbackCount++;
 #if defined(EMDRV_DMADRV_USE_NATIVE_API)
@@ -1246,11 +1529,171 @@ static Ecode_t StartTransfer(DmaMode_t             mode,
   ch->userParam     = cbUserParam;
   ch->callbackCount = 0;
   ch->mode          = mode;
+  ReleaseDescriptors(ch);
 
   LDMA_StartTransfer(channelId, &xfer, desc);
 
   return ECODE_EMDRV_DMADRV_OK;
 }
+
+/***************************************************************************//**
+ * @brief
+ *  Start an LDMA transfer over a chain of linked descriptors.
+ ******************************************************************************/
+static Ecode_t StartScatterGather(DmaDirection_t        direction,
+                                  unsigned int          channelId,
+                                  DMADRV_PeripheralSignal_t
+                                  peripheralSignal,
+                                  void                  *periph,
+                                  const DMADRV_Segment_t *segments,
+                                  int                   count,
+                                  DMADRV_DataSize_t     size,
+                                  DMADRV_Callback_t     callback,
+                                  void                  *cbUserParam)
+{
+#if (EMDRV_DMADRV_SG_DESC_COUNT > 0)
+  ChTable_t *ch;
+  LDMA_TransferCfg_t xfer;
+  LDMA_Descriptor_t *desc, *first, *prev;
+  uint32_t mask, avail;
+  int i, needed, offset, chunk, slot;
+  CORE_DECLARE_IRQ_STATE;
+
+  if ( !initialized ) {
+    return ECODE_EMDRV_DMADRV_NOT_INITIALIZED;
+  }
+
+  if ( (channelId >= EMDRV_DMADRV_DMA_CH_COUNT)
+       || (periph == NULL)
+       || (segments == NULL)
+       || (count <= 0) ) {
+    return ECODE_EMDRV_DMADRV_PARAM_ERROR;
+  }
+
+  ch = &chTable[channelId];
+  if ( ch->allocated == false ) {
+    return ECODE_EMDRV_DMADRV_CH_NOT_ALLOCATED;
+  }
+
+  /* One descriptor per DMADRV_MAX_XFER_COUNT items of each buffer. */
+  needed = 0;
+  for ( i = 0; i < count; i++ ) {
+    if ( (segments[i].len < 0)
+         || ((segments[i].len > 0) && (segments[i].buf == NULL)) ) {
+      return ECODE_EMDRV_DMADRV_PARAM_ERROR;
+    }
+    needed += (segments[i].len + DMADRV_MAX_XFER_COUNT - 1)
+              / DMADRV_MAX_XFER_COUNT;
+  }
+  if ( needed == 0 ) {
+    return ECODE_EMDRV_DMADRV_PARAM_ERROR;
+  }
+
+  /* Take the lowest free descriptors of the pool. */
+  CORE_ENTER_ATOMIC();
+  if ( ch->sgDescMask != 0 ) {
+    CORE_EXIT_ATOMIC();
+    return ECODE_EMDRV_DMADRV_IN_USE;
+  }
+  mask = 0;
+  avail = sgDescFree;
+  for ( i = 0; (i < needed) && (avail != 0); i++ ) {
+    mask |= avail & -avail;
+    avail &= avail - 1;
+  }
+  if ( i < needed ) {
+    CORE_EXIT_ATOMIC();
+    return ECODE_EMDRV_DMADRV_DESC_EXHAUSTED;
+  }
+  sgDescFree &= ~mask;
+  ch->sgDescMask = mask;
+  CORE_EXIT_ATOMIC();
+
+  xfer = xferCfg;
+  xfer.ldmaReqSel = peripheralSignal;
+  first = NULL;
+  prev = NULL;
+  slot = 0;
+
+  for ( i = 0; i < count; i++ ) {
+    for ( offset = 0; offset < segments[i].len; offset += chunk ) {
+      chunk = segments[i].len - offset;
+      if ( chunk > DMADRV_MAX_XFER_COUNT ) {
+        chunk = DMADRV_MAX_XFER_COUNT;
+      }
+      while ( (mask & (1UL << slot)) == 0 ) {
+        slot++;
+      }
+      desc = &sgDesc[slot++];
+
+      if ( direction == dmaDirectionMemToPeripheral ) {
+        *desc = m2p;
+        desc->xfer.srcAddr = (uint32_t)((uint8_t *)segments[i].buf
+                                        + (offset << size));
+        desc->xfer.dstAddr = (uint32_t)(uint8_t *)periph;
+      } else {
+        *desc = p2m;
+        desc->xfer.srcAddr = (uint32_t)(uint8_t *)periph;
+        desc->xfer.dstAddr = (uint32_t)((uint8_t *)segments[i].buf
+                                        + (offset << size));
+      }
+      desc->xfer.xferCnt = chunk - 1;
+      desc->xfer.size    = size;
+      /* Only the last descriptor raises the completion interrupt. */
+      desc->xfer.doneIfs = 0;
+
+      if ( prev == NULL ) {
+        first = desc;
+      } else {
+        prev->xfer.linkMode = ldmaLinkModeAbs;
+        prev->xfer.linkAddr = (uint32_t)desc >> 2;
+        prev->xfer.link     = 1;
+      }
+      prev = desc;
+    }
+  }
+  /* The interrupt also returns the descriptors to the pool. */
+  prev->xfer.doneIfs = 1;
+
+  ch->callback      = callback;
+  ch->userParam     = cbUserParam;
+  ch->callbackCount = 0;
+  ch->mode          = dmaModeScatterGather;
+
+  LDMA_StartTransfer(channelId, &xfer, first);
+
+  return ECODE_EMDRV_DMADRV_OK;
+#else
+  (void)direction;
+  (void)channelId;
+  (void)peripheralSignal;
+  (void)periph;
+  (void)segments;
+  (void)count;
+  (void)size;
+  (void)callback;
+  (void)cbUserParam;
+  return ECODE_EMDRV_DMADRV_DESC_EXHAUSTED;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief
+ *  Return the scatter-gather descriptors of a channel to the pool.
+ ******************************************************************************/
+static void ReleaseDescriptors(ChTable_t *ch)
+{
+#if (EMDRV_DMADRV_SG_DESC_COUNT > 0)
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  sgDescFree |= ch->sgDescMask;
+  ch->sgDescMask = 0;
+  CORE_EXIT_ATOMIC();
+#else
+  (void)ch;
+#endif
+}
 #endif /* defined( EMDRV_DMADRV_LDMA ) && !defined( EMDRV_DMADRV_USE_NATIVE_API ) */
 
 /// @endcond
@@ -1294,6 +1737,7 @@ static Ecode_t StartTransfer(DmaMode_t             mode,
    Currently the configuration options are as follows:
    @li The interrupt priority of the DMA peripheral.
    @li A number of DMA channels to support.
+   @li A number of LDMA descriptors for scatter-gather transfers.
    @li Use the native emlib API belonging to the underlying DMA hardware in
       combination with the DMADRV API.
 
@@ -1354,6 +1798,18 @@ static Ecode_t StartTransfer(DmaMode_t             mode,
    @ref DMADRV_PeripheralMemoryPingPong() @n
     Start a DMA ping-pong transfer from a peripheral to memory.
 
+   @ref DMADRV_MemoryMemory() @n
+    Start a DMA transfer from memory to memory. This function can only be used
+    on LDMA.
+
+   @ref DMADRV_MemoryPeripheralGather() @n
+    Start a DMA transfer from several memory buffers to a peripheral, with a
+    single completion callback. This function can only be used on LDMA.
+
+   @ref DMADRV_PeripheralMemoryScatter() @n
+    Start a DMA transfer from a peripheral to several memory buffers, with a
+    single completion callback. This function can only be used on LDMA.
+
    @ref DMADRV_LdmaStartTransfer() @n
     Start a DMA transfer on an LDMA controller. This function can only be used
     when configuration option @ref EMDRV_DMADRV_USE_NATIVE_API is defined.
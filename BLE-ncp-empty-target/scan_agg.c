@@ -0,0 +1,369 @@
+/***************************************************************************//**
+ * @file
+ * @brief Silabs Network Co-Processor (NCP) scan report aggregation
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "em_rtcc.h"
+#include "user_command.h"
+#include "scan_agg.h"
+
+// The RTCC counts at 32768 Hz, see initMcu()
+#define TICK_HZ          32768
+
+#define TABLE_MASK       (SCAN_AGG_TABLE_SIZE - 1)
+// Devices tracked at most, the free slots left end every probe
+#define TABLE_LOAD       (SCAN_AGG_TABLE_SIZE * 3 / 4)
+
+// Entry flags
+#define ENTRY_USED       0x01
+// A report arrived during the current window
+#define ENTRY_SEEN       0x02
+// Payload hash known, per payload kind
+#define ENTRY_HASH_ADV   0x04
+#define ENTRY_HASH_RSP   0x08
+// Idle for a whole window, deleted once the window is closed
+#define ENTRY_DELETE     0x10
+
+// Legacy PDU type of a scan response in packet_type
+#define PACKET_TYPE_MASK 0x07
+#define PACKET_SCAN_RSP  0x04
+
+#define FNV_OFFSET       2166136261UL
+#define FNV_PRIME        16777619UL
+
+#define SUMMARY_MAX_LEN  (1 + SCAN_AGG_RECORDS_PER_EVT * SCAN_AGG_RECORD_LEN)
+
+// A device, with the reports folded in since its last summary record
+typedef struct {
+  bd_addr address;
+  uint8_t address_type;
+  uint8_t flags;
+  int8_t rssi_min;
+  int8_t rssi_max;
+  uint16_t count;
+  int32_t rssi_sum;
+  // Advertising data and scan response data are hashed apart, a device
+  // answering scans alternates between them
+  uint32_t payload_hash[2];
+} scan_agg_entry_t;
+
+typedef struct {
+  // Window length in RTCC ticks, 0 when aggregation is off
+  uint32_t window;
+  uint32_t window_start;
+  uint8_t used;
+  scan_agg_stats_t stats;
+  scan_agg_entry_t table[SCAN_AGG_TABLE_SIZE];
+} scan_agg_channel_t;
+
+static scan_agg_channel_t channels[NCP_CHANNEL_COUNT];
+
+// Summary being filled, shared by the channels: every caller of
+// summary_add() flushes it before returning. The packet type leaves no room
+// for the array at its end.
+static union {
+  struct gecko_cmd_packet packet;
+  uint8_t buf[BGLIB_MSG_HEADER_LEN + 1 + SUMMARY_MAX_LEN];
+} summary;
+
+static void scan_agg_close(uint8_t channel);
+static scan_agg_entry_t *scan_agg_lookup(scan_agg_channel_t *agg, bd_addr *address,
+                                         uint8_t address_type);
+static uint8_t scan_agg_home(const scan_agg_entry_t *entry);
+static void scan_agg_delete(scan_agg_channel_t *agg, uint8_t slot);
+static void summary_add(uint8_t channel, scan_agg_entry_t *entry);
+static void summary_flush(uint8_t channel);
+static uint32_t fnv1a(uint32_t hash, const uint8_t *data, uint16_t len);
+
+void scan_agg_set(uint8_t channel, uint16_t window_ms)
+{
+  scan_agg_channel_t *agg = &channels[channel];
+
+  if (agg->window != 0) {
+    scan_agg_close(channel);
+  }
+  if (window_ms == 0) {
+    memset(agg, 0, sizeof(*agg));
+    return;
+  }
+  memset(&agg->stats, 0, sizeof(agg->stats));
+  agg->window = (uint32_t)window_ms * TICK_HZ / 1000;
+  agg->window_start = RTCC_CounterGet();
+}
+
+bool scan_agg_report(uint8_t channel, struct gecko_cmd_packet *evt)
+{
+  scan_agg_channel_t *agg = &channels[channel];
+  scan_agg_entry_t *entry;
+  bd_addr *address;
+  uint8_t address_type;
+  uint8_t packet_type;
+  int8_t rssi;
+  uint8array *data;
+  uint8_t kind;
+  uint32_t hash;
+
+  if (agg->window == 0) {
+    return false;
+  }
+  switch (BGLIB_MSG_ID(evt->header)) {
+    case gecko_evt_le_gap_scan_response_id:
+      address = &evt->data.evt_le_gap_scan_response.address;
+      address_type = evt->data.evt_le_gap_scan_response.address_type;
+      packet_type = evt->data.evt_le_gap_scan_response.packet_type;
+      rssi = evt->data.evt_le_gap_scan_response.rssi;
+      data = &evt->data.evt_le_gap_scan_response.data;
+      break;
+    case gecko_evt_le_gap_extended_scan_response_id:
+      address = &evt->data.evt_le_gap_extended_scan_response.address;
+      address_type = evt->data.evt_le_gap_extended_scan_response.address_type;
+      packet_type = evt->data.evt_le_gap_extended_scan_response.packet_type;
+      rssi = evt->data.evt_le_gap_extended_scan_response.rssi;
+      data = &evt->data.evt_le_gap_extended_scan_response.data;
+      break;
+    default:
+      return false;
+  }
+  agg->stats.reports++;
+
+  entry = scan_agg_lookup(agg, address, address_type);
+  if (entry == NULL) {
+    agg->stats.overflows++;
+    return false;
+  }
+  entry->flags |= ENTRY_SEEN;
+  kind = ((packet_type & PACKET_TYPE_MASK) == PACKET_SCAN_RSP) ? 1 : 0;
+  hash = fnv1a(FNV_OFFSET, data->data, data->len);
+  if (!(entry->flags & (ENTRY_HASH_ADV << kind)) || entry->payload_hash[kind] != hash) {
+    // a new device or new data, the host gets the report itself after the
+    // summary of what came before
+    entry->flags |= (ENTRY_HASH_ADV << kind);
+    entry->payload_hash[kind] = hash;
+    if (entry->count > 0) {
+      summary_add(channel, entry);
+      summary_flush(channel);
+    }
+    return false;
+  }
+  if (entry->count == UINT16_MAX) {
+    summary_add(channel, entry);
+    summary_flush(channel);
+  }
+  if (entry->count == 0 || rssi < entry->rssi_min) {
+    entry->rssi_min = rssi;
+  }
+  if (entry->count == 0 || rssi > entry->rssi_max) {
+    entry->rssi_max = rssi;
+  }
+  entry->rssi_sum += rssi;
+  entry->count++;
+  agg->stats.aggregated++;
+  return true;
+}
+
+void scan_agg_poll(void)
+{
+  uint32_t now = RTCC_CounterGet();
+
+  for (uint8_t channel = 0; channel < NCP_CHANNEL_COUNT; channel++) {
+    scan_agg_channel_t *agg = &channels[channel];
+    if (agg->window != 0 && now - agg->window_start >= agg->window) {
+      scan_agg_close(channel);
+      agg->window_start = now;
+    }
+  }
+}
+
+uint32_t scan_agg_sleep_ms(void)
+{
+  uint32_t now = RTCC_CounterGet();
+  uint32_t sleep_ms = UINT32_MAX;
+
+  for (uint8_t channel = 0; channel < NCP_CHANNEL_COUNT; channel++) {
+    scan_agg_channel_t *agg = &channels[channel];
+    uint32_t elapsed = now - agg->window_start;
+    uint32_t ms;
+    if (agg->window == 0) {
+      continue;
+    }
+    // rounded up, waking before the end would only spin
+    ms = (elapsed >= agg->window) ? 0
+         : ((agg->window - elapsed) * 1000 + TICK_HZ - 1) / TICK_HZ;
+    if (ms < sleep_ms) {
+      sleep_ms = ms;
+    }
+  }
+  return sleep_ms;
+}
+
+void scan_agg_read(uint8_t channel, scan_agg_stats_t *stats)
+{
+  *stats = channels[channel].stats;
+}
+
+/**
+ * Queue the summary records of the window and forget the devices idle
+ * during all of it
+ */
+static void scan_agg_close(uint8_t channel)
+{
+  scan_agg_channel_t *agg = &channels[channel];
+  scan_agg_entry_t *entry;
+  uint16_t slot;
+
+  for (slot = 0; slot < SCAN_AGG_TABLE_SIZE; slot++) {
+    entry = &agg->table[slot];
+    if (!(entry->flags & ENTRY_USED)) {
+      continue;
+    }
+    if (entry->count > 0) {
+      summary_add(channel, entry);
+    }
+    if (!(entry->flags & ENTRY_SEEN)) {
+      entry->flags |= ENTRY_DELETE;
+    }
+    entry->flags &= ~ENTRY_SEEN;
+  }
+  summary_flush(channel);
+  // deleting shifts entries back into the freed slot, check it again
+  for (slot = 0; slot < SCAN_AGG_TABLE_SIZE; slot++) {
+    while (agg->table[slot].flags & ENTRY_DELETE) {
+      scan_agg_delete(agg, slot);
+    }
+  }
+}
+
+/**
+ * Find the entry of a device by linear probing, or insert it if there is
+ * room. NULL if the table is full.
+ */
+static scan_agg_entry_t *scan_agg_lookup(scan_agg_channel_t *agg, bd_addr *address,
+                                         uint8_t address_type)
+{
+  scan_agg_entry_t *entry;
+  uint8_t slot;
+
+  slot = fnv1a(fnv1a(FNV_OFFSET, &address_type, 1), address->addr, sizeof(address->addr))
+         & TABLE_MASK;
+  for (;; slot = (slot + 1) & TABLE_MASK) {
+    entry = &agg->table[slot];
+    if (!(entry->flags & ENTRY_USED)) {
+      break;
+    }
+    if (entry->address_type == address_type
+        && memcmp(entry->address.addr, address->addr, sizeof(address->addr)) == 0) {
+      return entry;
+    }
+  }
+  if (agg->used >= TABLE_LOAD) {
+    return NULL;
+  }
+  memset(entry, 0, sizeof(*entry));
+  entry->address = *address;
+  entry->address_type = address_type;
+  entry->flags = ENTRY_USED;
+  agg->used++;
+  return entry;
+}
+
+/**
+ * Slot an entry is looked up from first
+ */
+static uint8_t scan_agg_home(const scan_agg_entry_t *entry)
+{
+  return fnv1a(fnv1a(FNV_OFFSET, &entry->address_type, 1), entry->address.addr,
+               sizeof(entry->address.addr)) & TABLE_MASK;
+}
+
+/**
+ * Free a slot, moving back the entries which probed past it so every entry
+ * stays reachable from its home slot
+ */
+static void scan_agg_delete(scan_agg_channel_t *agg, uint8_t slot)
+{
+  uint8_t next = slot;
+  uint8_t home;
+
+  for (;; ) {
+    next = (next + 1) & TABLE_MASK;
+    if (!(agg->table[next].flags & ENTRY_USED)) {
+      break;
+    }
+    home = scan_agg_home(&agg->table[next]);
+    // an entry whose home lies cyclically in (slot, next] stays
+    if ((slot <= next) ? (slot < home && home <= next) : (slot < home || home <= next)) {
+      continue;
+    }
+    agg->table[slot] = agg->table[next];
+    slot = next;
+  }
+  agg->table[slot].flags = 0;
+  agg->used--;
+}
+
+/**
+ * Append the record of a device to the summary and restart its statistics
+ */
+static void summary_add(uint8_t channel, scan_agg_entry_t *entry)
+{
+  uint8array *data = &summary.packet.data.evt_user_message_to_host.data;
+  uint8_t *p;
+
+  if (data->len + SCAN_AGG_RECORD_LEN > SUMMARY_MAX_LEN) {
+    summary_flush(channel);
+  }
+  if (data->len == 0) {
+    data->data[data->len++] = USER_EVT_SCAN_SUMMARY;
+  }
+  p = &data->data[data->len];
+  memcpy(p, entry->address.addr, sizeof(entry->address.addr));
+  p += sizeof(entry->address.addr);
+  *p++ = entry->address_type;
+  *p++ = (uint8_t)entry->rssi_min;
+  *p++ = (uint8_t)entry->rssi_max;
+  *p++ = (uint8_t)(int8_t)(entry->rssi_sum / (int32_t)entry->count);
+  *p++ = (uint8_t)entry->count;
+  *p++ = (uint8_t)(entry->count >> 8);
+  data->len += SCAN_AGG_RECORD_LEN;
+  entry->count = 0;
+  entry->rssi_sum = 0;
+}
+
+/**
+ * Queue the summary as a user_message_to_host event, if it holds a record
+ */
+static void summary_flush(uint8_t channel)
+{
+  uint8array *data = &summary.packet.data.evt_user_message_to_host.data;
+  uint16_t len = 1 + data->len;
+
+  if (data->len == 0) {
+    return;
+  }
+  summary.packet.header = gecko_evt_user_message_to_host_id
+                          | ((len & 0xff) << 8) | ((len >> 8) & 0x07);
+  if (ncp_channel_transmit_enqueue(channel, &summary.packet)) {
+    channels[channel].stats.summaries++;
+  }
+  data->len = 0;
+}
+
+static uint32_t fnv1a(uint32_t hash, const uint8_t *data, uint16_t len)
+{
+  for (uint16_t i = 0; i < len; i++) {
+    hash = (hash ^ data[i]) * FNV_PRIME;
+  }
+  return hash;
+}
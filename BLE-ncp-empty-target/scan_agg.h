@@ -0,0 +1,142 @@
+/***************************************************************************//**
+ * @file
+ * @brief Silabs Network Co-Processor (NCP) scan report aggregation
+ * This library folds the scan reports of each device into a summary sent
+ * once per window, so a dense environment costs the host one record per
+ * device per window instead of one event per advertisement. The first
+ * report of a device and every report whose payload changed are still
+ * forwarded, so the host sees every device and every payload.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef SCAN_AGG_H_
+#define SCAN_AGG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ncp.h"
+
+// Slots of the device table of each channel, a power of two. Up to three
+// quarters of them track devices, reports of further devices are forwarded.
+#ifndef SCAN_AGG_TABLE_SIZE
+#define SCAN_AGG_TABLE_SIZE          64
+#endif
+
+// Summary records per event
+#ifndef SCAN_AGG_RECORDS_PER_EVT
+#define SCAN_AGG_RECORDS_PER_EVT     8
+#endif
+
+#if (SCAN_AGG_TABLE_SIZE & (SCAN_AGG_TABLE_SIZE - 1)) != 0 || SCAN_AGG_TABLE_SIZE > 256
+#error "SCAN_AGG_TABLE_SIZE must be a power of two up to 256"
+#endif
+
+/*
+ * Summary, a user_message_to_host event:
+ *   uint8  USER_EVT_SCAN_SUMMARY
+ *   record[] of SCAN_AGG_RECORD_LEN bytes:
+ *     uint8  address[6], least significant byte first as in bd_addr
+ *     uint8  address type
+ *     int8   lowest RSSI
+ *     int8   highest RSSI
+ *     int8   mean RSSI
+ *     uint16 reports folded in, saturating, little endian
+ * A record covers the reports of a device not forwarded since its last
+ * record: those of the window, or those before its payload changed.
+ */
+#define SCAN_AGG_RECORD_LEN          12
+
+typedef struct {
+  // Scan reports seen
+  uint32_t reports;
+  // Reports folded into summaries
+  uint32_t aggregated;
+  // Summary events queued
+  uint32_t summaries;
+  // Reports forwarded because the table was full
+  uint32_t overflows;
+} scan_agg_stats_t;
+
+/***************************************************************************//**
+ * @brief
+ *   Set the aggregation window of a channel.
+ *
+ * @details
+ *   Changing the window closes the current one. Devices which sent no report
+ *   during a whole window are forgotten, their next report is forwarded.
+ *
+ * @param[in] channel
+ *   NCP channel of the host.
+ *
+ * @param[in] window_ms
+ *   Window in ms, 0 to forward every report again.
+ *
+ ******************************************************************************/
+void scan_agg_set(uint8_t channel, uint16_t window_ms);
+
+/***************************************************************************//**
+ * @brief
+ *   Offer an event to the aggregation of a channel.
+ *
+ * @details
+ *   Call for the events which passed the event filter of the channel.
+ *
+ * @param[in] channel
+ *   NCP channel of the host.
+ *
+ * @param[in] evt
+ *   Pointer to the event received from the Bluetooth stack.
+ *
+ * @return
+ *   True if the event was a scan report folded into a summary, False if it
+ *   must be forwarded.
+ *
+ ******************************************************************************/
+bool scan_agg_report(uint8_t channel, struct gecko_cmd_packet *evt);
+
+/***************************************************************************//**
+ * @brief
+ *   Close the windows which ended and queue their summaries.
+ *
+ * @details
+ *   Call from the main loop.
+ *
+ ******************************************************************************/
+void scan_agg_poll(void);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the time until the next window ends.
+ *
+ * @return
+ *   Time in ms, the device must wake up by then, UINT32_MAX if no window is
+ *   open.
+ *
+ ******************************************************************************/
+uint32_t scan_agg_sleep_ms(void);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the aggregation counters of a channel.
+ *
+ * @param[in] channel
+ *   NCP channel of the host.
+ *
+ * @param[out] stats
+ *   Counters since the window was last set.
+ *
+ ******************************************************************************/
+void scan_agg_read(uint8_t channel, scan_agg_stats_t *stats);
+
+#endif /* SCAN_AGG_H_ */
@@ -0,0 +1,47 @@
+/***************************************************************************//**
+ * @file
+ * @brief Main stack high-water monitor
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "stack_monitor.h"
+
+// Provided by the linker script
+extern uint32_t __StackLimit;
+extern uint32_t __StackTop;
+
+void stack_monitor_init(void)
+{
+  volatile uint32_t *p = &__StackLimit;
+  // The loop keeps its state in registers, so the words below the current
+  // stack pointer are free
+  volatile uint32_t *sp = (volatile uint32_t *)__get_MSP();
+
+  while (p < sp) {
+    *p++ = STACK_MONITOR_PATTERN;
+  }
+}
+
+void stack_monitor_read(stack_monitor_stats_t *stats)
+{
+  const volatile uint32_t *p = &__StackLimit;
+  const volatile uint32_t *top = &__StackTop;
+
+  while (p < top && *p == STACK_MONITOR_PATTERN) {
+    p++;
+  }
+  stats->size = (uint32_t)top - (uint32_t)&__StackLimit;
+  stats->peak = (uint32_t)top - (uint32_t)p;
+}
@@ -0,0 +1,64 @@
+/***************************************************************************//**
+ * @file
+ * @brief Main stack high-water monitor
+ * Paints the unused part of the main stack with a known pattern at startup
+ * and finds the deepest word overwritten since, which is the peak stack use
+ * of the application, the Bluetooth stack and the interrupt handlers.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef STACK_MONITOR_H_
+#define STACK_MONITOR_H_
+
+#include <stdint.h>
+
+// Pattern written to the free stack, differs from the heap monitor pattern
+// so a dump tells the two apart
+#define STACK_MONITOR_PATTERN        0xc33c5aa5UL
+
+typedef struct {
+  // Size of the stack section reserved by the linker script
+  uint32_t size;
+  // Deepest stack use since stack_monitor_init()
+  uint32_t peak;
+} stack_monitor_stats_t;
+
+/***************************************************************************//**
+ * @brief
+ *   Fill the free part of the main stack with the pattern.
+ *
+ * @details
+ *   Call it first thing in main() so the figures include the initialization
+ *   code. Everything below the current stack pointer is painted.
+ *
+ ******************************************************************************/
+void stack_monitor_init(void);
+
+/***************************************************************************//**
+ * @brief
+ *   Measure the peak stack use.
+ *
+ * @details
+ *   Scans from the stack limit up to the first overwritten word. A peak equal
+ *   to the size means the stack has been exhausted, on this part the stack
+ *   sits at the start of RAM so an overflow ends in a fault rather than in
+ *   corrupted data.
+ *
+ * @param[out] stats
+ *   Stack use since stack_monitor_init().
+ *
+ ******************************************************************************/
+void stack_monitor_read(stack_monitor_stats_t *stats);
+
+#endif /* STACK_MONITOR_H_ */
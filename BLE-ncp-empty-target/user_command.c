@@ -16,14 +16,189 @@
  *
  ******************************************************************************/
 
+#include <string.h>
 #include "ncp_gecko.h"
+#include "infrastructure.h"
+#include "ncp_evt_filter.h"
+#include "scan_agg.h"
+#include "heap_monitor.h"
+#include "stack_monitor.h"
+#if defined(NCP_SPI_ENABLED)
+#include "ncp_spi.h"
+#else
+#include "ncp_usart.h"
+#endif
+#include "user_command.h"
+
+static void send_user_response(uint16_t result, uint8_t cmd, uint8_t len, const uint8_t* data);
 
 /**
- * Default implementation to user command handling.
+ * User command handling, dispatched on the command code in the first
+ * payload byte (see user_command.h).
  *
- * @param payload the data payload
+ * @param data the uint8array payload, length byte first
+ */
+void handle_user_command(uint8_t* data)
+{
+  uint8_t len = data[0];
+  uint8_t *params = &data[2];
+  uint8_t buf[16];
+  // Each host has its own event filter
+  uint8_t channel = ncp_command_channel();
+
+  if (len == 0) {
+    gecko_send_rsp_user_message_to_target(bg_err_invalid_param, 0, NULL);
+    return;
+  }
+  // Length of parameters after the command code
+  len--;
+
+  switch (data[1]) {
+    case USER_CMD_EVT_FILTER_RESET:
+      ncp_evt_filter_reset(channel);
+      scan_agg_set(channel, 0);
+      send_user_response(bg_err_success, data[1], 0, NULL);
+      break;
+
+    case USER_CMD_EVT_FILTER_SET:
+      if (len < 3 || !ncp_evt_filter_set(channel, params[0], params[1], params[2] != 0)) {
+        send_user_response(bg_err_invalid_param, data[1], 0, NULL);
+        break;
+      }
+      send_user_response(bg_err_success, data[1], 0, NULL);
+      break;
+
+    case USER_CMD_EVT_FILTER_SCAN:
+      if (len < 2 || len < 2 + params[1]
+          || !ncp_evt_filter_set_scan(channel, (int8_t)params[0], params[1], &params[2])) {
+        send_user_response(bg_err_invalid_param, data[1], 0, NULL);
+        break;
+      }
+      send_user_response(bg_err_success, data[1], 0, NULL);
+      break;
+
+    case USER_CMD_EVT_FILTER_STATS:
+    {
+      uint8_t *p = buf;
+      UINT32_TO_BITSTREAM(p, ncp_evt_filter_dropped(channel));
+      send_user_response(bg_err_success, data[1], 4, buf);
+      break;
+    }
+
+    case USER_CMD_SCAN_AGG_SET:
+      if (len < 2) {
+        send_user_response(bg_err_invalid_param, data[1], 0, NULL);
+        break;
+      }
+      scan_agg_set(channel, BYTES_TO_UINT16(params[0], params[1]));
+      send_user_response(bg_err_success, data[1], 0, NULL);
+      break;
+
+    case USER_CMD_SCAN_AGG_STATS:
+    {
+      uint8_t *p = buf;
+      scan_agg_stats_t stats;
+      scan_agg_read(channel, &stats);
+      UINT32_TO_BITSTREAM(p, stats.reports);
+      UINT32_TO_BITSTREAM(p, stats.aggregated);
+      UINT32_TO_BITSTREAM(p, stats.summaries);
+      UINT32_TO_BITSTREAM(p, stats.overflows);
+      send_user_response(bg_err_success, data[1], 16, buf);
+      break;
+    }
+
+#if !defined(NCP_SPI_ENABLED)
+    case USER_CMD_UART_BAUD_SET:
+    {
+      uint8_t *p = buf;
+      uint32_t actual = 0;
+      // Only the primary channel supports a baud rate switch
+      if (channel == 0 && len >= 4) {
+        actual = ncp_usart_baudrate_request(BYTES_TO_UINT32(params[0], params[1],
+                                                            params[2], params[3]));
+      }
+      if (actual == 0) {
+        send_user_response(bg_err_invalid_param, data[1], 0, NULL);
+        break;
+      }
+      UINT32_TO_BITSTREAM(p, actual);
+      send_user_response(bg_err_success, data[1], 4, buf);
+      break;
+    }
+
+    case USER_CMD_UART_BAUD_CONFIRM:
+      if (channel != 0 || !ncp_usart_baudrate_confirm(params, len)) {
+        send_user_response(bg_err_wrong_state, data[1], 0, NULL);
+        break;
+      }
+      // echo the pattern so the host can check the other direction
+      send_user_response(bg_err_success, data[1], len, params);
+      break;
+
+    case USER_CMD_UART_STATUS:
+    {
+      uint8_t *p = buf;
+      UINT32_TO_BITSTREAM(p, ncp_usart_baudrate_get());
+      UINT32_TO_BITSTREAM(p, ncp_usart_link_errors());
+      UINT32_TO_BITSTREAM(p, ncp_usart_frame_errors());
+      send_user_response(bg_err_success, data[1], 12, buf);
+      break;
+    }
+#else
+    case USER_CMD_SPI_STATUS:
+    {
+      uint8_t *p = buf;
+      UINT32_TO_BITSTREAM(p, ncp_spi_transfers());
+      UINT32_TO_BITSTREAM(p, ncp_spi_rx_errors());
+      UINT32_TO_BITSTREAM(p, ncp_spi_tx_aborts());
+      send_user_response(bg_err_success, data[1], 12, buf);
+      break;
+    }
+#endif
+
+    case USER_CMD_HEAP_STATUS:
+    {
+      uint8_t *p = buf;
+      heap_monitor_stats_t stats;
+      heap_monitor_read(&stats);
+      UINT32_TO_BITSTREAM(p, stats.size);
+      UINT32_TO_BITSTREAM(p, stats.used);
+      UINT32_TO_BITSTREAM(p, stats.high_water);
+      UINT32_TO_BITSTREAM(p, stats.recommended);
+      send_user_response(bg_err_success, data[1], 16, buf);
+      break;
+    }
+
+    case USER_CMD_STACK_STATUS:
+    {
+      uint8_t *p = buf;
+      stack_monitor_stats_t stats;
+      stack_monitor_read(&stats);
+      UINT32_TO_BITSTREAM(p, stats.size);
+      UINT32_TO_BITSTREAM(p, stats.peak);
+      send_user_response(bg_err_success, data[1], 8, buf);
+      break;
+    }
+
+    default:
+      send_user_response(bg_err_not_implemented, data[1], 0, NULL);
+      break;
+  }
+}
+
+/**
+ * Send the response of a user command, prefixed with the command code.
  */
-void handle_user_command(const uint8_t* data)
+static void send_user_response(uint16_t result, uint8_t cmd, uint8_t len, const uint8_t* data)
 {
-  gecko_send_rsp_user_message_to_target(bg_err_not_implemented, 0, NULL);
+  uint8_t rsp[1 + 32];
+
+  rsp[0] = cmd;
+  if (len > sizeof(rsp) - 1) {
+    len = sizeof(rsp) - 1;
+  }
+  if (len > 0) {
+    memcpy(&rsp[1], data, len);
+  }
+  gecko_send_rsp_user_message_to_target(result, 1 + len, rsp);
 }
@@ -0,0 +1,82 @@
+/***************************************************************************//**
+ * @file
+ * @brief Silabs Network Co-Processor (NCP) user commands
+ * Commands carried in the payload of gecko_cmd_user_message_to_target. The
+ * first payload byte is the command code, parameters follow in little endian.
+ * The response payload starts with the same command code.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef USER_COMMAND_H_
+#define USER_COMMAND_H_
+
+// With several NCP channels the event filter commands apply to the channel
+// the command came from. The UART commands apply to the primary channel.
+
+// Forward every event again
+// params: none
+#define USER_CMD_EVT_FILTER_RESET      0x01
+// Subscribe to or unsubscribe from an event
+// params: uint8 class, uint8 index (0xff for whole class), uint8 forward
+#define USER_CMD_EVT_FILTER_SET        0x02
+// Set scan report predicates
+// params: int8 rssi_min, uint8 prefix_len, uint8 prefix[prefix_len] (MSB first)
+#define USER_CMD_EVT_FILTER_SCAN       0x03
+// Get the number of events dropped by the filter
+// params: none, returns: uint32 dropped
+#define USER_CMD_EVT_FILTER_STATS      0x04
+// Fold the scan reports passing the filter into per device summaries sent
+// every window (see scan_agg.h), USER_CMD_EVT_FILTER_RESET turns it off
+// params: uint16 window_ms, 0 to forward every report again
+#define USER_CMD_SCAN_AGG_SET          0x05
+// Get the scan aggregation counters
+// params: none, returns: uint32 reports, uint32 aggregated,
+//                        uint32 summaries, uint32 overflows
+#define USER_CMD_SCAN_AGG_STATS        0x06
+
+// Switch the NCP UART to another baud rate. The response is sent at the
+// current baud rate, the target switches once it is out. Events are held
+// back meanwhile and follow at the new baud rate. Only accepted on the
+// primary channel.
+// params: uint32 baudrate, returns: uint32 actual baudrate
+#define USER_CMD_UART_BAUD_SET         0x10
+// Confirm the new baud rate within NCP_USART_BAUD_PROBE_MS, otherwise both
+// sides fall back to the previous one
+// params: uint8 pattern[NCP_USART_BAUD_PATTERN_LEN], returns: the same pattern
+#define USER_CMD_UART_BAUD_CONFIRM     0x11
+// Get the UART link status
+// params: none, returns: uint32 baudrate, uint32 framing/parity errors,
+//                        uint32 CRC errors
+#define USER_CMD_UART_STATUS           0x12
+// Get the SPI link status
+// params: none, returns: uint32 transfers, uint32 receive errors,
+//                        uint32 aborted transfers
+#define USER_CMD_SPI_STATUS            0x13
+
+// Get the Bluetooth stack heap usage (see heap_monitor.h)
+// params: none, returns: uint32 heap size, uint32 bytes used,
+//                        uint32 high-water mark, uint32 recommended size
+#define USER_CMD_HEAP_STATUS           0x20
+// Get the peak main stack use (see stack_monitor.h)
+// params: none, returns: uint32 stack size, uint32 peak use
+#define USER_CMD_STACK_STATUS          0x21
+
+// Events sent by the target in user_message_to_host, dispatched on the
+// event code in the first payload byte
+
+// Scan report summaries of a window (see scan_agg.h)
+// params: record[] of SCAN_AGG_RECORD_LEN bytes
+#define USER_EVT_SCAN_SUMMARY          0x80
+
+#endif /* USER_COMMAND_H_ */
@@ -0,0 +1,70 @@
+/***************************************************************************//**
+ * @file
+ * @brief Advertising payload templates
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "native_gecko.h"
+#include "adv_payload.h"
+
+bool adv_payload_init(adv_payload_t *payload, uint8_t packet, const uint8_t *template, uint8_t len)
+{
+  uint32_t pos = 0;
+
+  if (len > ADV_PAYLOAD_MAX_LEN) {
+    return false;
+  }
+  // every AD structure must end inside the template
+  while (pos < len) {
+    pos += 1 + template[pos];
+  }
+  if (pos != len) {
+    return false;
+  }
+  memcpy(payload->data, template, len);
+  payload->len = len;
+  payload->packet = packet;
+  payload->changed = true;
+  return true;
+}
+
+uint8_t adv_payload_field(const adv_payload_t *payload, uint8_t type, uint8_t offset)
+{
+  uint8_t pos = 0;
+
+  while (pos < payload->len) {
+    uint8_t ad_len = payload->data[pos];
+
+    // the data follows the length and type bytes
+    if (ad_len > 0 && payload->data[pos + 1] == type) {
+      return (offset < ad_len - 1) ? pos + 2 + offset : 0;
+    }
+    pos += 1 + ad_len;
+  }
+  return 0;
+}
+
+uint16_t adv_payload_commit(adv_payload_t *payload, uint8_t handle)
+{
+  uint16_t result;
+
+  if (!payload->changed) {
+    return bg_err_success;
+  }
+  result = gecko_cmd_le_gap_bt5_set_adv_data(handle, payload->packet, payload->len,
+                                             payload->data)->result;
+  payload->changed = (result != bg_err_success);
+  return result;
+}
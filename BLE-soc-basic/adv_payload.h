@@ -0,0 +1,171 @@
+/***************************************************************************//**
+ * @file
+ * @brief Advertising payload templates
+ * Advertising and scan response data are written as constant templates of
+ * AD structures, copied once to RAM, and their changing fields are then
+ * patched in place, so updating an advertisement with live values costs a
+ * few byte stores and one le_gap_bt5_set_adv_data.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef ADV_PAYLOAD_H_
+#define ADV_PAYLOAD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Largest payload, 31 bytes for legacy advertising, up to 191 for extended
+#ifndef ADV_PAYLOAD_MAX_LEN
+#define ADV_PAYLOAD_MAX_LEN          31
+#endif
+
+// Packets, the scan_rsp parameter of le_gap_bt5_set_adv_data
+#define ADV_PAYLOAD_ADVERTISING      0
+#define ADV_PAYLOAD_SCAN_RESPONSE    1
+#define ADV_PAYLOAD_PERIODIC         8
+
+// AD types of the Bluetooth assigned numbers
+#define ADV_PAYLOAD_TYPE_FLAGS               0x01
+#define ADV_PAYLOAD_TYPE_UUID16_COMPLETE     0x03
+#define ADV_PAYLOAD_TYPE_UUID128_COMPLETE    0x07
+#define ADV_PAYLOAD_TYPE_SHORT_NAME          0x08
+#define ADV_PAYLOAD_TYPE_COMPLETE_NAME       0x09
+#define ADV_PAYLOAD_TYPE_TX_POWER            0x0a
+#define ADV_PAYLOAD_TYPE_SERVICE_DATA16      0x16
+#define ADV_PAYLOAD_TYPE_MANUFACTURER_DATA   0xff
+
+// Flags value: LE General Discoverable, BR/EDR not supported
+#define ADV_PAYLOAD_FLAGS_GENERAL    0x06
+
+// One AD structure of a template, the length byte is counted by the
+// compiler: ADV_PAYLOAD_AD(ADV_PAYLOAD_TYPE_FLAGS, ADV_PAYLOAD_FLAGS_GENERAL)
+#define ADV_PAYLOAD_AD(type, ...) \
+  (uint8_t)(1 + sizeof((const uint8_t[]){ __VA_ARGS__ })), (type), __VA_ARGS__
+
+typedef struct {
+  uint8_t data[ADV_PAYLOAD_MAX_LEN];
+  uint8_t len;
+  // ADV_PAYLOAD_ADVERTISING, ADV_PAYLOAD_SCAN_RESPONSE or ADV_PAYLOAD_PERIODIC
+  uint8_t packet;
+  // Patched since the stack got the data
+  bool changed;
+} adv_payload_t;
+
+/***************************************************************************//**
+ * @brief
+ *   Load a template into a payload.
+ *
+ * @param[out] payload
+ *   Payload to initialize.
+ *
+ * @param[in] packet
+ *   Packet the payload is sent in, ADV_PAYLOAD_ADVERTISING,
+ *   ADV_PAYLOAD_SCAN_RESPONSE or ADV_PAYLOAD_PERIODIC.
+ *
+ * @param[in] template
+ *   AD structures, built with ADV_PAYLOAD_AD().
+ *
+ * @param[in] len
+ *   Size of the template, at most ADV_PAYLOAD_MAX_LEN.
+ *
+ * @return
+ *   True if loaded, False if the template is too long or its AD structures
+ *   do not add up to its size.
+ *
+ ******************************************************************************/
+bool adv_payload_init(adv_payload_t *payload, uint8_t packet, const uint8_t *template, uint8_t len);
+
+/***************************************************************************//**
+ * @brief
+ *   Find the data of an AD structure.
+ *
+ * @details
+ *   Meant to be called once after adv_payload_init(), the returned position
+ *   stays valid for the life of the payload and is given to the put
+ *   functions.
+ *
+ * @param[in] payload
+ *   Payload to search.
+ *
+ * @param[in] type
+ *   AD type.
+ *
+ * @param[in] offset
+ *   Offset in the data of the AD structure, e.g. 2 to skip the company
+ *   identifier of manufacturer specific data.
+ *
+ * @return
+ *   Offset of the field in the payload, 0 if the payload has no AD structure
+ *   of the type or it is too short.
+ *
+ ******************************************************************************/
+uint8_t adv_payload_field(const adv_payload_t *payload, uint8_t type, uint8_t offset);
+
+/***************************************************************************//**
+ * @brief
+ *   Give the payload to the stack if it changed.
+ *
+ * @param[in] payload
+ *   Payload to send.
+ *
+ * @param[in] handle
+ *   Advertising set handle.
+ *
+ * @return
+ *   Result of le_gap_bt5_set_adv_data, bg_err_success if nothing changed.
+ *
+ ******************************************************************************/
+uint16_t adv_payload_commit(adv_payload_t *payload, uint8_t handle);
+
+/***************************************************************************//**
+ * @brief
+ *   Store a byte in a field.
+ *
+ * @param[in] payload
+ *   Payload to patch.
+ *
+ * @param[in] field
+ *   Offset from adv_payload_field().
+ *
+ * @param[in] value
+ *   Value to store.
+ *
+ ******************************************************************************/
+static inline void adv_payload_put_u8(adv_payload_t *payload, uint8_t field, uint8_t value)
+{
+  payload->changed |= (payload->data[field] != value);
+  payload->data[field] = value;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Store a 16-bit value in a field, little endian.
+ *
+ * @param[in] payload
+ *   Payload to patch.
+ *
+ * @param[in] field
+ *   Offset from adv_payload_field().
+ *
+ * @param[in] value
+ *   Value to store.
+ *
+ ******************************************************************************/
+static inline void adv_payload_put_u16(adv_payload_t *payload, uint8_t field, uint16_t value)
+{
+  adv_payload_put_u8(payload, field, (uint8_t)value);
+  adv_payload_put_u8(payload, field + 1, (uint8_t)(value >> 8));
+}
+
+#endif /* ADV_PAYLOAD_H_ */
@@ -0,0 +1,280 @@
+/***************************************************************************//**
+ * @file
+ * @brief Advertising set scheduler
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include "adv_sched.h"
+
+// Legacy advertising PDU on the 1M PHY: preamble, access address, header,
+// advertiser address and CRC around the data, 8 us per byte, on 3 channels
+#define PDU_OVERHEAD       16
+#define EVENT_AIRTIME(len) (3 * 8 * (PDU_OVERHEAD + (uint32_t)(len)))
+
+#define NO_CONNECTION      0xff
+
+// Data length assumed when the stack builds the payload
+#define STACK_DATA_LEN     31
+
+// Airtime of an event of airtime_us at an interval, in parts per million,
+// the interval being in units of 0.625 ms
+#define AIRTIME_PPM(airtime_us, interval) ((airtime_us) * 1600UL / (interval))
+
+typedef struct {
+  const adv_sched_config_t *config;
+  // Advertising, not stopped by a connection or a timeout
+  bool running;
+  // Connection which stopped the set, it restarts when that one closes,
+  // NO_CONNECTION if none
+  uint8_t connection;
+  // Interval the set advertises at, in units of 0.625 ms
+  uint32_t interval;
+  // Interval set at runtime in ms instead of the configured one, 0 if none
+  uint16_t interval_ms;
+} adv_sched_set_t;
+
+static adv_sched_set_t sets[ADV_SCHED_MAX_SETS];
+static uint8_t connections = 0;
+
+static void adv_sched_rebalance(void);
+static bool adv_sched_start_set(uint8_t handle, uint32_t interval);
+static uint32_t adv_sched_event_airtime(const adv_sched_config_t *config);
+static uint32_t adv_sched_wanted_interval(uint8_t handle);
+
+bool adv_sched_add(uint8_t handle, const adv_sched_config_t *config)
+{
+  if (handle >= ADV_SCHED_MAX_SETS) {
+    return false;
+  }
+  sets[handle].config = config;
+  sets[handle].running = false;
+  sets[handle].connection = NO_CONNECTION;
+  sets[handle].interval = 0;
+  sets[handle].interval_ms = 0;
+  return true;
+}
+
+void adv_sched_start(void)
+{
+  for (uint8_t i = 0; i < ADV_SCHED_MAX_SETS; i++) {
+    // the rebalance starts the sets marked running
+    sets[i].running = (sets[i].config != NULL);
+  }
+  adv_sched_rebalance();
+}
+
+bool adv_sched_handle_event(struct gecko_cmd_packet *evt)
+{
+  uint8_t handle;
+
+  switch (BGLIB_MSG_ID(evt->header)) {
+    case gecko_evt_le_connection_opened_id:
+      connections++;
+      // a connectable legacy set stops advertising on a connection
+      handle = evt->data.evt_le_connection_opened.advertiser;
+      if (handle < ADV_SCHED_MAX_SETS && sets[handle].running) {
+        sets[handle].running = false;
+        sets[handle].connection = evt->data.evt_le_connection_opened.connection;
+        sets[handle].interval = 0;
+      }
+      adv_sched_rebalance();
+      break;
+
+    case gecko_evt_le_connection_closed_id:
+      if (connections > 0) {
+        connections--;
+      }
+      for (uint8_t i = 0; i < ADV_SCHED_MAX_SETS; i++) {
+        if (sets[i].config != NULL
+            && sets[i].connection == evt->data.evt_le_connection_closed.connection) {
+          sets[i].connection = NO_CONNECTION;
+          sets[i].running = true;
+        }
+      }
+      adv_sched_rebalance();
+      break;
+
+    case gecko_evt_le_gap_adv_timeout_id:
+      handle = evt->data.evt_le_gap_adv_timeout.handle;
+      if (handle < ADV_SCHED_MAX_SETS && sets[handle].config != NULL) {
+        sets[handle].running = false;
+        sets[handle].interval = 0;
+        adv_sched_rebalance();
+        return true;
+      }
+      break;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+void adv_sched_commit(void)
+{
+  for (uint8_t i = 0; i < ADV_SCHED_MAX_SETS; i++) {
+    const adv_sched_config_t *config = sets[i].config;
+
+    if (config == NULL) {
+      continue;
+    }
+    if (config->adv) {
+      adv_payload_commit(config->adv, i);
+    }
+    if (config->scan_rsp) {
+      adv_payload_commit(config->scan_rsp, i);
+    }
+  }
+}
+
+void adv_sched_set_interval(uint8_t handle, uint16_t interval_ms)
+{
+  if (handle >= ADV_SCHED_MAX_SETS || sets[handle].config == NULL) {
+    return;
+  }
+  sets[handle].interval_ms = interval_ms;
+  if (sets[handle].interval > 0) {
+    // restart even at the same interval, to apply the whitelist
+    gecko_cmd_le_gap_stop_advertising(handle);
+    sets[handle].interval = 0;
+  }
+  adv_sched_rebalance();
+}
+
+uint32_t adv_sched_interval(uint8_t handle)
+{
+  return (handle < ADV_SCHED_MAX_SETS) ? sets[handle].interval : 0;
+}
+
+uint32_t adv_sched_airtime(void)
+{
+  uint32_t airtime = 0;
+
+  for (uint8_t i = 0; i < ADV_SCHED_MAX_SETS; i++) {
+    if (sets[i].interval > 0) {
+      airtime += AIRTIME_PPM(adv_sched_event_airtime(sets[i].config), sets[i].interval);
+    }
+  }
+  return airtime;
+}
+
+/**
+ * Give every running set its wanted interval if the budget allows, else
+ * stretch the intervals of the sets which are not fixed by the same factor
+ * so they share what the fixed ones leave
+ */
+static void adv_sched_rebalance(void)
+{
+  int32_t budget = ADV_SCHED_AIRTIME_BUDGET - (int32_t)connections * ADV_SCHED_CONNECTION_COST;
+  int32_t left;
+  bool stretch;
+  uint32_t fixed_airtime = 0;
+  uint32_t flexible_airtime = 0;
+  uint32_t wanted[ADV_SCHED_MAX_SETS];
+
+  for (uint8_t i = 0; i < ADV_SCHED_MAX_SETS; i++) {
+    if (!sets[i].running) {
+      continue;
+    }
+    wanted[i] = adv_sched_wanted_interval(i);
+    if (sets[i].config->fixed) {
+      fixed_airtime += AIRTIME_PPM(adv_sched_event_airtime(sets[i].config), wanted[i]);
+    } else {
+      flexible_airtime += AIRTIME_PPM(adv_sched_event_airtime(sets[i].config), wanted[i]);
+    }
+  }
+
+  stretch = ((int32_t)(fixed_airtime + flexible_airtime) > budget);
+  left = budget - (int32_t)fixed_airtime;
+  for (uint8_t i = 0; i < ADV_SCHED_MAX_SETS; i++) {
+    uint32_t interval;
+
+    if (!sets[i].running) {
+      continue;
+    }
+    interval = wanted[i];
+    if (stretch && !sets[i].config->fixed) {
+      interval = (left > 0)
+                 ? (uint32_t)(((uint64_t)interval * flexible_airtime + left - 1) / left)
+                 : ADV_SCHED_MAX_INTERVAL;
+      if (interval > ADV_SCHED_MAX_INTERVAL) {
+        interval = ADV_SCHED_MAX_INTERVAL;
+      }
+    }
+    if (interval != sets[i].interval) {
+      if (sets[i].interval > 0) {
+        gecko_cmd_le_gap_stop_advertising(i);
+      }
+      sets[i].running = adv_sched_start_set(i, interval);
+    }
+  }
+}
+
+static bool adv_sched_start_set(uint8_t handle, uint32_t interval)
+{
+  const adv_sched_config_t *config = sets[handle].config;
+
+  sets[handle].interval = 0;
+  gecko_cmd_le_gap_set_advertise_tx_power(handle, config->tx_power);
+  if (gecko_cmd_le_gap_set_advertise_timing(handle, interval, interval, 0, 0)->result
+      != bg_err_success) {
+    return false;
+  }
+  if (config->adv) {
+    config->adv->changed = true;
+    adv_payload_commit(config->adv, handle);
+  }
+  if (config->scan_rsp) {
+    config->scan_rsp->changed = true;
+    adv_payload_commit(config->scan_rsp, handle);
+  }
+  if (gecko_cmd_le_gap_start_advertising(handle, config->discover, config->connect)->result
+      != bg_err_success) {
+    return false;
+  }
+  sets[handle].interval = interval;
+  return true;
+}
+
+/**
+ * Airtime of one advertising event in us
+ */
+static uint32_t adv_sched_event_airtime(const adv_sched_config_t *config)
+{
+  return EVENT_AIRTIME(config->adv ? config->adv->len : STACK_DATA_LEN);
+}
+
+/**
+ * Configured or set interval, staggered by the handle and stretched to the limit of
+ * the set, in units of 0.625 ms
+ */
+static uint32_t adv_sched_wanted_interval(uint8_t handle)
+{
+  const adv_sched_config_t *config = sets[handle].config;
+  uint16_t interval_ms = sets[handle].interval_ms ? sets[handle].interval_ms : config->interval_ms;
+  uint32_t interval = (uint32_t)interval_ms * 8 / 5 + (uint32_t)handle * ADV_SCHED_STAGGER;
+
+  if (config->airtime_limit > 0) {
+    uint32_t shortest = (adv_sched_event_airtime(config) * 1600UL + config->airtime_limit - 1)
+                        / config->airtime_limit;
+
+    if (interval < shortest) {
+      interval = shortest;
+    }
+  }
+  if (interval < ADV_SCHED_MIN_INTERVAL) {
+    interval = ADV_SCHED_MIN_INTERVAL;
+  }
+  return (interval > ADV_SCHED_MAX_INTERVAL) ? ADV_SCHED_MAX_INTERVAL : interval;
+}
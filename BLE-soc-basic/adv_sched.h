@@ -0,0 +1,175 @@
+/***************************************************************************//**
+ * @file
+ * @brief Advertising set scheduler
+ * Runs several advertising sets, each with its own interval, TX power and
+ * airtime limit, and stretches their intervals when together they would
+ * take more airtime than the budget, which shrinks with every connection.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef ADV_SCHED_H_
+#define ADV_SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "native_gecko.h"
+#include "adv_payload.h"
+
+// Sets managed, the set handles run from 0 to ADV_SCHED_MAX_SETS - 1, at most
+// MAX_ADVERTISERS of main.c
+#ifndef ADV_SCHED_MAX_SETS
+#define ADV_SCHED_MAX_SETS           3
+#endif
+
+// Airtime all the sets may take together, in parts per million
+#ifndef ADV_SCHED_AIRTIME_BUDGET
+#define ADV_SCHED_AIRTIME_BUDGET     20000
+#endif
+
+// Airtime budget taken away by each open connection, in parts per million
+#ifndef ADV_SCHED_CONNECTION_COST
+#define ADV_SCHED_CONNECTION_COST    5000
+#endif
+
+// Added to the interval of each set per set handle, in units of 0.625 ms, so
+// sets with the same interval drift apart instead of colliding at every event
+#ifndef ADV_SCHED_STAGGER
+#define ADV_SCHED_STAGGER            7
+#endif
+
+// Interval range of legacy advertising, 20 ms to 10.24 s in units of 0.625 ms
+#define ADV_SCHED_MIN_INTERVAL       32
+#define ADV_SCHED_MAX_INTERVAL       16384
+
+typedef struct {
+  // Interval wanted, in ms
+  uint16_t interval_ms;
+  // Airtime this set may take, in parts per million, 0 for no limit
+  uint16_t airtime_limit;
+  // TX power, in units of 0.1 dBm
+  int16_t tx_power;
+  // le_gap_discoverable_mode, le_gap_user_data to send the payloads
+  uint8_t discover;
+  // le_gap_connectable_mode
+  uint8_t connect;
+  // True to keep the interval when the budget is exceeded, the other sets
+  // make up for it
+  bool fixed;
+  // Advertising data, NULL if the stack builds it
+  adv_payload_t *adv;
+  // Scan response data, NULL if none or built by the stack
+  adv_payload_t *scan_rsp;
+} adv_sched_config_t;
+
+/***************************************************************************//**
+ * @brief
+ *   Add an advertising set.
+ *
+ * @details
+ *   The set starts with adv_sched_start(). The configuration is kept by
+ *   reference and must stay valid.
+ *
+ * @param[in] handle
+ *   Advertising set handle, below ADV_SCHED_MAX_SETS.
+ *
+ * @param[in] config
+ *   Configuration of the set.
+ *
+ * @return
+ *   True if added, False if the handle is out of range.
+ *
+ ******************************************************************************/
+bool adv_sched_add(uint8_t handle, const adv_sched_config_t *config);
+
+/***************************************************************************//**
+ * @brief
+ *   Start all the added sets.
+ *
+ * @details
+ *   Call after the system boot event.
+ *
+ ******************************************************************************/
+void adv_sched_start(void);
+
+/***************************************************************************//**
+ * @brief
+ *   Handle a Bluetooth stack event.
+ *
+ * @details
+ *   Pass every event to the scheduler. Connections change the budget, a
+ *   set stopped by a connection restarts when the connection closes.
+ *
+ * @param[in] evt
+ *   Event from gecko_wait_event() or gecko_peek_event().
+ *
+ * @return
+ *   True if the event was an advertising timeout of a managed set and needs
+ *   no further handling, False otherwise.
+ *
+ ******************************************************************************/
+bool adv_sched_handle_event(struct gecko_cmd_packet *evt);
+
+/***************************************************************************//**
+ * @brief
+ *   Send the payloads of the sets which changed.
+ *
+ * @details
+ *   Call after patching payloads of the sets, instead of
+ *   adv_payload_commit().
+ *
+ ******************************************************************************/
+void adv_sched_commit(void);
+
+/***************************************************************************//**
+ * @brief
+ *   Change the interval of a set.
+ *
+ * @details
+ *   The set keeps its airtime limit and whether it is fixed. A running set
+ *   is restarted, so a whitelist enabled or disabled since takes effect. A
+ *   set stopped by a connection takes the interval when it restarts.
+ *
+ * @param[in] handle
+ *   Advertising set handle.
+ *
+ * @param[in] interval_ms
+ *   Interval wanted, in ms, 0 to go back to the configured one.
+ *
+ ******************************************************************************/
+void adv_sched_set_interval(uint8_t handle, uint16_t interval_ms);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the interval a set advertises at.
+ *
+ * @param[in] handle
+ *   Advertising set handle.
+ *
+ * @return
+ *   Interval in units of 0.625 ms, 0 if the set is not advertising.
+ *
+ ******************************************************************************/
+uint32_t adv_sched_interval(uint8_t handle);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the airtime the running sets take.
+ *
+ * @return
+ *   Airtime in parts per million.
+ *
+ ******************************************************************************/
+uint32_t adv_sched_airtime(void);
+
+#endif /* ADV_SCHED_H_ */
@@ -23,15 +23,100 @@
 #include "bg_types.h"
 #include "native_gecko.h"
 #include "gatt_db.h"
+#include "gatt_db_access.h"
 
 #include "app.h"
+#include "heap_monitor.h"
+#include "conn_ctrl.h"
+#include "link_mgr.h"
+#include "mtu_mgr.h"
+#include "gatt_bench.h"
+#include "adv_payload.h"
+#include "adv_sched.h"
+#include "periodic_bcast.h"
+#include "ieee11073.h"
+#include "bulk_xfer.h"
+#include "reconn_mgr.h"
 
 #include "em_adc.h"
 #include "em_usart.h"
 
+/* Company identifiers, for the manufacturer specific data */
+#define COMPANY_ID_SILABS 0x02ff
+#define COMPANY_ID_APPLE  0x004c
+
+/* Advertising sets, up to MAX_ADVERTISERS of main.c */
+#define ADV_SET_CONNECTABLE 0
+#define ADV_SET_BEACON      1
+#define ADV_SET_BROADCAST   2
+#define ADV_SET_PERIODIC    3
+
+/* Connectable set: flags and the voltage service, the device name in the scan response */
+static const uint8_t advTemplate[] = {
+  ADV_PAYLOAD_AD(ADV_PAYLOAD_TYPE_FLAGS, ADV_PAYLOAD_FLAGS_GENERAL),
+  ADV_PAYLOAD_AD(ADV_PAYLOAD_TYPE_UUID128_COMPLETE,
+                 0x03, 0xd4, 0xb0, 0xcf, 0xf1, 0xad, 0x50, 0xbf,
+                 0x51, 0x4c, 0x63, 0xfd, 0x9e, 0x88, 0x78, 0x4f),
+};
+static const uint8_t scanResponseTemplate[] = {
+  ADV_PAYLOAD_AD(ADV_PAYLOAD_TYPE_COMPLETE_NAME, 'S', 'i', 'j', 'i', 'n', ' ', 'W', 'o', 'o'),
+};
+
+/* Beacon set: iBeacon with the voltage service UUID, major 0, minor 0 and -61 dBm at 1 m */
+static const uint8_t beaconTemplate[] = {
+  ADV_PAYLOAD_AD(ADV_PAYLOAD_TYPE_FLAGS, ADV_PAYLOAD_FLAGS_GENERAL),
+  ADV_PAYLOAD_AD(ADV_PAYLOAD_TYPE_MANUFACTURER_DATA,
+                 (uint8_t)COMPANY_ID_APPLE, (uint8_t)(COMPANY_ID_APPLE >> 8), 0x02, 0x15,
+                 0x4f, 0x78, 0x88, 0x9e, 0xfd, 0x63, 0x4c, 0x51,
+                 0xbf, 0x50, 0xad, 0xf1, 0xcf, 0xb0, 0xd4, 0x03,
+                 0x00, 0x00, 0x00, 0x00, 0xc3),
+};
+
+/* Broadcast set: the last voltage reading in mV and a sequence number, patched every second */
+static const uint8_t broadcastTemplate[] = {
+  ADV_PAYLOAD_AD(ADV_PAYLOAD_TYPE_MANUFACTURER_DATA,
+                 (uint8_t)COMPANY_ID_SILABS, (uint8_t)(COMPANY_ID_SILABS >> 8), 0x00, 0x00, 0x00),
+};
+
+static adv_payload_t advData;
+static adv_payload_t scanResponse;
+static adv_payload_t beaconData;
+static adv_payload_t broadcastData;
+static uint8_t advVoltageField;
+static uint8_t advSequenceField;
+
+/* The connectable set keeps its interval, 100 ms unless the reconnection manager bursts or backs
+ * off, the others give way when the airtime budget runs short */
+static const adv_sched_config_t connectableSet = {
+  .interval_ms = 100, .tx_power = 80, .discover = le_gap_user_data,
+  .connect = le_gap_connectable_scannable, .fixed = true, .adv = &advData, .scan_rsp = &scanResponse
+};
+static const adv_sched_config_t beaconSet = {
+  .interval_ms = 1000, .tx_power = 0, .discover = le_gap_user_data,
+  .connect = le_gap_non_connectable, .adv = &beaconData
+};
+static const adv_sched_config_t broadcastSet = {
+  .interval_ms = 250, .airtime_limit = 5000, .tx_power = 80, .discover = le_gap_user_data,
+  .connect = le_gap_non_connectable, .adv = &broadcastData
+};
+
+/* Voltage history downloaded over the bulk transfer channel: the readings as SFLOAT since
+ * boot, of which the last HISTORY_LEN are kept, the older ones read as NaN */
+#define HISTORY_LEN 512
+static uint16_t voltageHistory[HISTORY_LEN];
+static uint32_t historyCount = 0;
+
+static uint32_t historySize(void);
+static void historyRead(uint32_t offset, uint8_t *data, uint16_t len);
+
+static const bulk_xfer_source_t historySource = { .size = historySize, .read = historyRead };
+
 /* Print boot message */
 static void bootMessage(struct gecko_msg_system_boot_evt_t *bootevt);
 
+/* Print Bluetooth stack heap usage */
+static void heapMessage(void);
+
 /* Flag for indicating DFU Reset must be performed */
 static uint8_t boot_to_dfu = 0;
 
@@ -48,6 +133,8 @@ void appMain(gecko_configuration_t *pconfig)
   /* Initialize ADC */
   uint32_t ADCdata;
   uint16_t boardVoltage;
+  uint16_t result;
+  uint16_t voltageRecord;
   ADC_InitSingle_TypeDef ADC_InitStruct = ADC_INITSINGLE_DEFAULT;
   ADC_InitStruct.acqTime = adcAcqTime16;
   ADC_InitStruct.reference = adcRefVDD;
@@ -59,6 +146,9 @@ void appMain(gecko_configuration_t *pconfig)
 
   /* Initialize stack */
   gecko_init(pconfig);
+  gecko_init_periodic_advertising();
+  gecko_bgapi_class_l2cap_init();
+  gecko_init_whitelisting();
 
   while (1) {
     /* Event pointer for handling events */
@@ -73,6 +163,18 @@ void appMain(gecko_configuration_t *pconfig)
     /* Check for stack event. This is a blocking event listener. If you want non-blocking please see UG136. */
     evt = gecko_wait_event();		// Originally: evt = gecko_wait_event();
 
+    /* Let the advertising scheduler, the MTU manager, the connection parameter controller and
+     * the PHY link manager follow the connections, the timers of the latter need no further
+     * handling. The reconnection manager goes first, so the scheduler restarts the connectable
+     * set after a connection at the interval it chose. The throughput benchmark also serves its
+     * characteristics, the bulk transfer its L2CAP channel. */
+    mtu_mgr_handle_event(evt);
+    if (reconn_mgr_handle_event(evt) || adv_sched_handle_event(evt) || conn_ctrl_handle_event(evt)
+        || link_mgr_handle_event(evt) || gatt_bench_handle_event(evt)
+        || bulk_xfer_handle_event(evt)) {
+      continue;
+    }
+
     /* Handle events */
     switch (BGLIB_MSG_ID(evt->header)) {
       /* This boot event is generated when the system boots up after reset.
@@ -83,15 +185,34 @@ void appMain(gecko_configuration_t *pconfig)
         bootMessage(&(evt->data.evt_system_boot));
         printLog("boot event - starting advertising\r\n");
 
-        /* Set advertising parameters. 100ms advertisement interval.
-         * The first parameter is advertising set handle
-         * The next two parameters are minimum and maximum advertising interval, both in
-         * units of (milliseconds * 1.6).
-         * The last two parameters are duration and maxevents left as default. */
-        gecko_cmd_le_gap_set_advertise_timing(0, 160, 160, 0, 0);
-
-        /* Start general advertising and enable connections. */
-        gecko_cmd_le_gap_start_advertising(0, le_gap_general_discoverable, le_gap_connectable_scannable);
+        /* Load the advertising templates, the readings are patched in by the timer */
+        adv_payload_init(&advData, ADV_PAYLOAD_ADVERTISING, advTemplate, sizeof(advTemplate));
+        adv_payload_init(&scanResponse, ADV_PAYLOAD_SCAN_RESPONSE, scanResponseTemplate,
+                         sizeof(scanResponseTemplate));
+        adv_payload_init(&beaconData, ADV_PAYLOAD_ADVERTISING, beaconTemplate, sizeof(beaconTemplate));
+        adv_payload_init(&broadcastData, ADV_PAYLOAD_ADVERTISING, broadcastTemplate,
+                         sizeof(broadcastTemplate));
+        advVoltageField = adv_payload_field(&broadcastData, ADV_PAYLOAD_TYPE_MANUFACTURER_DATA, 2);
+        advSequenceField = advVoltageField + 2;
+
+        /* Start the connectable, beacon and broadcast sets, the scheduler sets their intervals
+         * and restarts the connectable set when a connection closes. */
+        adv_sched_add(ADV_SET_CONNECTABLE, &connectableSet);
+        adv_sched_add(ADV_SET_BEACON, &beaconSet);
+        adv_sched_add(ADV_SET_BROADCAST, &broadcastSet);
+        adv_sched_start();
+
+        /* Bring bonded peers back quickly with a whitelisted burst of the connectable set,
+         * then let its duty cycle back off */
+        reconn_mgr_start(ADV_SET_CONNECTABLE);
+
+        /* Publish the readings to any number of synced listeners, outside the scheduler as the
+         * periodic train keeps its own interval */
+        periodic_bcast_start(ADV_SET_PERIODIC, COMPANY_ID_SILABS);
+
+        /* Serve the voltage history on the bulk transfer channel */
+        bulk_xfer_init(&historySource);
+        gecko_cmd_hardware_set_soft_timer(32768, 0, 0);	// start software timer
         break;
 
       case gecko_evt_le_connection_opened_id:
@@ -107,27 +228,59 @@ void appMain(gecko_configuration_t *pconfig)
     	boardVoltage = (uint16_t)(ADCdata * 3300 / 4096);
     	printLog("data: %d, voltage: %d mV\r\n", ADCdata, boardVoltage);
 
-    	//boardVoltage = ((boardVoltage & 0x00FF) << 8) | ((boardVoltage & 0xFF00) >> 8);
-    	gecko_cmd_gatt_server_write_attribute_value(gattdb_board_voltage, 0, 2, (const uint8*)&boardVoltage);
-    	gecko_cmd_gatt_server_send_characteristic_notification(0xFF, gattdb_board_voltage, 2, (const uint8*)&boardVoltage);
-    	gecko_cmd_gatt_write_descriptor_value(0xFF, gattdb_voltage_descriptor, 2, (const uint8*)&boardVoltage);
+    	gattdb_write_board_voltage(boardVoltage);
+    	result = gattdb_notify_board_voltage(0xFF, boardVoltage);
+    	if (result == bg_err_success) {
+    	  conn_ctrl_data_sent(2);
+    	} else if (result == bg_err_out_of_memory) {
+    	  link_mgr_tx_failed();
+    	}
+    	gattdb_write_voltage_descriptor(boardVoltage);
+
+    	/* Advertise the reading, the stack sends it whenever advertising */
+    	adv_payload_put_u16(&broadcastData, advVoltageField, boardVoltage);
+    	adv_payload_put_u8(&broadcastData, advSequenceField, broadcastData.data[advSequenceField] + 1);
+    	adv_sched_commit();
+
+    	/* Batch the reading, in volts as SFLOAT, for the periodic advertising listeners */
+    	voltageRecord = ieee11073_sfloat_encode(boardVoltage, -3);
+    	periodic_bcast_add((const uint8_t[PERIODIC_BCAST_RECORD_LEN]){
+    	  (uint8_t)voltageRecord, (uint8_t)(voltageRecord >> 8) });
+    	voltageHistory[historyCount++ % HISTORY_LEN] = voltageRecord;
     	uint8_t glucose_flags = 0x02;
     	//uint16_t glucose_concentration = FLT_TO_UINT16((uint16_t)(ADCdata * 3300 / 4096), -3);
     	//gecko_cmd_gatt_server_write_attribute_value(gattdb_glucose_measurement, )
 
     	break;
 
+      case gecko_evt_le_connection_parameters_id:
+        printLog("connection parameters: interval %u, latency %u, timeout %u, PDU %u\r\n",
+                 evt->data.evt_le_connection_parameters.interval,
+                 evt->data.evt_le_connection_parameters.latency,
+                 evt->data.evt_le_connection_parameters.timeout,
+                 evt->data.evt_le_connection_parameters.txsize);
+        break;
+
+      case gecko_evt_gatt_mtu_exchanged_id:
+        printLog("MTU: %u, %u bytes per notification\r\n", evt->data.evt_gatt_mtu_exchanged.mtu,
+                 mtu_mgr_max_payload(evt->data.evt_gatt_mtu_exchanged.connection));
+        break;
+
+      case gecko_evt_le_connection_phy_status_id:
+        printLog("PHY: 0x%x, %lu switches\r\n", evt->data.evt_le_connection_phy_status.phy,
+                 (unsigned long)link_mgr_switches());
+        break;
+
       case gecko_evt_le_connection_closed_id:
 
         printLog("connection closed, reason: 0x%2.2x\r\n", evt->data.evt_le_connection_closed.reason);
+        heapMessage();
 
-        /* Check if need to boot to OTA DFU mode */
+        /* Check if need to boot to OTA DFU mode, the advertising scheduler has already restarted
+         * advertising otherwise */
         if (boot_to_dfu) {
           /* Enter to OTA DFU mode */
           gecko_cmd_system_reset(2);
-        } else {
-          /* Restart advertising after client has disconnected */
-          gecko_cmd_le_gap_start_advertising(0, le_gap_general_discoverable, le_gap_connectable_scannable);
         }
         break;
 
@@ -160,6 +313,24 @@ void appMain(gecko_configuration_t *pconfig)
   }
 }
 
+/* Size of the voltage history in bytes */
+static uint32_t historySize(void)
+{
+  return historyCount * sizeof(voltageHistory[0]);
+}
+
+/* Read the voltage history, little endian */
+static void historyRead(uint32_t offset, uint8_t *data, uint16_t len)
+{
+  for (; len > 0; len--, offset++) {
+    uint32_t index = offset / sizeof(voltageHistory[0]);
+    uint16_t value = (index + HISTORY_LEN >= historyCount)
+                     ? voltageHistory[index % HISTORY_LEN] : IEEE11073_SFLOAT_NAN;
+
+    *data++ = (uint8_t)((offset & 1) ? value >> 8 : value);
+  }
+}
+
 /* Print stack version and local Bluetooth address as boot message */
 static void bootMessage(struct gecko_msg_system_boot_evt_t *bootevt)
 {
@@ -175,5 +346,23 @@ static void bootMessage(struct gecko_msg_system_boot_evt_t *bootevt)
     printLog("%2.2x:", local_addr.addr[5 - i]);
   }
   printLog("%2.2x\r\n", local_addr.addr[0]);
+  heapMessage();
+#endif
+}
+
+/* Print heap usage, in profile builds (HEAP_MONITOR_PROFILE) with the heap size
+ * to use for the workload seen so far */
+static void heapMessage(void)
+{
+#if DEBUG_LEVEL
+  heap_monitor_stats_t stats;
+
+  heap_monitor_read(&stats);
+  printLog("stack heap: %lu of %lu bytes used, high-water %lu\r\n",
+           (unsigned long)stats.used, (unsigned long)stats.size,
+           (unsigned long)stats.high_water);
+#if defined(HEAP_MONITOR_PROFILE)
+  printLog("recommended BLUETOOTH_HEAP_SIZE: %lu\r\n", (unsigned long)stats.recommended);
+#endif
 #endif
 }
@@ -0,0 +1,322 @@
+/***************************************************************************//**
+ * @file
+ * @brief Bulk transfer over an L2CAP connection-oriented channel
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "conn_ctrl.h"
+#include "link_mgr.h"
+#include "bulk_xfer.h"
+
+#define NO_CONNECTION      0xff
+
+// Soft timer ticks at 32768 Hz
+#define TICK_HZ            32768
+
+// The SDU length at the start of the first PDU of an SDU
+#define SDU_LENGTH_LEN     2
+
+// Request lengths
+#define LENGTH_TO_END      0xffffffffUL
+
+typedef struct {
+  uint8_t connection;
+  // Channel endpoint of the client, the destination of what is sent
+  uint16_t cid;
+  // SDU and PDU size the client accepts, and the PDUs it lets us send
+  uint16_t mtu;
+  uint16_t mps;
+  uint16_t credits;
+  // Request being reassembled
+  uint8_t request[BULK_XFER_RX_MTU];
+  uint16_t request_len;
+  uint16_t request_pos;
+  // Download: sending the stream from pos up to end, then the SDU ending it
+  bool active;
+  uint32_t pos;
+  uint32_t end;
+  // Data bytes of the current SDU still to send, 0 between SDUs
+  uint16_t sdu_left;
+  // Request waiting for the current SDU to complete
+  bool restart;
+  uint32_t restart_pos;
+  uint32_t restart_end;
+} bulk_xfer_channel_t;
+
+static const bulk_xfer_source_t *source = NULL;
+static bulk_xfer_channel_t chan = { .connection = NO_CONNECTION };
+
+static void bulk_xfer_open(struct gecko_msg_l2cap_coc_connection_request_evt_t *req);
+static void bulk_xfer_close(void);
+static void bulk_xfer_receive(const uint8_t *data, uint16_t len);
+static void bulk_xfer_request(void);
+static void bulk_xfer_pump(void);
+static uint16_t bulk_xfer_send_pdu(void);
+static uint8_t *put_u16(uint8_t *p, uint32_t value);
+static uint8_t *put_u32(uint8_t *p, uint32_t value);
+static uint32_t get_u32(const uint8_t *p);
+
+void bulk_xfer_init(const bulk_xfer_source_t *new_source)
+{
+  source = new_source;
+}
+
+bool bulk_xfer_handle_event(struct gecko_cmd_packet *evt)
+{
+  switch (BGLIB_MSG_ID(evt->header)) {
+    case gecko_evt_l2cap_coc_connection_request_id:
+      bulk_xfer_open(&evt->data.evt_l2cap_coc_connection_request);
+      return true;
+
+    case gecko_evt_l2cap_coc_le_flow_control_credit_id:
+      if (evt->data.evt_l2cap_coc_le_flow_control_credit.connection == chan.connection) {
+        chan.credits += evt->data.evt_l2cap_coc_le_flow_control_credit.credits;
+        bulk_xfer_pump();
+      }
+      return true;
+
+    case gecko_evt_l2cap_coc_data_id:
+      if (evt->data.evt_l2cap_coc_data.connection == chan.connection) {
+        bulk_xfer_receive(evt->data.evt_l2cap_coc_data.data.data,
+                          evt->data.evt_l2cap_coc_data.data.len);
+      }
+      return true;
+
+    case gecko_evt_l2cap_coc_channel_disconnected_id:
+      if (evt->data.evt_l2cap_coc_channel_disconnected.connection == chan.connection) {
+        bulk_xfer_close();
+      }
+      return true;
+
+    case gecko_evt_l2cap_coc_connection_response_id:
+    case gecko_evt_l2cap_command_rejected_id:
+      return true;
+
+    case gecko_evt_le_connection_closed_id:
+      if (evt->data.evt_le_connection_closed.connection == chan.connection) {
+        bulk_xfer_close();
+      }
+      break;
+
+    case gecko_evt_hardware_soft_timer_id:
+      if (evt->data.evt_hardware_soft_timer.handle == BULK_XFER_PUMP_TIMER_HANDLE) {
+        bulk_xfer_pump();
+        return true;
+      }
+      break;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+bool bulk_xfer_active(void)
+{
+  return chan.active;
+}
+
+/**
+ * Accept a channel on our LE_PSM if none is open
+ */
+static void bulk_xfer_open(struct gecko_msg_l2cap_coc_connection_request_evt_t *req)
+{
+  uint16_t result = l2cap_connection_successful;
+
+  if (req->le_psm != BULK_XFER_PSM) {
+    result = l2cap_le_psm_not_supported;
+  } else if (chan.connection != NO_CONNECTION || source == NULL) {
+    result = l2cap_no_resources_available;
+  }
+  if (gecko_cmd_l2cap_coc_send_connection_response(req->connection, req->source_cid,
+                                                   BULK_XFER_RX_MTU, BULK_XFER_RX_MPS,
+                                                   BULK_XFER_RX_CREDITS, result)->result
+      != bg_err_success || result != l2cap_connection_successful) {
+    return;
+  }
+  memset(&chan, 0, sizeof(chan));
+  chan.connection = req->connection;
+  chan.cid = req->source_cid;
+  chan.mtu = req->mtu;
+  chan.mps = (req->mps < BULK_XFER_MAX_MPS) ? req->mps : BULK_XFER_MAX_MPS;
+  chan.credits = req->initial_credit;
+}
+
+static void bulk_xfer_close(void)
+{
+  gecko_cmd_hardware_set_soft_timer(0, BULK_XFER_PUMP_TIMER_HANDLE, 0);
+  conn_ctrl_set_backlog(0);
+  chan.connection = NO_CONNECTION;
+  chan.active = false;
+}
+
+/**
+ * Reassemble a request from its PDUs, giving the credit of each PDU back
+ */
+static void bulk_xfer_receive(const uint8_t *data, uint16_t len)
+{
+  uint16_t n;
+
+  // the PDU is processed before the event loop moves on
+  gecko_cmd_l2cap_coc_send_le_flow_control_credit(chan.connection, chan.cid, 1);
+  if (chan.request_len == 0) {
+    // the first PDU of an SDU starts with its length
+    if (len < SDU_LENGTH_LEN) {
+      return;
+    }
+    chan.request_len = data[0] | (data[1] << 8);
+    chan.request_pos = 0;
+    data += SDU_LENGTH_LEN;
+    len -= SDU_LENGTH_LEN;
+    if (chan.request_len == 0 || chan.request_len > BULK_XFER_RX_MTU) {
+      // more than the MTU we gave, the client breaks the protocol
+      chan.request_len = 0;
+      gecko_cmd_l2cap_coc_send_disconnection_request(chan.connection, chan.cid);
+      return;
+    }
+  }
+  n = chan.request_len - chan.request_pos;
+  if (len < n) {
+    n = len;
+  }
+  memcpy(chan.request + chan.request_pos, data, n);
+  chan.request_pos += n;
+  if (chan.request_pos == chan.request_len) {
+    bulk_xfer_request();
+    chan.request_len = 0;
+  }
+}
+
+/**
+ * Start a download, or replace the one in progress
+ */
+static void bulk_xfer_request(void)
+{
+  uint32_t size = source->size();
+  uint32_t offset;
+  uint32_t length;
+
+  if (chan.request_len != BULK_XFER_REQUEST_LEN) {
+    return;
+  }
+  offset = get_u32(chan.request);
+  length = get_u32(chan.request + 4);
+  if (offset > size) {
+    offset = size;
+  }
+  chan.restart_pos = offset;
+  chan.restart_end = (length == LENGTH_TO_END || length > size - offset) ? size : offset + length;
+  chan.restart = true;
+  chan.active = true;
+  bulk_xfer_pump();
+}
+
+/**
+ * Queue PDUs while the client has credits and the stack has buffers
+ */
+static void bulk_xfer_pump(void)
+{
+  uint16_t result;
+
+  for (int i = 0; i < BULK_XFER_BURST && chan.active && chan.credits > 0; i++) {
+    result = bulk_xfer_send_pdu();
+    if (result != bg_err_success) {
+      if (result == bg_err_out_of_memory) {
+        link_mgr_tx_failed();
+      }
+      break;
+    }
+  }
+  conn_ctrl_set_backlog(chan.active ? chan.end - chan.pos + chan.sdu_left : 0);
+  // out of buffers or at the end of a burst, come back later; credits come
+  // with their own event
+  if (chan.active && chan.credits > 0) {
+    gecko_cmd_hardware_set_soft_timer(BULK_XFER_PUMP_MS * TICK_HZ / 1000,
+                                      BULK_XFER_PUMP_TIMER_HANDLE, 1);
+  }
+}
+
+/**
+ * Send the next PDU of the download, the state only advances once the
+ * stack took it
+ */
+static uint16_t bulk_xfer_send_pdu(void)
+{
+  uint8_t pdu[BULK_XFER_MAX_MPS];
+  uint8_t *p = pdu;
+  uint32_t pos = chan.pos;
+  uint32_t end = chan.end;
+  uint32_t sdu_left = chan.sdu_left;
+  bool last = false;
+  uint16_t n;
+  uint16_t result;
+
+  if (sdu_left == 0) {
+    // between SDUs, where a new request takes over
+    if (chan.restart) {
+      pos = chan.restart_pos;
+      end = chan.restart_end;
+    }
+    sdu_left = end - pos;
+    if (sdu_left > (uint32_t)chan.mtu - BULK_XFER_SDU_HEADER_LEN) {
+      sdu_left = chan.mtu - BULK_XFER_SDU_HEADER_LEN;
+    }
+    last = (sdu_left == 0);
+    p = put_u16(p, BULK_XFER_SDU_HEADER_LEN + sdu_left);
+    p = put_u32(p, pos);
+  }
+  n = chan.mps - (uint16_t)(p - pdu);
+  if (n > sdu_left) {
+    n = (uint16_t)sdu_left;
+  }
+  if (n > 0) {
+    source->read(pos, p, n);
+  }
+  result = gecko_cmd_l2cap_coc_send_data(chan.connection, chan.cid, (uint8_t)(p - pdu + n),
+                                         pdu)->result;
+  if (result != bg_err_success) {
+    return result;
+  }
+  if (chan.sdu_left == 0) {
+    chan.restart = false;
+  }
+  chan.credits--;
+  chan.pos = pos + n;
+  chan.end = end;
+  chan.sdu_left = (uint16_t)(sdu_left - n);
+  if (last) {
+    chan.active = false;
+  }
+  conn_ctrl_data_sent(p - pdu + n);
+  return bg_err_success;
+}
+
+static uint8_t *put_u16(uint8_t *p, uint32_t value)
+{
+  *p++ = (uint8_t)value;
+  *p++ = (uint8_t)(value >> 8);
+  return p;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t value)
+{
+  p = put_u16(p, value);
+  return put_u16(p, value >> 16);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
@@ -0,0 +1,135 @@
+/***************************************************************************//**
+ * @file
+ * @brief Bulk transfer over an L2CAP connection-oriented channel
+ * Serves downloads of a byte stream, e.g. stored history, on an LE credit
+ * based channel. The stream is sent in SDUs as large as the client accepts,
+ * each cut into PDUs as large as its MPS, as fast as its credits and the
+ * stack buffers allow, without the ATT overhead and the MTU limit of
+ * notifications. Every SDU carries its offset, so an interrupted download
+ * resumes where it stopped.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef BULK_XFER_H_
+#define BULK_XFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "native_gecko.h"
+
+// LE_PSM the client opens the channel on, in the dynamic range 0x80-0xff
+#ifndef BULK_XFER_PSM
+#define BULK_XFER_PSM                0x0080
+#endif
+
+// Soft timer handle retrying once the stack is out of buffers
+#ifndef BULK_XFER_PUMP_TIMER_HANDLE
+#define BULK_XFER_PUMP_TIMER_HANDLE  5
+#endif
+
+// Period in ms to retry once the stack is out of buffers
+#ifndef BULK_XFER_PUMP_MS
+#define BULK_XFER_PUMP_MS            5
+#endif
+
+// PDUs queued at most per pass, so other events are not starved
+#ifndef BULK_XFER_BURST
+#define BULK_XFER_BURST              8
+#endif
+
+// Largest PDU payload sent. 247 makes a PDU, with its 4 byte L2CAP header,
+// exactly one 251 byte LL PDU.
+#ifndef BULK_XFER_MAX_MPS
+#define BULK_XFER_MAX_MPS            247
+#endif
+
+// Credits given to the client, the PDUs it may send before they are
+// processed. Requests fit in one PDU, two let the next follow at once.
+#ifndef BULK_XFER_RX_CREDITS
+#define BULK_XFER_RX_CREDITS         2
+#endif
+
+// SDU and PDU size accepted from the client, the smallest allowed
+#define BULK_XFER_RX_MTU             23
+#define BULK_XFER_RX_MPS             23
+
+/*
+ * Request, an SDU sent by the client, little endian:
+ *   uint32 offset in the stream
+ *   uint32 length, 0xffffffff to the end of the stream, 0 to stop
+ * A request replaces the download in progress once its current SDU is
+ * complete.
+ *
+ * Data, SDUs sent to the client, little endian:
+ *   uint32 offset in the stream of the data
+ *   uint8  data[], up to the client MTU - 4 bytes
+ * An SDU without data ends the download, its offset is where the download
+ * stopped, the end of the request or of the stream. A stop request is
+ * answered with one at the offset of the request.
+ */
+#define BULK_XFER_REQUEST_LEN        8
+#define BULK_XFER_SDU_HEADER_LEN     4
+
+typedef struct {
+  // Size of the stream in bytes, taken at each request
+  uint32_t (*size)(void);
+  // Copy len bytes of the stream from offset, which with len stays below
+  // the size last taken. Called again with the same arguments when the
+  // stack is out of buffers, the data must not change in the meantime.
+  void (*read)(uint32_t offset, uint8_t *data, uint16_t len);
+} bulk_xfer_source_t;
+
+/***************************************************************************//**
+ * @brief
+ *   Set the stream downloads read.
+ *
+ * @details
+ *   gecko_bgapi_class_l2cap_init() must have been called after
+ *   gecko_init(). The source is kept by reference and must stay valid.
+ *
+ * @param[in] source
+ *   Stream to serve.
+ *
+ ******************************************************************************/
+void bulk_xfer_init(const bulk_xfer_source_t *source);
+
+/***************************************************************************//**
+ * @brief
+ *   Handle a Bluetooth stack event.
+ *
+ * @details
+ *   Pass every event to the module. One channel is served at a time,
+ *   further connection requests are refused.
+ *
+ * @param[in] evt
+ *   Event from gecko_wait_event() or gecko_peek_event().
+ *
+ * @return
+ *   True if the event was an L2CAP event or the timer of the module and
+ *   needs no further handling, False otherwise.
+ *
+ ******************************************************************************/
+bool bulk_xfer_handle_event(struct gecko_cmd_packet *evt);
+
+/***************************************************************************//**
+ * @brief
+ *   Check whether a download is in progress.
+ *
+ * @return
+ *   True until the SDU ending the download is sent.
+ *
+ ******************************************************************************/
+bool bulk_xfer_active(void);
+
+#endif /* BULK_XFER_H_ */
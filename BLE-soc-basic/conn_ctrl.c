@@ -0,0 +1,162 @@
+/***************************************************************************//**
+ * @file
+ * @brief Adaptive connection parameter controller
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include "conn_ctrl.h"
+
+#define NO_CONNECTION      0xff
+
+// Bytes per window equivalent to the rates
+#define BURST_BYTES        (CONN_CTRL_BURST_RATE * CONN_CTRL_WINDOW_MS / 1000)
+#define IDLE_BYTES         (CONN_CTRL_IDLE_RATE * CONN_CTRL_WINDOW_MS / 1000)
+
+// Soft timer ticks at 32768 Hz
+#define WINDOW_TICKS       ((uint32_t)CONN_CTRL_WINDOW_MS * 32768 / 1000)
+
+static uint8_t connection = NO_CONNECTION;
+static conn_ctrl_mode_t mode = conn_ctrl_mode_peer;
+// Bytes sent in the current window
+static uint32_t window_bytes = 0;
+static uint32_t backlog = 0;
+// Consecutive quiet windows
+static uint8_t quiet_windows = 0;
+// Windows left until a request without parameters event is given up, 0 if
+// no request is pending
+static uint8_t pending_windows = 0;
+
+static void conn_ctrl_request(conn_ctrl_mode_t new_mode);
+static void conn_ctrl_check_burst(void);
+static void conn_ctrl_window_end(void);
+
+bool conn_ctrl_handle_event(struct gecko_cmd_packet *evt)
+{
+  switch (BGLIB_MSG_ID(evt->header)) {
+    case gecko_evt_le_connection_opened_id:
+      connection = evt->data.evt_le_connection_opened.connection;
+      mode = conn_ctrl_mode_peer;
+      window_bytes = 0;
+      backlog = 0;
+      quiet_windows = 0;
+      pending_windows = 0;
+      gecko_cmd_hardware_set_soft_timer(WINDOW_TICKS, CONN_CTRL_TIMER_HANDLE, 0);
+      break;
+
+    case gecko_evt_le_connection_parameters_id:
+      if (evt->data.evt_le_connection_parameters.connection == connection) {
+        pending_windows = 0;
+      }
+      break;
+
+    case gecko_evt_le_connection_closed_id:
+      if (evt->data.evt_le_connection_closed.connection == connection) {
+        connection = NO_CONNECTION;
+        gecko_cmd_hardware_set_soft_timer(0, CONN_CTRL_TIMER_HANDLE, 0);
+      }
+      break;
+
+    case gecko_evt_hardware_soft_timer_id:
+      if (evt->data.evt_hardware_soft_timer.handle == CONN_CTRL_TIMER_HANDLE) {
+        conn_ctrl_window_end();
+        return true;
+      }
+      break;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+void conn_ctrl_data_sent(uint32_t len)
+{
+  window_bytes += len;
+  conn_ctrl_check_burst();
+}
+
+void conn_ctrl_set_backlog(uint32_t len)
+{
+  backlog = len;
+  conn_ctrl_check_burst();
+}
+
+conn_ctrl_mode_t conn_ctrl_mode(void)
+{
+  return mode;
+}
+
+/**
+ * Switch to the fast parameters as soon as the traffic calls for them
+ */
+static void conn_ctrl_check_burst(void)
+{
+  if (mode != conn_ctrl_mode_burst
+      && (window_bytes >= BURST_BYTES || backlog >= CONN_CTRL_BURST_BACKLOG)) {
+    conn_ctrl_request(conn_ctrl_mode_burst);
+  }
+}
+
+/**
+ * Rate the finished window, the idle parameters need a run of quiet ones
+ */
+static void conn_ctrl_window_end(void)
+{
+  if (pending_windows > 0) {
+    pending_windows--;
+  }
+  if (window_bytes < IDLE_BYTES && backlog == 0) {
+    if (quiet_windows < CONN_CTRL_IDLE_WINDOWS) {
+      quiet_windows++;
+    }
+  } else {
+    quiet_windows = 0;
+  }
+  window_bytes = 0;
+  if (mode != conn_ctrl_mode_idle && quiet_windows == CONN_CTRL_IDLE_WINDOWS) {
+    conn_ctrl_request(conn_ctrl_mode_idle);
+  }
+}
+
+/**
+ * Ask the master for the parameters of a mode. Only one request is
+ * outstanding at a time, the master may take several connection events to
+ * answer and may choose other values within the range.
+ */
+static void conn_ctrl_request(conn_ctrl_mode_t new_mode)
+{
+  uint16_t result;
+
+  if (connection == NO_CONNECTION || pending_windows > 0) {
+    return;
+  }
+  if (new_mode == conn_ctrl_mode_burst) {
+    result = gecko_cmd_le_connection_set_parameters(connection,
+                                                    CONN_CTRL_BURST_MIN_INTERVAL,
+                                                    CONN_CTRL_BURST_MAX_INTERVAL,
+                                                    CONN_CTRL_BURST_LATENCY,
+                                                    CONN_CTRL_BURST_TIMEOUT)->result;
+  } else {
+    result = gecko_cmd_le_connection_set_parameters(connection,
+                                                    CONN_CTRL_IDLE_MIN_INTERVAL,
+                                                    CONN_CTRL_IDLE_MAX_INTERVAL,
+                                                    CONN_CTRL_IDLE_LATENCY,
+                                                    CONN_CTRL_IDLE_TIMEOUT)->result;
+  }
+  if (result == bg_err_success) {
+    mode = new_mode;
+    quiet_windows = 0;
+    pending_windows = CONN_CTRL_PENDING_WINDOWS;
+  }
+}
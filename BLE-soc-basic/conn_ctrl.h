@@ -0,0 +1,159 @@
+/***************************************************************************//**
+ * @file
+ * @brief Adaptive connection parameter controller
+ * Watches the data rate and the backlog of the application and asks the
+ * master for a short connection interval while data flows and for a long
+ * interval with slave latency while the link is idle.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef CONN_CTRL_H_
+#define CONN_CTRL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "native_gecko.h"
+
+// Soft timer handle used for the rate measurement
+#ifndef CONN_CTRL_TIMER_HANDLE
+#define CONN_CTRL_TIMER_HANDLE       1
+#endif
+
+// Length of a measurement window in ms
+#ifndef CONN_CTRL_WINDOW_MS
+#define CONN_CTRL_WINDOW_MS          500
+#endif
+
+// Data rate in bytes per second from which the fast parameters are requested
+#ifndef CONN_CTRL_BURST_RATE
+#define CONN_CTRL_BURST_RATE         512
+#endif
+
+// Backlog in bytes from which the fast parameters are requested
+#ifndef CONN_CTRL_BURST_BACKLOG
+#define CONN_CTRL_BURST_BACKLOG      64
+#endif
+
+// Data rate in bytes per second below which a window counts as quiet, well
+// below CONN_CTRL_BURST_RATE so a rate in between does not switch back and
+// forth
+#ifndef CONN_CTRL_IDLE_RATE
+#define CONN_CTRL_IDLE_RATE          64
+#endif
+
+// Consecutive quiet windows before the idle parameters are requested
+#ifndef CONN_CTRL_IDLE_WINDOWS
+#define CONN_CTRL_IDLE_WINDOWS       6
+#endif
+
+// Windows to wait for the parameters event before a request is given up
+#ifndef CONN_CTRL_PENDING_WINDOWS
+#define CONN_CTRL_PENDING_WINDOWS    8
+#endif
+
+// Fast parameters: 7.5 to 15 ms interval, no latency, 1 s supervision timeout
+#ifndef CONN_CTRL_BURST_MIN_INTERVAL
+#define CONN_CTRL_BURST_MIN_INTERVAL 6
+#endif
+#ifndef CONN_CTRL_BURST_MAX_INTERVAL
+#define CONN_CTRL_BURST_MAX_INTERVAL 12
+#endif
+#ifndef CONN_CTRL_BURST_LATENCY
+#define CONN_CTRL_BURST_LATENCY      0
+#endif
+#ifndef CONN_CTRL_BURST_TIMEOUT
+#define CONN_CTRL_BURST_TIMEOUT      100
+#endif
+
+// Idle parameters: 50 to 100 ms interval, the slave may skip 4 connection
+// events, 4 s supervision timeout. The timeout must stay above
+// (1 + latency) * max interval * 2.
+#ifndef CONN_CTRL_IDLE_MIN_INTERVAL
+#define CONN_CTRL_IDLE_MIN_INTERVAL  40
+#endif
+#ifndef CONN_CTRL_IDLE_MAX_INTERVAL
+#define CONN_CTRL_IDLE_MAX_INTERVAL  80
+#endif
+#ifndef CONN_CTRL_IDLE_LATENCY
+#define CONN_CTRL_IDLE_LATENCY       4
+#endif
+#ifndef CONN_CTRL_IDLE_TIMEOUT
+#define CONN_CTRL_IDLE_TIMEOUT       400
+#endif
+
+typedef enum {
+  // Parameters chosen by the master, not changed yet
+  conn_ctrl_mode_peer,
+  conn_ctrl_mode_burst,
+  conn_ctrl_mode_idle
+} conn_ctrl_mode_t;
+
+/***************************************************************************//**
+ * @brief
+ *   Handle a Bluetooth stack event.
+ *
+ * @details
+ *   Pass every event to the controller, it follows the connection opened,
+ *   parameters and closed events and runs on its own soft timer. One
+ *   connection is controlled, the last one opened.
+ *
+ * @param[in] evt
+ *   Event from gecko_wait_event() or gecko_peek_event().
+ *
+ * @return
+ *   True if the event was the controller's soft timer and needs no further
+ *   handling, False otherwise.
+ *
+ ******************************************************************************/
+bool conn_ctrl_handle_event(struct gecko_cmd_packet *evt);
+
+/***************************************************************************//**
+ * @brief
+ *   Account data handed to the stack.
+ *
+ * @details
+ *   A burst is recognized right away, without waiting for the end of the
+ *   measurement window.
+ *
+ * @param[in] len
+ *   Number of bytes sent, notified or indicated.
+ *
+ ******************************************************************************/
+void conn_ctrl_data_sent(uint32_t len);
+
+/***************************************************************************//**
+ * @brief
+ *   Set the amount of data the application is waiting to send.
+ *
+ * @details
+ *   For applications which buffer data when the stack is out of memory. The
+ *   link is not considered idle while the backlog is not empty.
+ *
+ * @param[in] len
+ *   Number of bytes queued.
+ *
+ ******************************************************************************/
+void conn_ctrl_set_backlog(uint32_t len);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the mode of the controlled connection.
+ *
+ * @return
+ *   Parameter set last requested, conn_ctrl_mode_peer if none.
+ *
+ ******************************************************************************/
+conn_ctrl_mode_t conn_ctrl_mode(void);
+
+#endif /* CONN_CTRL_H_ */
@@ -0,0 +1,347 @@
+/***************************************************************************//**
+ * @file
+ * @brief GATT throughput benchmark service
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "em_rtcc.h"
+#include "gatt_db_access.h"
+#include "conn_ctrl.h"
+#include "link_mgr.h"
+#include "mtu_mgr.h"
+#include "gatt_bench.h"
+
+#define NO_CONNECTION      0xff
+
+// Soft timer and RTCC tick at 32768 Hz
+#define TICK_HZ            32768
+#define TICKS_TO_US(t)     ((uint32_t)(((uint64_t)(t) * 1000000) / TICK_HZ))
+
+// The sequence number at the start of every notification
+#define MIN_PAYLOAD        4
+
+static gatt_bench_mode_t mode = gatt_bench_mode_stop;
+static uint8_t connection = NO_CONNECTION;
+static uint16_t payload_len;
+// Client configuration of Benchmark Data on the connection which set it
+static uint8_t cccd_connection = NO_CONNECTION;
+static uint16_t cccd_flags = 0;
+// Connection interval of the connection in the last parameters event
+static uint8_t params_connection = NO_CONNECTION;
+static uint16_t params_interval = 0;
+// An indication is waiting for its confirmation
+static bool confirm_pending = false;
+
+static uint32_t packets;
+static uint32_t bytes;
+static uint32_t first_len;
+static uint32_t first_tick;
+static uint32_t last_tick;
+static uint32_t last_gap;
+static uint32_t min_gap;
+static uint32_t max_gap;
+static uint64_t jitter_sum;
+
+static uint8_t payload[250];
+static uint8_t result[GATT_BENCH_RESULT_LEN];
+
+static uint8_t gatt_bench_control(uint8_t conn, const uint8_t *data, uint8_t len);
+static void gatt_bench_start(uint8_t conn, gatt_bench_mode_t new_mode,
+                             uint16_t len, uint16_t duration);
+static void gatt_bench_finish(void);
+static void gatt_bench_send(void);
+static void gatt_bench_packet(uint32_t len);
+static uint8_t *put_u16(uint8_t *p, uint32_t value);
+static uint8_t *put_u32(uint8_t *p, uint32_t value);
+
+bool gatt_bench_handle_event(struct gecko_cmd_packet *evt)
+{
+  switch (BGLIB_MSG_ID(evt->header)) {
+    case gecko_evt_gatt_server_user_write_request_id:
+    {
+      struct gecko_msg_gatt_server_user_write_request_evt_t *req =
+        &evt->data.evt_gatt_server_user_write_request;
+
+      if (req->characteristic == gattdb_bench_control) {
+        gecko_cmd_gatt_server_send_user_write_response(req->connection, req->characteristic,
+                                                       gatt_bench_control(req->connection,
+                                                                          req->value.data,
+                                                                          req->value.len));
+        return true;
+      }
+      if (req->characteristic == gattdb_bench_data) {
+        if (req->connection == connection
+            && ((mode == gatt_bench_mode_write && req->att_opcode == gatt_write_request)
+                || (mode == gatt_bench_mode_write_no_response
+                    && req->att_opcode == gatt_write_command))) {
+          gatt_bench_packet(req->value.len);
+        }
+        if (req->att_opcode == gatt_write_request) {
+          gecko_cmd_gatt_server_send_user_write_response(req->connection, req->characteristic, 0);
+        }
+        return true;
+      }
+      break;
+    }
+
+    case gecko_evt_gatt_server_user_read_request_id:
+    {
+      struct gecko_msg_gatt_server_user_read_request_evt_t *req =
+        &evt->data.evt_gatt_server_user_read_request;
+      uint16_t offset = req->offset;
+
+      if (req->characteristic == gattdb_bench_result) {
+        if (offset > GATT_BENCH_RESULT_LEN) {
+          offset = GATT_BENCH_RESULT_LEN;
+        }
+        gecko_cmd_gatt_server_send_user_read_response(req->connection, req->characteristic, 0,
+                                                      GATT_BENCH_RESULT_LEN - offset,
+                                                      result + offset);
+        return true;
+      }
+      break;
+    }
+
+    case gecko_evt_gatt_server_characteristic_status_id:
+    {
+      struct gecko_msg_gatt_server_characteristic_status_evt_t *status =
+        &evt->data.evt_gatt_server_characteristic_status;
+
+      if (status->characteristic != gattdb_bench_data) {
+        break;
+      }
+      if (status->status_flags == gatt_server_client_config) {
+        cccd_connection = status->connection;
+        cccd_flags = status->client_config_flags;
+      } else if (status->status_flags == gatt_server_confirmation
+                 && status->connection == connection
+                 && mode == gatt_bench_mode_indicate && confirm_pending) {
+        confirm_pending = false;
+        gatt_bench_packet(payload_len);
+        gatt_bench_send();
+      }
+      return true;
+    }
+
+    case gecko_evt_le_connection_parameters_id:
+      params_connection = evt->data.evt_le_connection_parameters.connection;
+      params_interval = evt->data.evt_le_connection_parameters.interval;
+      break;
+
+    case gecko_evt_le_connection_closed_id:
+      if (evt->data.evt_le_connection_closed.connection == connection) {
+        gatt_bench_finish();
+      }
+      if (evt->data.evt_le_connection_closed.connection == cccd_connection) {
+        cccd_connection = NO_CONNECTION;
+        cccd_flags = 0;
+      }
+      break;
+
+    case gecko_evt_hardware_soft_timer_id:
+      if (evt->data.evt_hardware_soft_timer.handle == GATT_BENCH_PUMP_TIMER_HANDLE) {
+        gatt_bench_send();
+        return true;
+      }
+      if (evt->data.evt_hardware_soft_timer.handle == GATT_BENCH_END_TIMER_HANDLE) {
+        gatt_bench_finish();
+        return true;
+      }
+      break;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+/**
+ * Handle a Benchmark Control write, returns the ATT error code
+ */
+static uint8_t gatt_bench_control(uint8_t conn, const uint8_t *data, uint8_t len)
+{
+  gatt_bench_mode_t new_mode;
+
+  if (len != GATT_BENCH_CONTROL_LEN) {
+    return bg_err_att_invalid_att_length & 0xff;
+  }
+  new_mode = (gatt_bench_mode_t)data[0];
+  if (new_mode == gatt_bench_mode_stop) {
+    if (mode != gatt_bench_mode_stop && conn == connection) {
+      gatt_bench_finish();
+    }
+    return 0;
+  }
+  if (mode != gatt_bench_mode_stop) {
+    return GATT_BENCH_ERR_BUSY;
+  }
+  if (new_mode > gatt_bench_mode_write_no_response) {
+    return GATT_BENCH_ERR_MODE;
+  }
+  // a zero timeout would stop the end timer, the run would never end
+  if ((data[3] | (data[4] << 8)) == 0) {
+    return GATT_BENCH_ERR_DURATION;
+  }
+  if ((new_mode == gatt_bench_mode_notify
+       && (conn != cccd_connection || cccd_flags != gatt_notification))
+      || (new_mode == gatt_bench_mode_indicate
+          && (conn != cccd_connection || cccd_flags != gatt_indication))) {
+    return GATT_BENCH_ERR_CCCD;
+  }
+  gatt_bench_start(conn, new_mode, data[1] | (data[2] << 8), data[3] | (data[4] << 8));
+  return 0;
+}
+
+static void gatt_bench_start(uint8_t conn, gatt_bench_mode_t new_mode,
+                             uint16_t len, uint16_t duration)
+{
+  mode = new_mode;
+  connection = conn;
+  payload_len = len;
+  if (mode == gatt_bench_mode_notify || mode == gatt_bench_mode_indicate) {
+    if (payload_len > mtu_mgr_max_payload(conn)) {
+      payload_len = mtu_mgr_max_payload(conn);
+    }
+    if (payload_len > sizeof(payload)) {
+      payload_len = sizeof(payload);
+    }
+    if (payload_len < MIN_PAYLOAD) {
+      payload_len = MIN_PAYLOAD;
+    }
+    for (uint16_t i = MIN_PAYLOAD; i < payload_len; i++) {
+      payload[i] = (uint8_t)i;
+    }
+  }
+  packets = 0;
+  bytes = 0;
+  jitter_sum = 0;
+  min_gap = UINT32_MAX;
+  max_gap = 0;
+  confirm_pending = false;
+
+  gecko_cmd_hardware_set_soft_timer((uint32_t)duration * TICK_HZ,
+                                    GATT_BENCH_END_TIMER_HANDLE, 1);
+  // an indication refused for lack of buffers is retried by the pump too
+  if (mode == gatt_bench_mode_notify || mode == gatt_bench_mode_indicate) {
+    gecko_cmd_hardware_set_soft_timer(GATT_BENCH_PUMP_MS * TICK_HZ / 1000,
+                                      GATT_BENCH_PUMP_TIMER_HANDLE, 0);
+  }
+  gatt_bench_send();
+}
+
+/**
+ * Stop the run and publish its result
+ */
+static void gatt_bench_finish(void)
+{
+  uint32_t span_us = (packets > 1) ? TICKS_TO_US(last_tick - first_tick) : 0;
+  uint8_t *p = result;
+
+  gecko_cmd_hardware_set_soft_timer(0, GATT_BENCH_PUMP_TIMER_HANDLE, 0);
+  gecko_cmd_hardware_set_soft_timer(0, GATT_BENCH_END_TIMER_HANDLE, 0);
+
+  *p++ = mode;
+  *p++ = link_mgr_phy();
+  p = put_u16(p, payload_len);
+  p = put_u16(p, mtu_mgr_mtu(connection));
+  p = put_u16(p, (params_connection == connection) ? params_interval : 0);
+  p = put_u32(p, span_us / 1000);
+  p = put_u32(p, packets);
+  p = put_u32(p, bytes);
+  // the first packet only marks the start of the span
+  p = put_u32(p, span_us ? (uint32_t)((uint64_t)(bytes - first_len) * 8 * 1000000 / span_us) : 0);
+  p = put_u32(p, (packets > 1) ? TICKS_TO_US(min_gap) : 0);
+  p = put_u32(p, TICKS_TO_US(max_gap));
+  put_u32(p, (packets > 2) ? TICKS_TO_US(jitter_sum / (packets - 2)) : 0);
+
+  mode = gatt_bench_mode_stop;
+  // notify the clients which enabled it, errors are of no consequence
+  gattdb_notify_bench_result(0xff, result, GATT_BENCH_RESULT_LEN);
+  connection = NO_CONNECTION;
+}
+
+/**
+ * Queue notifications until the stack runs out of buffers, or one
+ * indication
+ */
+static void gatt_bench_send(void)
+{
+  uint16_t ret;
+
+  if (mode == gatt_bench_mode_notify) {
+    for (int i = 0; i < GATT_BENCH_BURST; i++) {
+      payload[0] = (uint8_t)packets;
+      payload[1] = (uint8_t)(packets >> 8);
+      payload[2] = (uint8_t)(packets >> 16);
+      payload[3] = (uint8_t)(packets >> 24);
+      ret = gattdb_notify_bench_data(connection, payload, payload_len);
+      if (ret != bg_err_success) {
+        break;
+      }
+      gatt_bench_packet(payload_len);
+    }
+  } else if (mode == gatt_bench_mode_indicate && !confirm_pending) {
+    payload[0] = (uint8_t)packets;
+    payload[1] = (uint8_t)(packets >> 8);
+    payload[2] = (uint8_t)(packets >> 16);
+    payload[3] = (uint8_t)(packets >> 24);
+    ret = gattdb_notify_bench_data(connection, payload, payload_len);
+    confirm_pending = (ret == bg_err_success);
+  }
+}
+
+/**
+ * Account a packet, the gaps between packets give the jitter
+ */
+static void gatt_bench_packet(uint32_t len)
+{
+  uint32_t now = RTCC_CounterGet();
+
+  if (packets == 0) {
+    first_tick = now;
+    first_len = len;
+  } else {
+    uint32_t gap = now - last_tick;
+
+    if (gap < min_gap) {
+      min_gap = gap;
+    }
+    if (gap > max_gap) {
+      max_gap = gap;
+    }
+    if (packets > 1) {
+      jitter_sum += (gap > last_gap) ? gap - last_gap : last_gap - gap;
+    }
+    last_gap = gap;
+  }
+  last_tick = now;
+  packets++;
+  bytes += len;
+  // benchmark traffic in either direction wants the fast parameters
+  conn_ctrl_data_sent(len);
+}
+
+static uint8_t *put_u16(uint8_t *p, uint32_t value)
+{
+  *p++ = (uint8_t)value;
+  *p++ = (uint8_t)(value >> 8);
+  return p;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t value)
+{
+  p = put_u16(p, value);
+  return put_u16(p, value >> 16);
+}
@@ -0,0 +1,110 @@
+/***************************************************************************//**
+ * @file
+ * @brief GATT throughput benchmark service
+ * Runs timed transfers over the Throughput Benchmark service in gatt.xml
+ * and reports the throughput, packet count and inter-packet jitter in the
+ * Benchmark Result characteristic.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef GATT_BENCH_H_
+#define GATT_BENCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "native_gecko.h"
+
+// Soft timer handles, one refills the stack with notifications or retries
+// an indication, the other ends the run
+#ifndef GATT_BENCH_PUMP_TIMER_HANDLE
+#define GATT_BENCH_PUMP_TIMER_HANDLE 3
+#endif
+#ifndef GATT_BENCH_END_TIMER_HANDLE
+#define GATT_BENCH_END_TIMER_HANDLE  4
+#endif
+
+// Period in ms to retry notifications or an indication once the stack is
+// out of buffers
+#ifndef GATT_BENCH_PUMP_MS
+#define GATT_BENCH_PUMP_MS           5
+#endif
+
+// Notifications queued at most per pass, so other events are not starved
+#ifndef GATT_BENCH_BURST
+#define GATT_BENCH_BURST             16
+#endif
+
+/*
+ * Benchmark Control, written by the client to start or stop a run:
+ *   uint8  mode, one of gatt_bench_mode_t
+ *   uint16 payload length, notifications and indications are limited to the
+ *          ATT MTU - 3, at least 4 bytes which carry a sequence number
+ *   uint16 duration in seconds, at least 1
+ * Writing mode gatt_bench_mode_stop ends a run early. The client enables
+ * only the notifications or only the indications of Benchmark Data,
+ * whichever the mode uses. In the write modes the client writes Benchmark
+ * Data for the duration of the run.
+ *
+ * Benchmark Result, read or notified at the end of a run, little endian:
+ *   uint8  mode
+ *   uint8  PHY, see link_mgr_phy()
+ *   uint16 payload length
+ *   uint16 ATT MTU
+ *   uint16 connection interval in 1.25 ms units, 0 if unknown
+ *   uint32 time from the first to the last packet in ms
+ *   uint32 packets
+ *   uint32 payload bytes
+ *   uint32 throughput in bit/s over the time above
+ *   uint32 shortest gap between packets in us
+ *   uint32 longest gap between packets in us
+ *   uint32 jitter in us, mean change of the gap from packet to packet
+ * Times are taken when a notification is queued, an indication confirmed or
+ * a write received, with the 30.5 us resolution of the RTCC.
+ */
+#define GATT_BENCH_CONTROL_LEN       5
+#define GATT_BENCH_RESULT_LEN        36
+
+// Application error codes returned on Benchmark Control writes
+#define GATT_BENCH_ERR_BUSY          0x80
+#define GATT_BENCH_ERR_CCCD          0x81
+#define GATT_BENCH_ERR_MODE          0x82
+#define GATT_BENCH_ERR_DURATION      0x83
+
+typedef enum {
+  gatt_bench_mode_stop,
+  gatt_bench_mode_notify,
+  gatt_bench_mode_indicate,
+  gatt_bench_mode_write,
+  gatt_bench_mode_write_no_response
+} gatt_bench_mode_t;
+
+/***************************************************************************//**
+ * @brief
+ *   Handle a Bluetooth stack event.
+ *
+ * @details
+ *   Pass every event to the benchmark. It serves the requests on its
+ *   characteristics and runs on its own soft timers.
+ *
+ * @param[in] evt
+ *   Event from gecko_wait_event() or gecko_peek_event().
+ *
+ * @return
+ *   True if the event belonged to the benchmark and needs no further
+ *   handling, False otherwise.
+ *
+ ******************************************************************************/
+bool gatt_bench_handle_event(struct gecko_cmd_packet *evt);
+
+#endif /* GATT_BENCH_H_ */
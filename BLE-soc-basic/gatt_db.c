@@ -1,264 +1,374 @@
-// Copyright 2019 Silicon Laboratories, Inc.
-//
-//
-
-/********************************************************************
- * Autogenerated file, do not edit.
- *******************************************************************/
+// Generated by gattdb.py from gatt.xml, do not edit.
 
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "bg_gattdb_def.h"
+#include "gatt_db.h"
 
 #ifdef __GNUC__
-#define GATT_HEADER(F) F __attribute__ ((section (".gatt_header"))) 
-#define GATT_DATA(F) F __attribute__ ((section (".gatt_data"))) 
+#define GATT_HEADER(F) F __attribute__ ((section (".gatt_header")))
+#define GATT_DATA(F) F __attribute__ ((section (".gatt_data")))
+#define GATT_ARENA(F) F __attribute__ ((aligned (4)))
 #else
 #ifdef __ICCARM__
-#define GATT_HEADER(F) _Pragma("location=\".gatt_header\"") F 
-#define GATT_DATA(F) _Pragma("location=\".gatt_data\"") F 
+#define GATT_HEADER(F) _Pragma("location=\".gatt_header\"") F
+#define GATT_DATA(F) _Pragma("location=\".gatt_data\"") F
+#define GATT_ARENA(F) _Pragma("data_alignment=4") F
 #else
-#define GATT_HEADER(F) F 
-#define GATT_DATA(F) F 
+#define GATT_HEADER(F) F
+#define GATT_DATA(F) F
+#define GATT_ARENA(F) F
 #endif
 #endif
 
-GATT_DATA(const uint16_t bg_gattdb_data_uuidtable_16_map [])=
-{
-    0x2800,
-    0x2801,
-    0x2803,
-    0x1800,
-    0x2a00,
-    0x2a01,
-    0x180a,
-    0x2a29,
-    0x2a24,
-    0x2a23,
-    0x1801,
-    0x2a05,
-    0x2b2a,
-    0x2b29,
-    0x2902,
+GATT_DATA(const uint16_t bg_gattdb_data_uuidtable_16_map[]) = {
+  0x2800,
+  0x2801,
+  0x2803,
+  0x1800,
+  0x2a00,
+  0x2a01,
+  0x180a,
+  0x2a29,
+  0x2a24,
+  0x2a23,
+  0x1801,
+  0x2a05,
+  0x2b2a,
+  0x2b29,
+  0x2902,
 };
 
-GATT_DATA(const uint8_t bg_gattdb_data_uuidtable_128_map [])=
-{
-0xf0, 0x19, 0x21, 0xb4, 0x47, 0x8f, 0xa4, 0xbf, 0xa1, 0x4f, 0x63, 0xfd, 0xee, 0xd6, 0x14, 0x1d, 
-0x63, 0x60, 0x32, 0xe0, 0x37, 0x5e, 0xa4, 0x88, 0x53, 0x4e, 0x6d, 0xfb, 0x64, 0x35, 0xbf, 0xf7, 
-0x03, 0xd4, 0xb0, 0xcf, 0xf1, 0xad, 0x50, 0xbf, 0x51, 0x4c, 0x63, 0xfd, 0x9e, 0x88, 0x78, 0x4f, 
-0x9e, 0x53, 0x73, 0x56, 0x10, 0x9b, 0xb8, 0x98, 0x70, 0x49, 0xb6, 0x60, 0x61, 0xd6, 0x9d, 0x54, 
-0x29, 0xad, 0x77, 0xfd, 0xb5, 0xbe, 0xb5, 0xbb, 0x4f, 0x4f, 0x45, 0x83, 0x66, 0xae, 0x42, 0x5f, 
-0x5c, 0xa2, 0xbe, 0x97, 0xc7, 0x92, 0xf4, 0x93, 0x9b, 0x47, 0xb0, 0xde, 0xf3, 0xb6, 0xaf, 0x14, 
+GATT_DATA(const uint8_t bg_gattdb_data_uuidtable_128_map[]) = {
+  0xf0, 0x19, 0x21, 0xb4, 0x47, 0x8f, 0xa4, 0xbf, 0xa1, 0x4f, 0x63, 0xfd, 0xee, 0xd6, 0x14, 0x1d,
+  0x63, 0x60, 0x32, 0xe0, 0x37, 0x5e, 0xa4, 0x88, 0x53, 0x4e, 0x6d, 0xfb, 0x64, 0x35, 0xbf, 0xf7,
+  0x03, 0xd4, 0xb0, 0xcf, 0xf1, 0xad, 0x50, 0xbf, 0x51, 0x4c, 0x63, 0xfd, 0x9e, 0x88, 0x78, 0x4f,
+  0x9e, 0x53, 0x73, 0x56, 0x10, 0x9b, 0xb8, 0x98, 0x70, 0x49, 0xb6, 0x60, 0x61, 0xd6, 0x9d, 0x54,
+  0x29, 0xad, 0x77, 0xfd, 0xb5, 0xbe, 0xb5, 0xbb, 0x4f, 0x4f, 0x45, 0x83, 0x66, 0xae, 0x42, 0x5f,
+  0x5c, 0xa2, 0xbe, 0x97, 0xc7, 0x92, 0xf4, 0x93, 0x9b, 0x47, 0xb0, 0xde, 0xf3, 0xb6, 0xaf, 0x14,
+  0x39, 0x4b, 0x0c, 0xd9, 0xb9, 0x1b, 0x6c, 0x83, 0x29, 0x40, 0xf3, 0xd0, 0x14, 0xaa, 0x76, 0xbc,
+  0xe6, 0xbe, 0xc3, 0x04, 0x68, 0x65, 0x2f, 0xa1, 0x77, 0x44, 0xe2, 0x5d, 0x42, 0x03, 0x93, 0x55,
+  0xa3, 0x2d, 0x0d, 0x3a, 0xf3, 0xe5, 0x27, 0x8f, 0xe3, 0x46, 0xb5, 0x7b, 0xf9, 0xd7, 0x05, 0x3b,
+  0x00, 0x96, 0xef, 0x60, 0x7a, 0x02, 0x6d, 0xae, 0xf8, 0x47, 0xfa, 0xa0, 0xcf, 0x45, 0x47, 0xc6,
 };
 
-
-
-
-uint8_t bg_gattdb_data_attribute_field_29_data[2]={0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_29 ) = {
-	.properties=0x10,
-	.index=7,
-	.max_len=2,
-	.data=bg_gattdb_data_attribute_field_29_data,
+// Values of the dynamic attributes
+GATT_ARENA(static uint8_t bg_gattdb_data_arena_init[29]) = {
+  0xa0, 0x4d, 0xc8, 0xe3, 0x7f, 0x7f, 0x60, 0x1d, 0x38, 0xdc, 0x5b, 0xb0, 0x04, 0xe8, 0xb4, 0xa0,
+  0x53, 0x69, 0x6a, 0x69, 0x6e, 0x20, 0x57, 0x6f, 0x6f, 0x00, 0x00, 0x00, 0x00,
 };
+GATT_ARENA(static uint8_t bg_gattdb_data_arena_zero[11]);
 
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_28 ) = {
-	.len=19,
-	.data={0x10,0x1e,0x00,0x5c,0xa2,0xbe,0x97,0xc7,0x92,0xf4,0x93,0x9b,0x47,0xb0,0xde,0xf3,0xb6,0xaf,0x14,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_0) = {
+  .len = 2,
+  .data = { 0x01, 0x18, }
 };
-uint8_t bg_gattdb_data_attribute_field_27_data[2]={0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_27 ) = {
-	.properties=0x02,
-	.index=6,
-	.max_len=2,
-	.data=bg_gattdb_data_attribute_field_27_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_1) = {
+  .len = 5,
+  .data = { 0x20, 0x03, 0x00, 0x05, 0x2a, }
 };
-
-uint8_t bg_gattdb_data_attribute_field_25_data[2]={0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_25 ) = {
-	.properties=0x12,
-	.index=5,
-	.max_len=2,
-	.data=bg_gattdb_data_attribute_field_25_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_2) = {
+  .len = 5,
+  .data = { 0x02, 0x06, 0x00, 0x2a, 0x2b, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_24 ) = {
-	.len=19,
-	.data={0x12,0x1a,0x00,0x9e,0x53,0x73,0x56,0x10,0x9b,0xb8,0x98,0x70,0x49,0xb6,0x60,0x61,0xd6,0x9d,0x54,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_3) = {
+  .len = 5,
+  .data = { 0x0a, 0x08, 0x00, 0x29, 0x2b, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_23 ) = {
-	.len=16,
-	.data={0x03,0xd4,0xb0,0xcf,0xf1,0xad,0x50,0xbf,0x51,0x4c,0x63,0xfd,0x9e,0x88,0x78,0x4f,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_4) = {
+  .len = 2,
+  .data = { 0x00, 0x18, }
 };
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_22 ) = {
-	.properties=0x08,
-	.index=4,
-	.max_len=0,
-	.data=NULL,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_5) = {
+  .len = 5,
+  .data = { 0x0a, 0x0b, 0x00, 0x00, 0x2a, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_21 ) = {
-	.len=19,
-	.data={0x08,0x17,0x00,0x63,0x60,0x32,0xe0,0x37,0x5e,0xa4,0x88,0x53,0x4e,0x6d,0xfb,0x64,0x35,0xbf,0xf7,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_6) = {
+  .len = 5,
+  .data = { 0x02, 0x0d, 0x00, 0x01, 0x2a, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_20 ) = {
-	.len=16,
-	.data={0xf0,0x19,0x21,0xb4,0x47,0x8f,0xa4,0xbf,0xa1,0x4f,0x63,0xfd,0xee,0xd6,0x14,0x1d,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_7) = {
+  .len = 2,
+  .data = { 0x00, 0x00, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_19 ) = {
-	.len=6,
-	.data={0x00,0x01,0x02,0x03,0x04,0x05,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_8) = {
+  .len = 2,
+  .data = { 0x0a, 0x18, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_18 ) = {
-	.len=5,
-	.data={0x02,0x14,0x00,0x23,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_9) = {
+  .len = 5,
+  .data = { 0x02, 0x10, 0x00, 0x29, 0x2a, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_17 ) = {
-	.len=10,
-	.data={0x42,0x6c,0x75,0x65,0x20,0x47,0x65,0x63,0x6b,0x6f,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_10) = {
+  .len = 12,
+  .data = { 0x53, 0x69, 0x6c, 0x69, 0x63, 0x6f, 0x6e, 0x20, 0x4c, 0x61, 0x62, 0x73, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_16 ) = {
-	.len=5,
-	.data={0x02,0x12,0x00,0x24,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_11) = {
+  .len = 5,
+  .data = { 0x02, 0x12, 0x00, 0x24, 0x2a, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_15 ) = {
-	.len=12,
-	.data={0x53,0x69,0x6c,0x69,0x63,0x6f,0x6e,0x20,0x4c,0x61,0x62,0x73,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_12) = {
+  .len = 10,
+  .data = { 0x42, 0x6c, 0x75, 0x65, 0x20, 0x47, 0x65, 0x63, 0x6b, 0x6f, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_14 ) = {
-	.len=5,
-	.data={0x02,0x10,0x00,0x29,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_13) = {
+  .len = 5,
+  .data = { 0x02, 0x14, 0x00, 0x23, 0x2a, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_13 ) = {
-	.len=2,
-	.data={0x0a,0x18,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_14) = {
+  .len = 6,
+  .data = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_12 ) = {
-	.len=2,
-	.data={0x00,0x00,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_15) = {
+  .len = 16,
+  .data = { 0xf0, 0x19, 0x21, 0xb4, 0x47, 0x8f, 0xa4, 0xbf, 0xa1, 0x4f, 0x63, 0xfd, 0xee, 0xd6, 0x14, 0x1d, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_11 ) = {
-	.len=5,
-	.data={0x02,0x0d,0x00,0x01,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_16) = {
+  .len = 19,
+  .data = { 0x08, 0x17, 0x00, 0x63, 0x60, 0x32, 0xe0, 0x37, 0x5e, 0xa4, 0x88, 0x53, 0x4e, 0x6d, 0xfb, 0x64, 0x35, 0xbf, 0xf7, }
 };
-uint8_t bg_gattdb_data_attribute_field_10_data[13]={0x53,0x69,0x6a,0x69,0x6e,0x20,0x57,0x6f,0x6f,0x00,0x00,0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_10 ) = {
-	.properties=0x0a,
-	.index=3,
-	.max_len=13,
-	.data=bg_gattdb_data_attribute_field_10_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_17) = {
+  .len = 16,
+  .data = { 0x03, 0xd4, 0xb0, 0xcf, 0xf1, 0xad, 0x50, 0xbf, 0x51, 0x4c, 0x63, 0xfd, 0x9e, 0x88, 0x78, 0x4f, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_9 ) = {
-	.len=5,
-	.data={0x0a,0x0b,0x00,0x00,0x2a,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_18) = {
+  .len = 19,
+  .data = { 0x12, 0x1a, 0x00, 0x9e, 0x53, 0x73, 0x56, 0x10, 0x9b, 0xb8, 0x98, 0x70, 0x49, 0xb6, 0x60, 0x61, 0xd6, 0x9d, 0x54, }
 };
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_8 ) = {
-	.len=2,
-	.data={0x00,0x18,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_19) = {
+  .len = 19,
+  .data = { 0x10, 0x1e, 0x00, 0x5c, 0xa2, 0xbe, 0x97, 0xc7, 0x92, 0xf4, 0x93, 0x9b, 0x47, 0xb0, 0xde, 0xf3, 0xb6, 0xaf, 0x14, }
 };
-uint8_t bg_gattdb_data_attribute_field_7_data[1]={0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_7 ) = {
-	.properties=0x0a,
-	.index=2,
-	.max_len=1,
-	.data=bg_gattdb_data_attribute_field_7_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_20) = {
+  .len = 16,
+  .data = { 0x39, 0x4b, 0x0c, 0xd9, 0xb9, 0x1b, 0x6c, 0x83, 0x29, 0x40, 0xf3, 0xd0, 0x14, 0xaa, 0x76, 0xbc, }
 };
-
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_6 ) = {
-	.len=5,
-	.data={0x0a,0x08,0x00,0x29,0x2b,}
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_21) = {
+  .len = 19,
+  .data = { 0x08, 0x22, 0x00, 0xe6, 0xbe, 0xc3, 0x04, 0x68, 0x65, 0x2f, 0xa1, 0x77, 0x44, 0xe2, 0x5d, 0x42, 0x03, 0x93, 0x55, }
+};
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_22) = {
+  .len = 19,
+  .data = { 0x3c, 0x24, 0x00, 0xa3, 0x2d, 0x0d, 0x3a, 0xf3, 0xe5, 0x27, 0x8f, 0xe3, 0x46, 0xb5, 0x7b, 0xf9, 0xd7, 0x05, 0x3b, }
 };
-uint8_t bg_gattdb_data_attribute_field_5_data[16]={0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_5 ) = {
-	.properties=0x02,
-	.index=1,
-	.max_len=16,
-	.data=bg_gattdb_data_attribute_field_5_data,
+GATT_DATA(const struct bg_gattdb_buffer_with_len bg_gattdb_data_const_23) = {
+  .len = 19,
+  .data = { 0x12, 0x27, 0x00, 0x00, 0x96, 0xef, 0x60, 0x7a, 0x02, 0x6d, 0xae, 0xf8, 0x47, 0xfa, 0xa0, 0xcf, 0x45, 0x47, 0xc6, }
 };
 
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_4 ) = {
-	.len=5,
-	.data={0x02,0x06,0x00,0x2a,0x2b,}
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_0) = {
+  .properties = 0x20,
+  .index = 0,
+  .max_len = 4,
+  .data = &bg_gattdb_data_arena_zero[0],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_1) = {
+  .properties = 0x02,
+  .index = 1,
+  .max_len = 16,
+  .data = &bg_gattdb_data_arena_init[0],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_2) = {
+  .properties = 0x0a,
+  .index = 2,
+  .max_len = 1,
+  .data = &bg_gattdb_data_arena_zero[10],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_3) = {
+  .properties = 0x0a,
+  .index = 3,
+  .max_len = 13,
+  .data = &bg_gattdb_data_arena_init[16],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_4) = {
+  .properties = 0x08,
+  .index = 4,
+  .max_len = 0,
+  .data = NULL,
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_5) = {
+  .properties = 0x12,
+  .index = 5,
+  .max_len = 2,
+  .data = &bg_gattdb_data_arena_zero[4],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_6) = {
+  .properties = 0x02,
+  .index = 6,
+  .max_len = 2,
+  .data = &bg_gattdb_data_arena_zero[6],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_7) = {
+  .properties = 0x10,
+  .index = 7,
+  .max_len = 2,
+  .data = &bg_gattdb_data_arena_zero[8],
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_8) = {
+  .properties = 0x08,
+  .index = 8,
+  .max_len = 0,
+  .data = NULL,
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_9) = {
+  .properties = 0x3c,
+  .index = 9,
+  .max_len = 0,
+  .data = NULL,
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue bg_gattdb_data_value_10) = {
+  .properties = 0x12,
+  .index = 10,
+  .max_len = 0,
+  .data = NULL,
 };
-uint8_t bg_gattdb_data_attribute_field_2_data[4]={0x00,0x00,0x00,0x00,};
-GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_2 ) = {
-	.properties=0x20,
-	.index=0,
-	.max_len=4,
-	.data=bg_gattdb_data_attribute_field_2_data,
+
+GATT_DATA(const struct bg_gattdb_attribute bg_gattdb_data_attributes_map[]) = {
+  { .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_0 }, // 1
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_1 }, // 2
+  { .uuid = 0x000b, .permissions = 0x800, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_0 }, // 3
+  { .uuid = 0x000e, .permissions = 0x807, .caps = 0xffff, .datatype = 0x03, .min_key_size = 0x00, .configdata = { .flags = 0x02, .index = 0x00, .clientconfig_index = 0x00 } }, // 4
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_2 }, // 5
+  { .uuid = 0x000c, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_1 }, // 6
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_3 }, // 7
+  { .uuid = 0x000d, .permissions = 0x803, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_2 }, // 8
+  { .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_4 }, // 9
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_5 }, // 10
+  { .uuid = 0x0004, .permissions = 0x803, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_3 }, // 11
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_6 }, // 12
+  { .uuid = 0x0005, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_7 }, // 13
+  { .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_8 }, // 14
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_9 }, // 15
+  { .uuid = 0x0007, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_10 }, // 16
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_11 }, // 17
+  { .uuid = 0x0008, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_12 }, // 18
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_13 }, // 19
+  { .uuid = 0x0009, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_14 }, // 20
+  { .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_15 }, // 21
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_16 }, // 22
+  { .uuid = 0x8001, .permissions = 0x802, .caps = 0xffff, .datatype = 0x07, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_4 }, // 23
+  { .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_17 }, // 24
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_18 }, // 25
+  { .uuid = 0x8003, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_5 }, // 26
+  { .uuid = 0x000e, .permissions = 0x807, .caps = 0xffff, .datatype = 0x03, .min_key_size = 0x00, .configdata = { .flags = 0x01, .index = 0x05, .clientconfig_index = 0x01 } }, // 27
+  { .uuid = 0x8004, .permissions = 0x801, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_6 }, // 28
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_19 }, // 29
+  { .uuid = 0x8005, .permissions = 0x800, .caps = 0xffff, .datatype = 0x01, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_7 }, // 30
+  { .uuid = 0x000e, .permissions = 0x807, .caps = 0xffff, .datatype = 0x03, .min_key_size = 0x00, .configdata = { .flags = 0x01, .index = 0x07, .clientconfig_index = 0x02 } }, // 31
+  { .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_20 }, // 32
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_21 }, // 33
+  { .uuid = 0x8007, .permissions = 0x802, .caps = 0xffff, .datatype = 0x07, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_8 }, // 34
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_22 }, // 35
+  { .uuid = 0x8008, .permissions = 0x806, .caps = 0xffff, .datatype = 0x07, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_9 }, // 36
+  { .uuid = 0x000e, .permissions = 0x807, .caps = 0xffff, .datatype = 0x03, .min_key_size = 0x00, .configdata = { .flags = 0x03, .index = 0x09, .clientconfig_index = 0x03 } }, // 37
+  { .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .datatype = 0x00, .min_key_size = 0x00, .constdata = &bg_gattdb_data_const_23 }, // 38
+  { .uuid = 0x8009, .permissions = 0x801, .caps = 0xffff, .datatype = 0x07, .min_key_size = 0x00, .dynamicdata = &bg_gattdb_data_value_10 }, // 39
+  { .uuid = 0x000e, .permissions = 0x807, .caps = 0xffff, .datatype = 0x03, .min_key_size = 0x00, .configdata = { .flags = 0x01, .index = 0x0a, .clientconfig_index = 0x04 } }, // 40
+};
+
+GATT_DATA(const uint16_t bg_gattdb_data_attributes_dynamic_mapping_map[]) = {
+  0x0003,
+  0x0006,
+  0x0008,
+  0x000b,
+  0x0017,
+  0x001a,
+  0x001c,
+  0x001e,
+  0x0022,
+  0x0024,
+  0x0027,
 };
 
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_1 ) = {
-	.len=5,
-	.data={0x20,0x03,0x00,0x05,0x2a,}
-};
-GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_0 ) = {
-	.len=2,
-	.data={0x01,0x18,}
-};
-GATT_DATA(const struct bg_gattdb_attribute bg_gattdb_data_attributes_map[])={
-    {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_0},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_1},
-    {.uuid=0x000b,.permissions=0x800,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_2},
-    {.uuid=0x000e,.permissions=0x807,.caps=0xffff,.datatype=0x03,.min_key_size=0x00,.configdata={.flags=0x02,.index=0x00,.clientconfig_index=0x00}},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_4},
-    {.uuid=0x000c,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_5},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_6},
-    {.uuid=0x000d,.permissions=0x803,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_7},
-    {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_8},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_9},
-    {.uuid=0x0004,.permissions=0x803,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_10},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_11},
-    {.uuid=0x0005,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_12},
-    {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_13},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_14},
-    {.uuid=0x0007,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_15},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_16},
-    {.uuid=0x0008,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_17},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_18},
-    {.uuid=0x0009,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_19},
-    {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_20},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_21},
-    {.uuid=0x8001,.permissions=0x802,.caps=0xffff,.datatype=0x07,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_22},
-    {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_23},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_24},
-    {.uuid=0x8003,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_25},
-    {.uuid=0x000e,.permissions=0x807,.caps=0xffff,.datatype=0x03,.min_key_size=0x00,.configdata={.flags=0x01,.index=0x05,.clientconfig_index=0x01}},
-    {.uuid=0x8004,.permissions=0x801,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_27},
-    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.min_key_size=0x00,.constdata=&bg_gattdb_data_attribute_field_28},
-    {.uuid=0x8005,.permissions=0x800,.caps=0xffff,.datatype=0x01,.min_key_size=0x00,.dynamicdata=&bg_gattdb_data_attribute_field_29},
-    {.uuid=0x000e,.permissions=0x807,.caps=0xffff,.datatype=0x03,.min_key_size=0x00,.configdata={.flags=0x01,.index=0x07,.clientconfig_index=0x02}},
+GATT_DATA(const uint8_t bg_gattdb_data_adv_uuid16_map[]) = { 0x0 };
+GATT_DATA(const uint8_t bg_gattdb_data_adv_uuid128_map[]) = { 0x03, 0xd4, 0xb0, 0xcf, 0xf1, 0xad, 0x50, 0xbf, 0x51, 0x4c, 0x63, 0xfd, 0x9e, 0x88, 0x78, 0x4f, };
+
+GATT_HEADER(const struct bg_gattdb_def bg_gattdb_data) = {
+  .attributes = bg_gattdb_data_attributes_map,
+  .attributes_max = 40,
+  .uuidtable_16_size = 15,
+  .uuidtable_16 = bg_gattdb_data_uuidtable_16_map,
+  .uuidtable_128_size = 10,
+  .uuidtable_128 = bg_gattdb_data_uuidtable_128_map,
+  .attributes_dynamic_max = 11,
+  .attributes_dynamic_mapping = bg_gattdb_data_attributes_dynamic_mapping_map,
+  .adv_uuid16 = bg_gattdb_data_adv_uuid16_map,
+  .adv_uuid16_num = 0,
+  .adv_uuid128 = bg_gattdb_data_adv_uuid128_map,
+  .adv_uuid128_num = 1,
+  .caps_mask = 0xffff,
+  .enabled_caps = 0xffff,
 };
 
-GATT_DATA(const uint16_t bg_gattdb_data_attributes_dynamic_mapping_map[])={
-	0x0003,
-	0x0006,
-	0x0008,
-	0x000b,
-	0x0017,
-	0x001a,
-	0x001c,
-	0x001e,
+const struct bg_gattdb_def *bg_gattdb = &bg_gattdb_data;
+
+const uint8_t gattdb_database_hash_value[16] = {
+  0xa0, 0x4d, 0xc8, 0xe3, 0x7f, 0x7f, 0x60, 0x1d, 0x38, 0xdc, 0x5b, 0xb0, 0x04, 0xe8, 0xb4, 0xa0,
 };
 
-GATT_DATA(const uint8_t bg_gattdb_data_adv_uuid16_map[])={0x0};
-GATT_DATA(const uint8_t bg_gattdb_data_adv_uuid128_map[])={0x03, 0xd4, 0xb0, 0xcf, 0xf1, 0xad, 0x50, 0xbf, 0x51, 0x4c, 0x63, 0xfd, 0x9e, 0x88, 0x78, 0x4f, };
-GATT_HEADER(const struct bg_gattdb_def bg_gattdb_data)={
-    .attributes=bg_gattdb_data_attributes_map,
-    .attributes_max=31,
-    .uuidtable_16_size=15,
-    .uuidtable_16=bg_gattdb_data_uuidtable_16_map,
-    .uuidtable_128_size=6,
-    .uuidtable_128=bg_gattdb_data_uuidtable_128_map,
-    .attributes_dynamic_max=8,
-    .attributes_dynamic_mapping=bg_gattdb_data_attributes_dynamic_mapping_map,
-    .adv_uuid16=bg_gattdb_data_adv_uuid16_map,
-    .adv_uuid16_num=0,
-    .adv_uuid128=bg_gattdb_data_adv_uuid128_map,
-    .adv_uuid128_num=1,
-    .caps_mask=0xffff,
-    .enabled_caps=0xffff,
+// UUID and handle, sorted by UUID
+static const uint16_t gattdb_uuid16_index[][2] = {
+  { 0x1800, 9 },
+  { 0x1801, 1 },
+  { 0x180a, 14 },
+  { 0x2a00, 11 },
+  { 0x2a01, 13 },
+  { 0x2a05, 3 },
+  { 0x2a23, 20 },
+  { 0x2a24, 18 },
+  { 0x2a29, 16 },
+  { 0x2b29, 8 },
+  { 0x2b2a, 6 },
 };
 
-const struct bg_gattdb_def *bg_gattdb=&bg_gattdb_data;
+uint16_t gattdb_find_uuid16(uint16_t uuid)
+{
+  uint16_t low = 0;
+  uint16_t high = 11;
+
+  while (low < high) {
+    uint16_t mid = (low + high) / 2;
+
+    if (gattdb_uuid16_index[mid][0] == uuid) {
+      return gattdb_uuid16_index[mid][1];
+    } else if (gattdb_uuid16_index[mid][0] < uuid) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return 0;
+}
+
+uint16_t gattdb_find_uuid128(const uint8_t *uuid)
+{
+  // Index in the UUID table and handle, by the hash of the UUID
+  static const uint16_t slots[16][2] = {
+    { 7, 34 },
+    { 4, 28 },
+    { 0, 0 },
+    { 0, 0 },
+    { 8, 36 },
+    { 5, 30 },
+    { 0, 0 },
+    { 0, 0 },
+    { 9, 39 },
+    { 6, 32 },
+    { 0, 21 },
+    { 0, 0 },
+    { 3, 26 },
+    { 2, 24 },
+    { 1, 23 },
+    { 0, 0 },
+  };
+  uint32_t key = (uuid[0] | (uuid[1] << 8) | (uuid[2] << 16) | ((uint32_t)uuid[3] << 24))
+                 ^ (uuid[12] | (uuid[13] << 8) | (uuid[14] << 16) | ((uint32_t)uuid[15] << 24));
+  const uint16_t *slot = slots[(uint32_t)(key * 0x8a5d71cdUL) >> 28];
+
+  if (slot[1] != 0
+      && memcmp(&bg_gattdb_data_uuidtable_128_map[16 * slot[0]], uuid, 16) == 0) {
+    return slot[1];
+  }
+  return 0;
+}
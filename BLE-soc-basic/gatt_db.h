@@ -1,10 +1,4 @@
-// Copyright 2019 Silicon Laboratories, Inc.
-//
-//
-
-/********************************************************************
- * Autogenerated file, do not edit.
- *******************************************************************/
+// Generated by gattdb.py from gatt.xml, do not edit.
 
 #ifndef __GATT_DB_H
 #define __GATT_DB_H
@@ -13,13 +7,25 @@
 
 extern const struct bg_gattdb_def bg_gattdb_data;
 
-#define gattdb_service_changed_char             3
-#define gattdb_database_hash                    6
-#define gattdb_client_support_features          8
-#define gattdb_device_name                     11
-#define gattdb_ota_control                     23
-#define gattdb_board_voltage                   26
-#define gattdb_voltage_descriptor              28
-#define gattdb_board_voltage_notification         30
+// Database Hash, also the initial value of gattdb_database_hash
+extern const uint8_t gattdb_database_hash_value[16];
+
+// Handle of a service declaration, characteristic value or descriptor by
+// its UUID, 0 if there is none. The first one if the UUID is used twice.
+uint16_t gattdb_find_uuid16(uint16_t uuid);
+// uuid is 16 bytes, little endian
+uint16_t gattdb_find_uuid128(const uint8_t *uuid);
+
+#define gattdb_service_changed_char       3
+#define gattdb_database_hash              6
+#define gattdb_client_support_features    8
+#define gattdb_device_name                11
+#define gattdb_ota_control                23
+#define gattdb_board_voltage              26
+#define gattdb_voltage_descriptor         28
+#define gattdb_board_voltage_notification 30
+#define gattdb_bench_control              34
+#define gattdb_bench_data                 36
+#define gattdb_bench_result               39
 
 #endif
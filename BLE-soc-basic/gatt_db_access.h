@@ -0,0 +1,66 @@
+// Generated by gattdb.py from gatt.xml, do not edit.
+
+#ifndef __GATT_DB_ACCESS_H
+#define __GATT_DB_ACCESS_H
+
+#include <stdint.h>
+#include "native_gecko.h"
+#include "gatt_db.h"
+
+// Device Name, up to 13 bytes
+static inline uint16_t gattdb_write_device_name(const uint8_t *value, uint8_t len)
+{
+  return gecko_cmd_gatt_server_write_attribute_value(gattdb_device_name, 0, len, value)->result;
+}
+
+// BoardVoltage, 2 bytes
+static inline uint16_t gattdb_write_board_voltage(uint16_t value)
+{
+  const uint8_t data[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+
+  return gecko_cmd_gatt_server_write_attribute_value(gattdb_board_voltage, 0, 2, data)->result;
+}
+
+static inline uint16_t gattdb_notify_board_voltage(uint8_t connection, uint16_t value)
+{
+  const uint8_t data[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+
+  return gecko_cmd_gatt_server_send_characteristic_notification(connection, gattdb_board_voltage, 2, data)->result;
+}
+
+// VoltageDescriptor, 2 bytes
+static inline uint16_t gattdb_write_voltage_descriptor(uint16_t value)
+{
+  const uint8_t data[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+
+  return gecko_cmd_gatt_server_write_attribute_value(gattdb_voltage_descriptor, 0, 2, data)->result;
+}
+
+// BoardVoltageNotification, 2 bytes
+static inline uint16_t gattdb_write_board_voltage_notification(uint16_t value)
+{
+  const uint8_t data[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+
+  return gecko_cmd_gatt_server_write_attribute_value(gattdb_board_voltage_notification, 0, 2, data)->result;
+}
+
+static inline uint16_t gattdb_notify_board_voltage_notification(uint8_t connection, uint16_t value)
+{
+  const uint8_t data[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+
+  return gecko_cmd_gatt_server_send_characteristic_notification(connection, gattdb_board_voltage_notification, 2, data)->result;
+}
+
+// Benchmark Data, up to 244 bytes
+static inline uint16_t gattdb_notify_bench_data(uint8_t connection, const uint8_t *value, uint8_t len)
+{
+  return gecko_cmd_gatt_server_send_characteristic_notification(connection, gattdb_bench_data, len, value)->result;
+}
+
+// Benchmark Result, up to 36 bytes
+static inline uint16_t gattdb_notify_bench_result(uint8_t connection, const uint8_t *value, uint8_t len)
+{
+  return gecko_cmd_gatt_server_send_characteristic_notification(connection, gattdb_bench_result, len, value)->result;
+}
+
+#endif
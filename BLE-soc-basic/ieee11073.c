@@ -0,0 +1,193 @@
+/***************************************************************************//**
+ * @file
+ * @brief IEEE 11073-20601 SFLOAT and FLOAT encoding
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include "ieee11073.h"
+
+// Powers of ten up to the largest one in 32 bits
+static const uint32_t pow10[10] = {
+  1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL,
+  1000000000UL
+};
+
+// Mantissa values of the special values, whatever the exponent
+#define SFLOAT_RESERVED    0x0801
+#define FLOAT_RESERVED     0x00800001UL
+
+static int normalize(int32_t value, int32_t exponent, uint32_t mantissa_max,
+                     int32_t exponent_min, int32_t exponent_max,
+                     int32_t *mantissa, int32_t *mantissa_exponent);
+static uint32_t round_div(uint32_t magnitude, uint32_t digits);
+static bool scale(int32_t mantissa, int32_t digits, int32_t *value);
+
+uint16_t ieee11073_sfloat_encode(int32_t value, int8_t exponent)
+{
+  int32_t m;
+  int32_t e;
+  int overflow = normalize(value, exponent, IEEE11073_SFLOAT_MANTISSA_MAX,
+                           IEEE11073_SFLOAT_EXPONENT_MIN, IEEE11073_SFLOAT_EXPONENT_MAX, &m, &e);
+
+  if (overflow) {
+    return (overflow > 0) ? IEEE11073_SFLOAT_POSITIVE_INF : IEEE11073_SFLOAT_NEGATIVE_INF;
+  }
+  return IEEE11073_SFLOAT(m, e);
+}
+
+uint32_t ieee11073_float_encode(int32_t value, int8_t exponent)
+{
+  int32_t m;
+  int32_t e;
+  int overflow = normalize(value, exponent, IEEE11073_FLOAT_MANTISSA_MAX,
+                           IEEE11073_FLOAT_EXPONENT_MIN, IEEE11073_FLOAT_EXPONENT_MAX, &m, &e);
+
+  if (overflow) {
+    return (overflow > 0) ? IEEE11073_FLOAT_POSITIVE_INF : IEEE11073_FLOAT_NEGATIVE_INF;
+  }
+  return IEEE11073_FLOAT(m, e);
+}
+
+uint8_t *ieee11073_sfloat_encode_array(uint8_t *out, const int32_t *values, int8_t exponent,
+                                       uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++) {
+    uint16_t sfloat = ieee11073_sfloat_encode(values[i], exponent);
+
+    *out++ = (uint8_t)sfloat;
+    *out++ = (uint8_t)(sfloat >> 8);
+  }
+  return out;
+}
+
+uint8_t *ieee11073_float_encode_array(uint8_t *out, const int32_t *values, int8_t exponent,
+                                      uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t ieee_float = ieee11073_float_encode(values[i], exponent);
+
+    *out++ = (uint8_t)ieee_float;
+    *out++ = (uint8_t)(ieee_float >> 8);
+    *out++ = (uint8_t)(ieee_float >> 16);
+    *out++ = (uint8_t)(ieee_float >> 24);
+  }
+  return out;
+}
+
+bool ieee11073_sfloat_decode(uint16_t sfloat, int8_t exponent, int32_t *value)
+{
+  uint16_t raw = sfloat & 0x0fffU;
+  // sign extend the 12-bit mantissa and the 4-bit exponent
+  int32_t m = (int32_t)(raw ^ 0x0800U) - 0x0800;
+  int32_t e = (int32_t)((sfloat >> 12) ^ 0x8U) - 0x8;
+
+  if (raw == IEEE11073_SFLOAT_NAN || raw == IEEE11073_SFLOAT_NRES
+      || raw == IEEE11073_SFLOAT_POSITIVE_INF || raw == IEEE11073_SFLOAT_NEGATIVE_INF
+      || raw == SFLOAT_RESERVED) {
+    return false;
+  }
+  return scale(m, e - exponent, value);
+}
+
+bool ieee11073_float_decode(uint32_t ieee_float, int8_t exponent, int32_t *value)
+{
+  uint32_t raw = ieee_float & 0x00ffffffUL;
+  int32_t m = (int32_t)(raw ^ 0x00800000UL) - 0x00800000L;
+  int32_t e = (int8_t)(ieee_float >> 24);
+
+  if (raw == IEEE11073_FLOAT_NAN || raw == IEEE11073_FLOAT_NRES
+      || raw == IEEE11073_FLOAT_POSITIVE_INF || raw == IEEE11073_FLOAT_NEGATIVE_INF
+      || raw == FLOAT_RESERVED) {
+    return false;
+  }
+  return scale(m, e - exponent, value);
+}
+
+/**
+ * Find the mantissa and exponent of a value, returns 0, or 1 or -1 if the
+ * value is too large in the positive or negative direction
+ */
+static int normalize(int32_t value, int32_t exponent, uint32_t mantissa_max,
+                     int32_t exponent_min, int32_t exponent_max,
+                     int32_t *mantissa, int32_t *mantissa_exponent)
+{
+  bool negative = (value < 0);
+  uint32_t magnitude = negative ? 0UL - (uint32_t)value : (uint32_t)value;
+  uint32_t digits = 0;
+
+  // drop the fewest digits which make the rounded mantissa fit, and the
+  // exponent reach its minimum
+  while (round_div(magnitude, digits) > mantissa_max) {
+    digits++;
+  }
+  if (exponent + (int32_t)digits < exponent_min) {
+    digits = (uint32_t)(exponent_min - exponent);
+  }
+  magnitude = (digits < 10) ? round_div(magnitude, digits) : 0;
+  exponent += (int32_t)digits;
+  if (magnitude == 0) {
+    *mantissa = 0;
+    *mantissa_exponent = 0;
+    return 0;
+  }
+  // an exponent above the maximum can still fit with a larger mantissa
+  while (exponent > exponent_max && magnitude <= mantissa_max / 10) {
+    magnitude *= 10;
+    exponent--;
+  }
+  if (exponent > exponent_max) {
+    return negative ? -1 : 1;
+  }
+  *mantissa = negative ? -(int32_t)magnitude : (int32_t)magnitude;
+  *mantissa_exponent = exponent;
+  return 0;
+}
+
+/**
+ * Divide by 10^digits rounding half up, digits below 10
+ */
+static uint32_t round_div(uint32_t magnitude, uint32_t digits)
+{
+  uint32_t divisor = pow10[digits];
+
+  return (digits == 0) ? magnitude : magnitude / divisor + ((magnitude % divisor) >= divisor / 2);
+}
+
+/**
+ * Multiply a mantissa by 10^digits, or divide for negative digits rounding
+ * half away from zero, False if the result is out of range
+ */
+static bool scale(int32_t mantissa, int32_t digits, int32_t *value)
+{
+  uint32_t magnitude = (mantissa < 0) ? 0UL - (uint32_t)mantissa : (uint32_t)mantissa;
+  uint64_t result;
+
+  if (magnitude == 0) {
+    *value = 0;
+    return true;
+  }
+  if (digits >= 0) {
+    if (digits >= 10) {
+      return false;
+    }
+    result = (uint64_t)magnitude * pow10[digits];
+    if (result > ((mantissa < 0) ? 0x80000000ULL : 0x7fffffffULL)) {
+      return false;
+    }
+  } else {
+    result = (-digits < 10) ? round_div(magnitude, (uint32_t)-digits) : 0;
+  }
+  *value = (mantissa < 0) ? (int32_t)(0UL - (uint32_t)result) : (int32_t)result;
+  return true;
+}
@@ -0,0 +1,186 @@
+/***************************************************************************//**
+ * @file
+ * @brief IEEE 11073-20601 SFLOAT and FLOAT encoding
+ * Converts fixed point values, an integer and a decimal exponent, to and from
+ * the 16-bit SFLOAT and 32-bit FLOAT formats of the health profiles, with
+ * integer arithmetic only.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef IEEE11073_H_
+#define IEEE11073_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// SFLOAT: 12-bit mantissa, 4-bit exponent, value = mantissa * 10^exponent
+#define IEEE11073_SFLOAT_MANTISSA_MAX    2045
+#define IEEE11073_SFLOAT_EXPONENT_MIN    (-8)
+#define IEEE11073_SFLOAT_EXPONENT_MAX    7
+
+#define IEEE11073_SFLOAT_NAN             0x07ff
+#define IEEE11073_SFLOAT_NRES            0x0800
+#define IEEE11073_SFLOAT_POSITIVE_INF    0x07fe
+#define IEEE11073_SFLOAT_NEGATIVE_INF    0x0802
+
+// FLOAT: 24-bit mantissa, 8-bit exponent
+#define IEEE11073_FLOAT_MANTISSA_MAX     8388605
+#define IEEE11073_FLOAT_EXPONENT_MIN     (-128)
+#define IEEE11073_FLOAT_EXPONENT_MAX     127
+
+#define IEEE11073_FLOAT_NAN              0x007fffffUL
+#define IEEE11073_FLOAT_NRES             0x00800000UL
+#define IEEE11073_FLOAT_POSITIVE_INF     0x007ffffeUL
+#define IEEE11073_FLOAT_NEGATIVE_INF     0x00800002UL
+
+// Pack a mantissa and an exponent already in range, a constant expression
+// for constant arguments, so fixed values cost nothing at runtime
+#define IEEE11073_SFLOAT(m, e)  ((uint16_t)((((uint16_t)(e) & 0x000fU) << 12) \
+                                            | ((uint16_t)(m) & 0x0fffU)))
+#define IEEE11073_FLOAT(m, e)   (((uint32_t)(m) & 0x00ffffffUL) | ((uint32_t)(e) << 24))
+
+/***************************************************************************//**
+ * @brief
+ *   Encode a fixed point value as SFLOAT.
+ *
+ * @details
+ *   The value is value * 10^exponent. A mantissa too large for 12 bits is
+ *   divided by the smallest power of ten that fits it, rounded half away
+ *   from zero, so at most the digits SFLOAT cannot hold are lost. Values
+ *   above the range become +INF or -INF, values below it 0.
+ *
+ * @param[in] value
+ *   Fixed point value.
+ *
+ * @param[in] exponent
+ *   Decimal exponent of the value, e.g. -3 for a value in milli units.
+ *
+ * @return
+ *   SFLOAT value.
+ *
+ ******************************************************************************/
+uint16_t ieee11073_sfloat_encode(int32_t value, int8_t exponent);
+
+/***************************************************************************//**
+ * @brief
+ *   Encode a fixed point value as FLOAT.
+ *
+ * @details
+ *   Same rules as ieee11073_sfloat_encode() with a 24-bit mantissa.
+ *
+ * @param[in] value
+ *   Fixed point value.
+ *
+ * @param[in] exponent
+ *   Decimal exponent of the value.
+ *
+ * @return
+ *   FLOAT value.
+ *
+ ******************************************************************************/
+uint32_t ieee11073_float_encode(int32_t value, int8_t exponent);
+
+/***************************************************************************//**
+ * @brief
+ *   Encode values with the same exponent as SFLOAT, little endian.
+ *
+ * @param[out] out
+ *   Buffer of 2 * count bytes.
+ *
+ * @param[in] values
+ *   Fixed point values.
+ *
+ * @param[in] exponent
+ *   Decimal exponent of all the values.
+ *
+ * @param[in] count
+ *   Number of values.
+ *
+ * @return
+ *   Position after the last value written.
+ *
+ ******************************************************************************/
+uint8_t *ieee11073_sfloat_encode_array(uint8_t *out, const int32_t *values, int8_t exponent,
+                                       uint32_t count);
+
+/***************************************************************************//**
+ * @brief
+ *   Encode values with the same exponent as FLOAT, little endian.
+ *
+ * @param[out] out
+ *   Buffer of 4 * count bytes.
+ *
+ * @param[in] values
+ *   Fixed point values.
+ *
+ * @param[in] exponent
+ *   Decimal exponent of all the values.
+ *
+ * @param[in] count
+ *   Number of values.
+ *
+ * @return
+ *   Position after the last value written.
+ *
+ ******************************************************************************/
+uint8_t *ieee11073_float_encode_array(uint8_t *out, const int32_t *values, int8_t exponent,
+                                      uint32_t count);
+
+/***************************************************************************//**
+ * @brief
+ *   Decode an SFLOAT into a fixed point value.
+ *
+ * @details
+ *   The mantissa is scaled to the requested exponent, rounded half away from
+ *   zero when the exponent is larger than the one of the SFLOAT.
+ *
+ * @param[in] sfloat
+ *   SFLOAT value.
+ *
+ * @param[in] exponent
+ *   Decimal exponent of the result.
+ *
+ * @param[out] value
+ *   Fixed point value.
+ *
+ * @return
+ *   True if decoded, False for NaN, NRes, infinity, the reserved value or a
+ *   result out of the int32_t range.
+ *
+ ******************************************************************************/
+bool ieee11073_sfloat_decode(uint16_t sfloat, int8_t exponent, int32_t *value);
+
+/***************************************************************************//**
+ * @brief
+ *   Decode a FLOAT into a fixed point value.
+ *
+ * @details
+ *   Same rules as ieee11073_sfloat_decode().
+ *
+ * @param[in] ieee_float
+ *   FLOAT value.
+ *
+ * @param[in] exponent
+ *   Decimal exponent of the result.
+ *
+ * @param[out] value
+ *   Fixed point value.
+ *
+ * @return
+ *   True if decoded, False for special values or a result out of range.
+ *
+ ******************************************************************************/
+bool ieee11073_float_decode(uint32_t ieee_float, int8_t exponent, int32_t *value);
+
+#endif /* IEEE11073_H_ */
@@ -0,0 +1,182 @@
+/***************************************************************************//**
+ * @file
+ * @brief PHY link manager
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include "conn_ctrl.h"
+#include "link_mgr.h"
+
+#define NO_CONNECTION      0xff
+
+// Soft timer ticks at 32768 Hz
+#define PERIOD_TICKS       ((uint32_t)LINK_MGR_PERIOD_MS * 32768 / 1000)
+
+// RSSI is smoothed in 1/4 dBm
+#define RSSI_SCALE         4
+
+static uint8_t connection = NO_CONNECTION;
+static uint8_t phy = le_gap_phy_1m;
+// PHYs the peer did not switch to, not requested again on this connection
+static uint8_t unsupported = 0;
+// PHY requested, 0 if no request is pending
+static uint8_t requested = 0;
+static int16_t rssi = 0;
+static bool rssi_valid = false;
+static uint8_t tx_failures = 0;
+// Periods left before the next switch, or before a pending request is
+// given up
+static uint8_t hold = 0;
+static uint32_t switches = 0;
+
+static void link_mgr_period_end(void);
+static void link_mgr_request(uint8_t new_phy);
+
+bool link_mgr_handle_event(struct gecko_cmd_packet *evt)
+{
+  switch (BGLIB_MSG_ID(evt->header)) {
+    case gecko_evt_le_connection_opened_id:
+      connection = evt->data.evt_le_connection_opened.connection;
+      phy = le_gap_phy_1m;
+      unsupported = 0;
+      requested = 0;
+      rssi_valid = false;
+      tx_failures = 0;
+      hold = 0;
+      switches = 0;
+      gecko_cmd_hardware_set_soft_timer(PERIOD_TICKS, LINK_MGR_TIMER_HANDLE, 0);
+      break;
+
+    case gecko_evt_le_connection_rssi_id:
+      if (evt->data.evt_le_connection_rssi.connection == connection
+          && evt->data.evt_le_connection_rssi.status == 0) {
+        int16_t sample = evt->data.evt_le_connection_rssi.rssi * RSSI_SCALE;
+        // exponential average over about 4 samples
+        rssi = rssi_valid ? rssi + (sample - rssi) / 4 : sample;
+        rssi_valid = true;
+      }
+      break;
+
+    case gecko_evt_le_connection_phy_status_id:
+      if (evt->data.evt_le_connection_phy_status.connection == connection) {
+        if (evt->data.evt_le_connection_phy_status.phy != phy) {
+          phy = evt->data.evt_le_connection_phy_status.phy;
+          switches++;
+        }
+        if (requested) {
+          // a peer answering with another PHY does not support the one asked
+          if (evt->data.evt_le_connection_phy_status.phy != requested) {
+            unsupported |= requested;
+          }
+          requested = 0;
+          hold = LINK_MGR_HOLD_PERIODS;
+        }
+      }
+      break;
+
+    case gecko_evt_le_connection_closed_id:
+      if (evt->data.evt_le_connection_closed.connection == connection) {
+        connection = NO_CONNECTION;
+        gecko_cmd_hardware_set_soft_timer(0, LINK_MGR_TIMER_HANDLE, 0);
+      }
+      break;
+
+    case gecko_evt_hardware_soft_timer_id:
+      if (evt->data.evt_hardware_soft_timer.handle == LINK_MGR_TIMER_HANDLE) {
+        link_mgr_period_end();
+        return true;
+      }
+      break;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+void link_mgr_tx_failed(void)
+{
+  if (tx_failures < 0xff) {
+    tx_failures++;
+  }
+}
+
+uint8_t link_mgr_phy(void)
+{
+  return phy;
+}
+
+uint32_t link_mgr_switches(void)
+{
+  return switches;
+}
+
+/**
+ * Choose the PHY for the last period and ask for the next RSSI sample
+ */
+static void link_mgr_period_end(void)
+{
+  bool lossy = (tx_failures >= LINK_MGR_LOSS_LIMIT);
+  uint8_t target = phy;
+
+  tx_failures = 0;
+  gecko_cmd_le_connection_get_rssi(connection);
+
+  if (hold > 0) {
+    hold--;
+    if (hold > 0 || !requested) {
+      return;
+    }
+    // the peer kept the PHY without a status event, do not ask again
+    unsupported |= requested;
+    requested = 0;
+  }
+  if (!rssi_valid || requested) {
+    return;
+  }
+
+  switch (phy) {
+    case le_gap_phy_2m:
+      if (lossy || rssi < (LINK_MGR_2M_RSSI - LINK_MGR_HYSTERESIS) * RSSI_SCALE) {
+        target = le_gap_phy_1m;
+      }
+      break;
+
+    case le_gap_phy_coded:
+      if (!lossy && rssi >= (LINK_MGR_CODED_RSSI + LINK_MGR_HYSTERESIS) * RSSI_SCALE) {
+        target = le_gap_phy_1m;
+      }
+      break;
+
+    default:
+      if (lossy || rssi < LINK_MGR_CODED_RSSI * RSSI_SCALE) {
+        target = le_gap_phy_coded;
+      } else if (rssi >= LINK_MGR_2M_RSSI * RSSI_SCALE
+                 && conn_ctrl_mode() == conn_ctrl_mode_burst) {
+        target = le_gap_phy_2m;
+      }
+      break;
+  }
+  if (target != phy && !(unsupported & target)) {
+    link_mgr_request(target);
+  }
+}
+
+static void link_mgr_request(uint8_t new_phy)
+{
+  if (gecko_cmd_le_connection_set_phy(connection, new_phy)->result == bg_err_success) {
+    requested = new_phy;
+    hold = LINK_MGR_HOLD_PERIODS;
+  }
+}
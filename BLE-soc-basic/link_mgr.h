@@ -0,0 +1,116 @@
+/***************************************************************************//**
+ * @file
+ * @brief PHY link manager
+ * Moves the connection to the 2M PHY when the link is strong and the
+ * application has data to send, and to 1M or the Coded PHY when the signal
+ * weakens or transmissions start to back up.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef LINK_MGR_H_
+#define LINK_MGR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "native_gecko.h"
+
+// Soft timer handle used for the RSSI polling
+#ifndef LINK_MGR_TIMER_HANDLE
+#define LINK_MGR_TIMER_HANDLE        2
+#endif
+
+// RSSI polling period in ms
+#ifndef LINK_MGR_PERIOD_MS
+#define LINK_MGR_PERIOD_MS           1000
+#endif
+
+// Smoothed RSSI in dBm from which 2M is requested while data is pending
+#ifndef LINK_MGR_2M_RSSI
+#define LINK_MGR_2M_RSSI             -65
+#endif
+
+// Smoothed RSSI in dBm below which the Coded PHY is requested
+#ifndef LINK_MGR_CODED_RSSI
+#define LINK_MGR_CODED_RSSI          -90
+#endif
+
+// Margin in dB the RSSI has to cross back before a threshold applies again
+#ifndef LINK_MGR_HYSTERESIS
+#define LINK_MGR_HYSTERESIS          6
+#endif
+
+// Failed transmissions within a period that step down one PHY
+#ifndef LINK_MGR_LOSS_LIMIT
+#define LINK_MGR_LOSS_LIMIT          3
+#endif
+
+// Periods to stay on a PHY after a switch, or to wait for the PHY status
+// event before the peer is taken as not supporting the PHY
+#ifndef LINK_MGR_HOLD_PERIODS
+#define LINK_MGR_HOLD_PERIODS        3
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Handle a Bluetooth stack event.
+ *
+ * @details
+ *   Pass every event to the manager, it follows the connection opened, RSSI,
+ *   PHY status and closed events and runs on its own soft timer. One
+ *   connection is managed, the last one opened. Data demand is taken from
+ *   the connection parameter controller, see conn_ctrl.h.
+ *
+ * @param[in] evt
+ *   Event from gecko_wait_event() or gecko_peek_event().
+ *
+ * @return
+ *   True if the event was the manager's soft timer and needs no further
+ *   handling, False otherwise.
+ *
+ ******************************************************************************/
+bool link_mgr_handle_event(struct gecko_cmd_packet *evt);
+
+/***************************************************************************//**
+ * @brief
+ *   Report a transmission the stack could not queue.
+ *
+ * @details
+ *   Call it when sending data fails with bg_err_out_of_memory. The stack
+ *   runs out of buffers when packets are not acknowledged, so failures
+ *   are the sign of packet loss available to the application.
+ *
+ ******************************************************************************/
+void link_mgr_tx_failed(void);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the PHY of the managed connection.
+ *
+ * @return
+ *   le_gap_phy_1m, le_gap_phy_2m or le_gap_phy_coded.
+ *
+ ******************************************************************************/
+uint8_t link_mgr_phy(void);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of PHY switches on the managed connection.
+ *
+ * @return
+ *   PHY status events which changed the PHY since the connection opened.
+ *
+ ******************************************************************************/
+uint32_t link_mgr_switches(void);
+
+#endif /* LINK_MGR_H_ */
@@ -46,6 +46,7 @@
 
 /* Application header */
 #include "app.h"
+#include "heap_monitor.h"
 
 /***********************************************************************************************//**
  * @addtogroup Application
@@ -57,15 +58,26 @@
  * @{
  **************************************************************************************************/
 
+// The connectable, beacon and broadcast sets of the advertising scheduler and
+// the periodic advertising set
 #ifndef MAX_ADVERTISERS
-#define MAX_ADVERTISERS 1
+#define MAX_ADVERTISERS 4
 #endif
 
 #ifndef MAX_CONNECTIONS
 #define MAX_CONNECTIONS 4
 #endif
 
-uint8_t bluetooth_stack_heap[DEFAULT_BLUETOOTH_HEAP(MAX_CONNECTIONS)];
+#ifndef BLUETOOTH_HEAP_SIZE
+#define BLUETOOTH_HEAP_SIZE DEFAULT_BLUETOOTH_HEAP(MAX_CONNECTIONS)
+#endif
+// A HEAP_MONITOR_PROFILE build over-allocates the heap, so the heap monitor
+// can recommend a BLUETOOTH_HEAP_SIZE for the workload
+#if defined(HEAP_MONITOR_PROFILE)
+uint8_t bluetooth_stack_heap[BLUETOOTH_HEAP_SIZE * HEAP_MONITOR_PROFILE_FACTOR];
+#else
+uint8_t bluetooth_stack_heap[BLUETOOTH_HEAP_SIZE];
+#endif
 
 /* Bluetooth stack configuration parameters (see "UG136: Silicon Labs Bluetooth C Application Developer's Guide" for details on each parameter) */
 static gecko_configuration_t config = {
@@ -106,6 +118,8 @@ int main(void)
   initBoard();
   /* Initialize application */
   initApp();
+  /* Mark the heap to measure its usage */
+  heap_monitor_init(bluetooth_stack_heap, sizeof(bluetooth_stack_heap));
   /* Start application */
   appMain(&config);
 }
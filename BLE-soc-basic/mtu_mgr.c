@@ -0,0 +1,117 @@
+/***************************************************************************//**
+ * @file
+ * @brief ATT MTU and LL data length manager
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "mtu_mgr.h"
+
+#define ATT_HEADER         3
+#define L2CAP_HEADER       4
+
+// Connection handles start from 1, 0 marks a free entry
+#define NO_CONNECTION      0
+
+typedef struct {
+  uint8_t connection;
+  uint16_t mtu;
+  // Maximum LL PDU payload the stack sends
+  uint16_t pdu;
+} mtu_mgr_link_t;
+
+static mtu_mgr_link_t links[MTU_MGR_MAX_CONNECTIONS];
+
+static mtu_mgr_link_t *mtu_mgr_find(uint8_t connection);
+
+void mtu_mgr_handle_event(struct gecko_cmd_packet *evt)
+{
+  mtu_mgr_link_t *link;
+
+  switch (BGLIB_MSG_ID(evt->header)) {
+    case gecko_evt_system_boot_id:
+      gecko_cmd_gatt_set_max_mtu(MTU_MGR_MAX_MTU);
+      break;
+
+    case gecko_evt_le_connection_opened_id:
+      link = mtu_mgr_find(evt->data.evt_le_connection_opened.connection);
+      if (!link) {
+        link = mtu_mgr_find(NO_CONNECTION);
+      }
+      if (link) {
+        link->connection = evt->data.evt_le_connection_opened.connection;
+        link->mtu = MTU_MGR_DEFAULT_MTU;
+        link->pdu = MTU_MGR_DEFAULT_PDU;
+      }
+      break;
+
+    case gecko_evt_gatt_mtu_exchanged_id:
+      link = mtu_mgr_find(evt->data.evt_gatt_mtu_exchanged.connection);
+      if (link) {
+        link->mtu = evt->data.evt_gatt_mtu_exchanged.mtu;
+      }
+      break;
+
+    case gecko_evt_le_connection_parameters_id:
+      link = mtu_mgr_find(evt->data.evt_le_connection_parameters.connection);
+      if (link) {
+        link->pdu = evt->data.evt_le_connection_parameters.txsize;
+      }
+      break;
+
+    case gecko_evt_le_connection_closed_id:
+      link = mtu_mgr_find(evt->data.evt_le_connection_closed.connection);
+      if (link) {
+        link->connection = NO_CONNECTION;
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+uint16_t mtu_mgr_mtu(uint8_t connection)
+{
+  mtu_mgr_link_t *link = mtu_mgr_find(connection);
+
+  return link ? link->mtu : MTU_MGR_DEFAULT_MTU;
+}
+
+uint16_t mtu_mgr_max_payload(uint8_t connection)
+{
+  return mtu_mgr_mtu(connection) - ATT_HEADER;
+}
+
+uint16_t mtu_mgr_packet_payload(uint8_t connection)
+{
+  mtu_mgr_link_t *link = mtu_mgr_find(connection);
+  uint16_t pdu = link ? link->pdu : MTU_MGR_DEFAULT_PDU;
+  uint16_t mtu = link ? link->mtu : MTU_MGR_DEFAULT_MTU;
+
+  if (pdu - L2CAP_HEADER < mtu) {
+    mtu = pdu - L2CAP_HEADER;
+  }
+  return mtu - ATT_HEADER;
+}
+
+static mtu_mgr_link_t *mtu_mgr_find(uint8_t connection)
+{
+  for (int i = 0; i < MTU_MGR_MAX_CONNECTIONS; i++) {
+    if (links[i].connection == connection) {
+      return &links[i];
+    }
+  }
+  return NULL;
+}
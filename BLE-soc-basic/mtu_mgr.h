@@ -0,0 +1,101 @@
+/***************************************************************************//**
+ * @file
+ * @brief ATT MTU and LL data length manager
+ * Raises the ATT MTU limit at boot and keeps track of the MTU and the link
+ * layer PDU size negotiated on each connection, so data can be sent in
+ * chunks that fill the radio packets.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef MTU_MGR_H_
+#define MTU_MGR_H_
+
+#include <stdint.h>
+#include "native_gecko.h"
+
+// ATT MTU requested at boot. 247 makes a full ATT packet, with its 4 byte
+// L2CAP header, exactly one 251 byte LL PDU.
+#ifndef MTU_MGR_MAX_MTU
+#define MTU_MGR_MAX_MTU              247
+#endif
+
+// Connections tracked, at least .bluetooth.max_connections
+#ifndef MTU_MGR_MAX_CONNECTIONS
+#define MTU_MGR_MAX_CONNECTIONS      4
+#endif
+
+// Values of a connection before anything is negotiated
+#define MTU_MGR_DEFAULT_MTU          23
+#define MTU_MGR_DEFAULT_PDU          27
+
+/***************************************************************************//**
+ * @brief
+ *   Handle a Bluetooth stack event.
+ *
+ * @details
+ *   Pass every event to the manager. The system boot event sets the MTU
+ *   limit, the connection and MTU exchanged events update the connections.
+ *   The stack starts the MTU exchange and the data length update by itself
+ *   once a connection is open.
+ *
+ * @param[in] evt
+ *   Event from gecko_wait_event() or gecko_peek_event().
+ *
+ ******************************************************************************/
+void mtu_mgr_handle_event(struct gecko_cmd_packet *evt);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the ATT MTU of a connection.
+ *
+ * @param[in] connection
+ *   Connection handle.
+ *
+ * @return
+ *   Negotiated MTU, MTU_MGR_DEFAULT_MTU if the connection is unknown.
+ *
+ ******************************************************************************/
+uint16_t mtu_mgr_mtu(uint8_t connection);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the largest value a notification, indication or write can carry.
+ *
+ * @param[in] connection
+ *   Connection handle.
+ *
+ * @return
+ *   MTU minus the 3 byte ATT header.
+ *
+ ******************************************************************************/
+uint16_t mtu_mgr_max_payload(uint8_t connection);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the largest value which goes out in a single LL PDU.
+ *
+ * @details
+ *   Values up to mtu_mgr_max_payload() are fragmented into several PDUs by
+ *   the stack. Sending in chunks of this size avoids a short last fragment.
+ *
+ * @param[in] connection
+ *   Connection handle.
+ *
+ * @return
+ *   Value length filling one PDU, limited by the MTU.
+ *
+ ******************************************************************************/
+uint16_t mtu_mgr_packet_payload(uint8_t connection);
+
+#endif /* MTU_MGR_H_ */
@@ -0,0 +1,126 @@
+/***************************************************************************//**
+ * @file
+ * @brief Periodic advertising broadcast of sensor records
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "native_gecko.h"
+#include "adv_payload.h"
+#include "periodic_bcast.h"
+
+// Positions in the packet
+#define POS_RECORD_LEN   4
+#define POS_SEQUENCE     5
+#define POS_COUNT        7
+
+// Configuration flag of le_gap_set_advertise_configuration for legacy PDUs,
+// periodic advertising needs extended advertising
+#define ADV_CONFIG_LEGACY    1
+
+// Intervals in the units of the stack, 1.25 ms periodic, 0.625 ms advertising
+#define PERIODIC_INTERVAL    ((uint16_t)(PERIODIC_BCAST_INTERVAL_MS * 4 / 5))
+#define ADV_INTERVAL         ((uint32_t)PERIODIC_BCAST_ADV_INTERVAL_MS * 8 / 5)
+
+static uint8_t packet[PERIODIC_BCAST_DATA_LEN];
+static uint8_t handle_ = 0;
+static bool running = false;
+static uint16_t next_sequence = 0;
+// Records added since the packet was last published
+static uint8_t pending = 0;
+
+uint16_t periodic_bcast_start(uint8_t handle, uint16_t company_id)
+{
+  uint16_t result;
+
+  packet[1] = ADV_PAYLOAD_TYPE_MANUFACTURER_DATA;
+  packet[2] = (uint8_t)company_id;
+  packet[3] = (uint8_t)(company_id >> 8);
+  packet[POS_RECORD_LEN] = PERIODIC_BCAST_RECORD_LEN;
+  handle_ = handle;
+
+  gecko_cmd_le_gap_set_advertise_tx_power(handle, PERIODIC_BCAST_TX_POWER);
+  result = gecko_cmd_le_gap_set_advertise_timing(handle, ADV_INTERVAL, ADV_INTERVAL, 0, 0)->result;
+  if (result == bg_err_success) {
+    result = gecko_cmd_le_gap_clear_advertise_configuration(handle, ADV_CONFIG_LEGACY)->result;
+  }
+  if (result == bg_err_success) {
+    result = gecko_cmd_le_gap_start_periodic_advertising(handle, PERIODIC_INTERVAL,
+                                                         PERIODIC_INTERVAL, 0)->result;
+  }
+  if (result != bg_err_success) {
+    return result;
+  }
+  // the data of the train can only be set once it runs
+  running = true;
+  pending = 1;
+  result = periodic_bcast_flush();
+  if (result == bg_err_success) {
+    result = gecko_cmd_le_gap_start_advertising(handle, le_gap_general_discoverable,
+                                                le_gap_non_connectable)->result;
+  }
+  if (result != bg_err_success) {
+    periodic_bcast_stop();
+  }
+  return result;
+}
+
+void periodic_bcast_stop(void)
+{
+  if (running) {
+    gecko_cmd_le_gap_stop_advertising(handle_);
+    gecko_cmd_le_gap_stop_periodic_advertising(handle_);
+    running = false;
+  }
+}
+
+uint16_t periodic_bcast_add(const uint8_t *record)
+{
+  uint16_t sequence = next_sequence++;
+  uint8_t *records = &packet[PERIODIC_BCAST_HEADER_LEN];
+
+  // newest first, the oldest falls off the end when the window is full
+  memmove(records + PERIODIC_BCAST_RECORD_LEN, records,
+          (PERIODIC_BCAST_MAX_RECORDS - 1) * PERIODIC_BCAST_RECORD_LEN);
+  memcpy(records, record, PERIODIC_BCAST_RECORD_LEN);
+  if (packet[POS_COUNT] < PERIODIC_BCAST_MAX_RECORDS) {
+    packet[POS_COUNT]++;
+  }
+  packet[POS_SEQUENCE] = (uint8_t)sequence;
+  packet[POS_SEQUENCE + 1] = (uint8_t)(sequence >> 8);
+
+  if (pending < PERIODIC_BCAST_BATCH) {
+    pending++;
+  }
+  if (pending >= PERIODIC_BCAST_BATCH) {
+    periodic_bcast_flush();
+  }
+  return sequence;
+}
+
+uint16_t periodic_bcast_flush(void)
+{
+  uint8_t len = PERIODIC_BCAST_HEADER_LEN + packet[POS_COUNT] * PERIODIC_BCAST_RECORD_LEN;
+  uint16_t result;
+
+  if (!running || pending == 0) {
+    return bg_err_success;
+  }
+  packet[0] = len - 1;
+  result = gecko_cmd_le_gap_bt5_set_adv_data(handle_, ADV_PAYLOAD_PERIODIC, len, packet)->result;
+  if (result == bg_err_success) {
+    pending = 0;
+  }
+  return result;
+}
@@ -0,0 +1,136 @@
+/***************************************************************************//**
+ * @file
+ * @brief Periodic advertising broadcast of sensor records
+ * Publishes sequence-numbered sensor records in the periodic advertising
+ * train of an advertising set, so any number of listeners can sync to it and
+ * receive every record without a connection. Each packet carries a window of
+ * the newest records, a listener which misses a few packets still gets every
+ * record and drops the ones it already has by their sequence number.
+ *
+ * Packet: one manufacturer specific AD structure holding the company
+ * identifier, the record length, the sequence number of the newest record
+ * (16 bits, little endian), the number of records and the records, newest
+ * first, record i having the sequence number newest - i.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef PERIODIC_BCAST_H_
+#define PERIODIC_BCAST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Size of a record, in bytes
+#ifndef PERIODIC_BCAST_RECORD_LEN
+#define PERIODIC_BCAST_RECORD_LEN        2
+#endif
+
+// Records in each packet, the newest ones
+#ifndef PERIODIC_BCAST_MAX_RECORDS
+#define PERIODIC_BCAST_MAX_RECORDS       16
+#endif
+
+// Records added before the packet is published, a record is sent in
+// PERIODIC_BCAST_MAX_RECORDS / PERIODIC_BCAST_BATCH consecutive packets
+#ifndef PERIODIC_BCAST_BATCH
+#define PERIODIC_BCAST_BATCH             4
+#endif
+
+// Periodic advertising interval, in ms
+#ifndef PERIODIC_BCAST_INTERVAL_MS
+#define PERIODIC_BCAST_INTERVAL_MS       1000
+#endif
+
+// Interval of the extended advertising listeners find the train with, in ms
+#ifndef PERIODIC_BCAST_ADV_INTERVAL_MS
+#define PERIODIC_BCAST_ADV_INTERVAL_MS   1000
+#endif
+
+// TX power, in units of 0.1 dBm
+#ifndef PERIODIC_BCAST_TX_POWER
+#define PERIODIC_BCAST_TX_POWER          80
+#endif
+
+// AD length and type, company identifier, record length, sequence number
+// and count before the records
+#define PERIODIC_BCAST_HEADER_LEN        8
+#define PERIODIC_BCAST_DATA_LEN \
+  (PERIODIC_BCAST_HEADER_LEN + PERIODIC_BCAST_MAX_RECORDS * PERIODIC_BCAST_RECORD_LEN)
+
+#if PERIODIC_BCAST_DATA_LEN > 191
+#error "PERIODIC_BCAST_MAX_RECORDS records do not fit in periodic advertising data"
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Start the periodic advertising.
+ *
+ * @details
+ *   Call after the system boot event. gecko_init_periodic_advertising() must
+ *   have been called after gecko_init(). The set advertises non-connectable
+ *   extended advertising pointing listeners to the periodic train, it must
+ *   not be used by anything else.
+ *
+ * @param[in] handle
+ *   Advertising set handle, below MAX_ADVERTISERS of main.c.
+ *
+ * @param[in] company_id
+ *   Company identifier of the manufacturer specific data.
+ *
+ * @return
+ *   bg_err_success, or the error of the first stack command which failed.
+ *
+ ******************************************************************************/
+uint16_t periodic_bcast_start(uint8_t handle, uint16_t company_id);
+
+/***************************************************************************//**
+ * @brief
+ *   Stop the periodic advertising.
+ *
+ * @details
+ *   The records are kept, periodic_bcast_start() publishes them again.
+ *
+ ******************************************************************************/
+void periodic_bcast_stop(void);
+
+/***************************************************************************//**
+ * @brief
+ *   Add a record.
+ *
+ * @details
+ *   Every PERIODIC_BCAST_BATCH records the packet is published. Records can
+ *   be added while stopped, they are published on the next start.
+ *
+ * @param[in] record
+ *   PERIODIC_BCAST_RECORD_LEN bytes.
+ *
+ * @return
+ *   Sequence number of the record.
+ *
+ ******************************************************************************/
+uint16_t periodic_bcast_add(const uint8_t *record);
+
+/***************************************************************************//**
+ * @brief
+ *   Publish the records added since the last packet without waiting for the
+ *   batch to fill.
+ *
+ * @return
+ *   Result of le_gap_bt5_set_adv_data, bg_err_success if nothing was added
+ *   or the broadcast is stopped.
+ *
+ ******************************************************************************/
+uint16_t periodic_bcast_flush(void);
+
+#endif /* PERIODIC_BCAST_H_ */
@@ -0,0 +1,194 @@
+/***************************************************************************//**
+ * @file
+ * @brief Fast reconnection of bonded peers
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include "adv_sched.h"
+#include "reconn_mgr.h"
+
+#define NO_CONNECTION      0xff
+#define NO_BONDING         0xff
+
+// Soft timer ticks at 32768 Hz
+#define MS_TO_TICKS(ms)    ((uint32_t)(ms) * 32768 / 1000)
+
+// Bonding policy of sm_store_bonding_configuration: a new bonding overwrites
+// the one used longest ago
+#define BONDING_POLICY_LRU 2
+
+typedef struct {
+  uint8_t connection;
+  uint8_t bonding;
+} reconn_mgr_connection_t;
+
+static uint8_t adv_handle = 0;
+static reconn_mgr_phase_t phase = reconn_mgr_fast;
+// Bonding handles, the most recently used first
+static uint8_t peers[RECONN_MGR_MAX_PEERS];
+static uint8_t peer_count = 0;
+static reconn_mgr_connection_t connections[RECONN_MGR_MAX_CONNECTIONS];
+
+static void reconn_mgr_enter(reconn_mgr_phase_t next);
+static void reconn_mgr_touch(uint8_t bonding);
+static reconn_mgr_connection_t *reconn_mgr_find(uint8_t connection);
+
+void reconn_mgr_start(uint8_t handle)
+{
+  adv_handle = handle;
+  peer_count = 0;
+  for (uint8_t i = 0; i < RECONN_MGR_MAX_CONNECTIONS; i++) {
+    connections[i].connection = NO_CONNECTION;
+  }
+  gecko_cmd_sm_store_bonding_configuration(RECONN_MGR_MAX_PEERS, BONDING_POLICY_LRU);
+  gecko_cmd_sm_set_bondable_mode(1);
+  // the set runs at its configured interval until the list is complete
+  phase = reconn_mgr_fast;
+  if (gecko_cmd_sm_list_all_bondings()->result != bg_err_success) {
+    reconn_mgr_enter(reconn_mgr_fast);
+  }
+}
+
+bool reconn_mgr_handle_event(struct gecko_cmd_packet *evt)
+{
+  reconn_mgr_connection_t *conn;
+
+  switch (BGLIB_MSG_ID(evt->header)) {
+    case gecko_evt_sm_list_bonding_entry_id:
+      reconn_mgr_touch(evt->data.evt_sm_list_bonding_entry.bonding);
+      return true;
+
+    case gecko_evt_sm_list_all_bondings_complete_id:
+      if (phase != reconn_mgr_connected) {
+        reconn_mgr_enter((peer_count > 0) ? reconn_mgr_burst : reconn_mgr_fast);
+      }
+      return true;
+
+    case gecko_evt_le_connection_opened_id:
+      conn = reconn_mgr_find(NO_CONNECTION);
+      if (conn != NULL) {
+        conn->connection = evt->data.evt_le_connection_opened.connection;
+        conn->bonding = evt->data.evt_le_connection_opened.bonding;
+      }
+      if (evt->data.evt_le_connection_opened.bonding != NO_BONDING) {
+        reconn_mgr_touch(evt->data.evt_le_connection_opened.bonding);
+      }
+      if (evt->data.evt_le_connection_opened.advertiser == adv_handle) {
+        // the stack stopped the set, the scheduler restarts it on close
+        gecko_cmd_hardware_set_soft_timer(0, RECONN_MGR_TIMER_HANDLE, 0);
+        gecko_cmd_le_gap_enable_whitelisting(0);
+        phase = reconn_mgr_connected;
+      }
+      break;
+
+    case gecko_evt_sm_bonded_id:
+      conn = reconn_mgr_find(evt->data.evt_sm_bonded.connection);
+      if (conn != NULL) {
+        conn->bonding = evt->data.evt_sm_bonded.bonding;
+      }
+      reconn_mgr_touch(evt->data.evt_sm_bonded.bonding);
+      break;
+
+    case gecko_evt_le_connection_closed_id:
+      conn = reconn_mgr_find(evt->data.evt_le_connection_closed.connection);
+      // a bonded peer is likely to come back at once
+      reconn_mgr_enter((conn != NULL && conn->bonding != NO_BONDING)
+                       ? reconn_mgr_burst : reconn_mgr_fast);
+      if (conn != NULL) {
+        conn->connection = NO_CONNECTION;
+      }
+      break;
+
+    case gecko_evt_hardware_soft_timer_id:
+      if (evt->data.evt_hardware_soft_timer.handle == RECONN_MGR_TIMER_HANDLE) {
+        reconn_mgr_enter((phase == reconn_mgr_burst) ? reconn_mgr_fast : reconn_mgr_slow);
+        return true;
+      }
+      break;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+reconn_mgr_phase_t reconn_mgr_phase(void)
+{
+  return phase;
+}
+
+uint8_t reconn_mgr_peers(void)
+{
+  return peer_count;
+}
+
+/**
+ * Set the whitelist, interval and timer of a phase
+ */
+static void reconn_mgr_enter(reconn_mgr_phase_t next)
+{
+  phase = next;
+  gecko_cmd_le_gap_enable_whitelisting(phase == reconn_mgr_burst);
+  switch (phase) {
+    case reconn_mgr_burst:
+      adv_sched_set_interval(adv_handle, RECONN_MGR_BURST_INTERVAL_MS);
+      gecko_cmd_hardware_set_soft_timer(MS_TO_TICKS(RECONN_MGR_BURST_MS),
+                                        RECONN_MGR_TIMER_HANDLE, 1);
+      break;
+
+    case reconn_mgr_fast:
+      adv_sched_set_interval(adv_handle, 0);
+      gecko_cmd_hardware_set_soft_timer(MS_TO_TICKS(RECONN_MGR_FAST_MS),
+                                        RECONN_MGR_TIMER_HANDLE, 1);
+      break;
+
+    default:
+      adv_sched_set_interval(adv_handle, RECONN_MGR_SLOW_INTERVAL_MS);
+      break;
+  }
+}
+
+/**
+ * Move a bonding to the front of the table, the one used longest ago falls
+ * off the end when the table is full, as in the bonding database
+ */
+static void reconn_mgr_touch(uint8_t bonding)
+{
+  uint8_t i = 0;
+
+  while (i < peer_count && peers[i] != bonding) {
+    i++;
+  }
+  if (i == peer_count) {
+    // not in the table, make room at the end
+    if (peer_count < RECONN_MGR_MAX_PEERS) {
+      peer_count++;
+    }
+    i = peer_count - 1;
+  }
+  for (; i > 0; i--) {
+    peers[i] = peers[i - 1];
+  }
+  peers[0] = bonding;
+}
+
+static reconn_mgr_connection_t *reconn_mgr_find(uint8_t connection)
+{
+  for (uint8_t i = 0; i < RECONN_MGR_MAX_CONNECTIONS; i++) {
+    if (connections[i].connection == connection) {
+      return &connections[i];
+    }
+  }
+  return NULL;
+}
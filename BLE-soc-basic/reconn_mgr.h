@@ -0,0 +1,125 @@
+/***************************************************************************//**
+ * @file
+ * @brief Fast reconnection of bonded peers
+ * Keeps a small most recently used table of bonded peers. When one of them
+ * disconnects, or at boot when any is known, the connectable set advertises
+ * in a short high duty burst only they can connect to, through the
+ * whitelist, then at its configured interval to everyone, then backs off to
+ * a low duty interval until the next connection.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef RECONN_MGR_H_
+#define RECONN_MGR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "native_gecko.h"
+
+// Bonded peers kept, the stack drops the bonding used longest ago beyond
+// that, which keeps the whitelist small
+#ifndef RECONN_MGR_MAX_PEERS
+#define RECONN_MGR_MAX_PEERS         4
+#endif
+
+// Connections tracked, at least .bluetooth.max_connections
+#ifndef RECONN_MGR_MAX_CONNECTIONS
+#define RECONN_MGR_MAX_CONNECTIONS   4
+#endif
+
+// Soft timer handle ending the burst and the fast phase
+#ifndef RECONN_MGR_TIMER_HANDLE
+#define RECONN_MGR_TIMER_HANDLE      6
+#endif
+
+// Whitelisted burst: interval and duration in ms
+#ifndef RECONN_MGR_BURST_INTERVAL_MS
+#define RECONN_MGR_BURST_INTERVAL_MS 20
+#endif
+#ifndef RECONN_MGR_BURST_MS
+#define RECONN_MGR_BURST_MS          2000
+#endif
+
+// Advertising to everyone at the configured interval, duration in ms
+#ifndef RECONN_MGR_FAST_MS
+#define RECONN_MGR_FAST_MS           30000
+#endif
+
+// Low duty interval after the fast phase, in ms
+#ifndef RECONN_MGR_SLOW_INTERVAL_MS
+#define RECONN_MGR_SLOW_INTERVAL_MS  1000
+#endif
+
+typedef enum {
+  reconn_mgr_connected,  // Connected, the scheduler restarts the set
+  reconn_mgr_burst,      // Whitelisted high duty advertising
+  reconn_mgr_fast,       // Configured interval
+  reconn_mgr_slow        // Low duty interval
+} reconn_mgr_phase_t;
+
+/***************************************************************************//**
+ * @brief
+ *   Start managing the connectable set.
+ *
+ * @details
+ *   Call after the system boot event, once the set is added to the
+ *   advertising scheduler. gecko_init_whitelisting() must have been called
+ *   after gecko_init(). Enables bonding and reads the bonded peers, the set
+ *   starts with a burst if there are any.
+ *
+ * @param[in] handle
+ *   Advertising set handle of the connectable set.
+ *
+ ******************************************************************************/
+void reconn_mgr_start(uint8_t handle);
+
+/***************************************************************************//**
+ * @brief
+ *   Handle a Bluetooth stack event.
+ *
+ * @details
+ *   Pass every event to the manager, before the advertising scheduler, so
+ *   the set restarts after a connection with the interval of the burst.
+ *
+ * @param[in] evt
+ *   Event from gecko_wait_event() or gecko_peek_event().
+ *
+ * @return
+ *   True if the event was a bonding list event or the timer of the manager
+ *   and needs no further handling, False otherwise.
+ *
+ ******************************************************************************/
+bool reconn_mgr_handle_event(struct gecko_cmd_packet *evt);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the advertising phase.
+ *
+ * @return
+ *   Phase of the connectable set.
+ *
+ ******************************************************************************/
+reconn_mgr_phase_t reconn_mgr_phase(void);
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of bonded peers known.
+ *
+ * @return
+ *   Peers in the table, at most RECONN_MGR_MAX_PEERS.
+ *
+ ******************************************************************************/
+uint8_t reconn_mgr_peers(void);
+
+#endif /* RECONN_MGR_H_ */
@@ -0,0 +1,216 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host test of the COBS/CRC-16 framing shared with the NCP target
+ *
+ * Round trips payloads of every length up to the largest BGAPI packet, with
+ * zero runs and the 254 byte COBS block boundaries, and checks that every
+ * single bit error, double bit errors in the data up to 16 bits apart and
+ * every truncation of a frame are rejected. Commands of up to NCP_CMD_SIZE
+ * bytes are decoded in place the way ncp_usart.c receives them.
+ *
+ *   frame_test [seed]
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "ncp_host.h"
+
+extern "C" {
+#include "ncp_frame.h"
+}
+
+// Command buffer size of the target, the default of ncp.h. Build with
+// -DNCP_CMD_SIZE=<size> to check an overridden one.
+#ifndef NCP_CMD_SIZE
+#define NCP_CMD_SIZE 360
+#endif
+
+namespace {
+
+unsigned failures = 0;
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      std::printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      std::printf(__VA_ARGS__);                   \
+      std::printf("\n");                          \
+      if (++failures > 20) {                      \
+        std::exit(1);                             \
+      }                                           \
+    }                                             \
+  } while (0)
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes encode(const Bytes& payload)
+{
+  Bytes frame(NCP_FRAME_ENCODED_LEN(payload.size()));
+  frame.resize(ncp_frame_encode(payload.data(), payload.size(), frame.data()));
+  return frame;
+}
+
+// Decode the way the host does: split at delimiters, decode each part in
+// place, true if any part decodes to a payload
+bool receive(Bytes frame, Bytes* payload)
+{
+  payload->clear();
+  size_t start = 0;
+  bool decoded = false;
+  for (size_t i = 0; i <= frame.size(); i++) {
+    if (i < frame.size() && frame[i] != NCP_FRAME_DELIMITER) {
+      continue;
+    }
+    if (i > start) {
+      uint32_t len = ncp_frame_decode(&frame[start], i - start, &frame[start], i - start);
+      if (len > 0) {
+        payload->assign(&frame[start], &frame[start] + len);
+        decoded = true;
+      }
+    }
+    start = i + 1;
+  }
+  return decoded;
+}
+
+Bytes make_payload(std::mt19937& rng, size_t len, int kind)
+{
+  Bytes payload(len);
+  for (size_t i = 0; i < len; i++) {
+    switch (kind) {
+      case 0: payload[i] = static_cast<uint8_t>(rng()); break;
+      case 1: payload[i] = 0; break;
+      case 2: payload[i] = static_cast<uint8_t>(1 + rng() % 255); break;
+      default: payload[i] = (rng() % 4 == 0) ? 0 : static_cast<uint8_t>(rng()); break;
+    }
+  }
+  return payload;
+}
+
+void test_crc()
+{
+  // check value of CRC-16/CCITT-FALSE
+  const uint8_t check[] = "123456789";
+  CHECK(ncp_frame_crc16(0xffff, check, 9) == 0x29b1, "crc %04x",
+        ncp_frame_crc16(0xffff, check, 9));
+  // split calculation
+  uint16_t crc = ncp_frame_crc16(0xffff, check, 4);
+  CHECK(ncp_frame_crc16(crc, &check[4], 5) == 0x29b1, "split crc");
+}
+
+void test_round_trip(std::mt19937& rng)
+{
+  // the empty payload is encoded but decodes to 0 like an error, the host
+  // never sends one
+  for (size_t len = 1; len <= ncp::kMaxPacketLen; len++) {
+    for (int kind = 0; kind < 4; kind++) {
+      Bytes payload = make_payload(rng, len, kind);
+      Bytes frame = encode(payload);
+      CHECK(frame.size() <= NCP_FRAME_ENCODED_LEN(len), "len %zu: frame %zu too long",
+            len, frame.size());
+      CHECK(frame.back() == NCP_FRAME_DELIMITER, "len %zu: no delimiter", len);
+      CHECK(std::memchr(frame.data(), NCP_FRAME_DELIMITER, frame.size() - 1) == nullptr,
+            "len %zu: delimiter inside the frame", len);
+      Bytes decoded;
+      CHECK(receive(Bytes(frame.begin(), frame.end() - 1), &decoded) && decoded == payload,
+            "len %zu kind %d: round trip", len, kind);
+      // a buffer too small for payload and CRC is refused
+      Bytes out(len + NCP_FRAME_CRC_LEN - 1);
+      CHECK(ncp_frame_decode(frame.data(), frame.size() - 1, out.data(), out.size()) == 0,
+            "len %zu: decoded into a short buffer", len);
+    }
+  }
+}
+
+// Decode in place in a receive buffer of the target, with the same size
+// argument as ncp_usart.c: the CRC is written to the buffer before it is
+// stripped, so a command of NCP_CMD_SIZE bytes needs room for it too.
+void test_target_size(std::mt19937& rng)
+{
+  const size_t lens[] = { 1, NCP_CMD_SIZE - NCP_FRAME_CRC_LEN, NCP_CMD_SIZE - 1, NCP_CMD_SIZE };
+  for (size_t len : lens) {
+    for (int kind = 0; kind < 4; kind++) {
+      Bytes payload = make_payload(rng, len, kind);
+      Bytes frame = encode(payload);
+      Bytes rxbuf(1 + NCP_FRAME_ENCODED_LEN(NCP_CMD_SIZE));
+      CHECK(frame.size() <= rxbuf.size(), "len %zu: frame %zu does not fit the receive buffer",
+            len, frame.size());
+      std::copy(frame.begin(), frame.end(), rxbuf.begin());
+      uint32_t decoded = ncp_frame_decode(rxbuf.data(), frame.size() - 1, rxbuf.data(),
+                                          NCP_CMD_SIZE + NCP_FRAME_CRC_LEN);
+      CHECK(decoded == len && std::equal(payload.begin(), payload.end(), rxbuf.begin()),
+            "len %zu kind %d: in place decode of the target size", len, kind);
+    }
+  }
+}
+
+// A damaged frame must be dropped. The only exception is the empty block
+// after a full one: a payload and CRC of exactly 254 non-zero bytes end in
+// 0xff <254 bytes> 0x01, and losing the 0x01 still leaves the payload.
+bool rejected(const Bytes& frame, const Bytes& payload)
+{
+  Bytes decoded;
+  return !receive(frame, &decoded) || decoded == payload;
+}
+
+void test_bit_errors(std::mt19937& rng)
+{
+  const size_t lens[] = { 1, 4, 16, 252, 253, 254, 255, 256, 508, 509, 600 };
+  for (size_t len : lens) {
+    for (int kind = 0; kind < 4; kind++) {
+      Bytes payload = make_payload(rng, len, kind);
+      Bytes frame = encode(payload);
+      frame.pop_back();
+      size_t bits = frame.size() * 8;
+      for (size_t bit = 0; bit < bits; bit++) {
+        Bytes bad = frame;
+        bad[bit / 8] ^= 1 << (bit % 8);
+        CHECK(rejected(bad, payload), "len %zu kind %d: bit %zu flip accepted",
+              len, kind, bit);
+      }
+      // double errors in data bytes less than 16 bits apart, which the CRC
+      // always catches. An error in a COBS code byte moves the data around,
+      // so it is only caught with the probability of the CRC.
+      std::vector<bool> code(frame.size(), false);
+      for (size_t pos = 0; pos < frame.size(); pos += frame[pos]) {
+        code[pos] = true;
+      }
+      for (size_t bit = 0; bit + 1 < bits; bit++) {
+        for (size_t next = bit + 1; next < bits && next < bit + 16; next++) {
+          if (code[bit / 8] || code[next / 8]) {
+            continue;
+          }
+          Bytes bad = frame;
+          bad[bit / 8] ^= 1 << (bit % 8);
+          bad[next / 8] ^= 1 << (next % 8);
+          CHECK(rejected(bad, payload), "len %zu kind %d: bits %zu,%zu flip accepted",
+                len, kind, bit, next);
+        }
+      }
+      // a frame cut short by a lost byte or delimiter
+      for (size_t cut = 0; cut < frame.size(); cut++) {
+        CHECK(rejected(Bytes(frame.begin(), frame.begin() + cut), payload),
+              "len %zu kind %d: truncated to %zu accepted", len, kind, cut);
+      }
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::mt19937 rng(argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 1);
+
+  test_crc();
+  test_round_trip(rng);
+  test_target_size(rng);
+  test_bit_errors(rng);
+  std::printf("%s, %u failures\n", failures ? "FAIL" : "PASS", failures);
+  return failures ? 1 : 0;
+}
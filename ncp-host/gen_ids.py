@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""Generate ncp_ids.h, the BGAPI message IDs for the NCP host library.
+
+The IDs are taken from the ncp_gecko.h shipped with the NCP target so that
+host and target always agree on them:
+
+    ./gen_ids.py ../BLE-ncp-empty-target/protocol/bluetooth/ble_stack/inc/soc/ncp_gecko.h > ncp_ids.h
+"""
+
+import re
+import sys
+
+DEFINE = re.compile(r'#define\s+gecko_(cmd|evt)_(\w+)_id\s+'
+                    r'\(\(\(uint32\)gecko_dev_type_gecko\)\|gecko_msg_type_(?:cmd|evt)\|(0x[0-9a-fA-F]+)\)')
+DEV_TYPE_GECKO = 0x20
+MSG_TYPE_EVT = 0x80
+
+
+def main(path):
+    ids = {'cmd': [], 'evt': []}
+    with open(path) as header:
+        for line in header:
+            match = DEFINE.match(line)
+            if match:
+                kind, name, value = match.groups()
+                value = int(value, 16) | DEV_TYPE_GECKO
+                if kind == 'evt':
+                    value |= MSG_TYPE_EVT
+                ids[kind].append((name, value))
+
+    out = sys.stdout
+    out.write('// Generated by gen_ids.py from ncp_gecko.h, do not edit.\n\n')
+    out.write('#ifndef NCP_IDS_H_\n#define NCP_IDS_H_\n\n#include <cstdint>\n\n')
+    out.write('namespace ncp {\n\n')
+    for kind, enum in (('cmd', 'Command'), ('evt', 'Event')):
+        out.write('enum class %s : uint32_t {\n' % enum)
+        for name, value in ids[kind]:
+            out.write('  %s = 0x%08x,\n' % (name, value))
+        out.write('};\n\n')
+    out.write('// Name of an event ID, nullptr if unknown\n')
+    out.write('inline const char* event_name(uint32_t id)\n{\n  switch (id) {\n')
+    for name, value in ids['evt']:
+        out.write('    case 0x%08x: return "%s";\n' % (value, name))
+    out.write('    default: return nullptr;\n  }\n}\n\n')
+    out.write('} // namespace ncp\n\n#endif // NCP_IDS_H_\n')
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 2:
+        sys.exit('usage: gen_ids.py <ncp_gecko.h>')
+    main(sys.argv[1])
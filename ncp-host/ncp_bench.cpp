@@ -0,0 +1,189 @@
+/***************************************************************************//**
+ * @file
+ * @brief Command round trip benchmark for the NCP host library
+ *
+ * Sends system_hello commands to an NCP target, keeping a number of them
+ * queued, and reports the command rate and round trip latency. The target
+ * can be a module on a serial port or a simulated one behind a pty. With -p
+ * it reports the SPI link counters of a target built with NCP_SPI_ENABLED
+ * afterwards, e.g. of spi_sim. -t sets the command timeout, a command which
+ * gets no response in time counts as failed.
+ *
+ *   ncp_bench <device> [-b baudrate] [-s new_baudrate] [-f] [-p] [-n count] [-q depth]
+ *             [-t timeout_ms]
+ ******************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "ncp_host.h"
+
+namespace {
+
+// Must match USER_CMD_* and NCP_USART_BAUD_PATTERN on the target
+constexpr uint8_t kUserCmdUartBaudSet = 0x10;
+constexpr uint8_t kUserCmdUartBaudConfirm = 0x11;
+constexpr uint8_t kUserCmdSpiStatus = 0x13;
+constexpr uint8_t kBaudPattern[] = { 0x55, 0xaa, 0x00, 0xff, 0x0f, 0xf0, 0x33, 0xcc };
+
+using Clock = std::chrono::steady_clock;
+
+template <typename T>
+T wait(ncp::Reactor& reactor, std::future<T>& future)
+{
+  while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    reactor.run_once(10);
+  }
+  return future.get();
+}
+
+uint16_t result_of(const ncp::Host::Response& rsp)
+{
+  return rsp.size() >= 2 ? rsp[0] | (rsp[1] << 8) : 0xffff;
+}
+
+uint32_t u32_at(const ncp::Host::Response& rsp, size_t pos)
+{
+  return rsp[pos] | (rsp[pos + 1] << 8) | (rsp[pos + 2] << 16) | (uint32_t(rsp[pos + 3]) << 24);
+}
+
+// Move the link to another baud rate, false if both sides fell back
+bool switch_baudrate(ncp::Reactor& reactor, ncp::Host& host, ncp::SerialPort& port,
+                     uint32_t current, uint32_t baudrate)
+{
+  uint8_t params[4] = { uint8_t(baudrate), uint8_t(baudrate >> 8),
+                        uint8_t(baudrate >> 16), uint8_t(baudrate >> 24) };
+  auto set = host.user_command(kUserCmdUartBaudSet, params, sizeof(params));
+  ncp::Host::Response rsp = wait(reactor, set);
+  if (result_of(rsp) != 0) {
+    return false;
+  }
+  port.set_baudrate(baudrate);
+  // give the target time to drain and switch
+  usleep(20000);
+  auto confirm = host.user_command(kUserCmdUartBaudConfirm, kBaudPattern, sizeof(kBaudPattern));
+  try {
+    rsp = wait(reactor, confirm);
+    // result, uint8array length, command code, echoed pattern
+    if (result_of(rsp) == 0 && rsp.size() == 4 + sizeof(kBaudPattern)
+        && std::memcmp(&rsp[4], kBaudPattern, sizeof(kBaudPattern)) == 0) {
+      return true;
+    }
+  } catch (const std::exception&) {
+  }
+  port.set_baudrate(current);
+  return false;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint32_t baudrate = 115200;
+  uint32_t new_baudrate = 0;
+  unsigned count = 10000;
+  unsigned depth = 4;
+  bool spi_status = false;
+  ncp::Host::Options options;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "b:s:fpn:q:t:")) != -1) {
+    switch (opt) {
+      case 'b': baudrate = std::strtoul(optarg, nullptr, 0); break;
+      case 's': new_baudrate = std::strtoul(optarg, nullptr, 0); break;
+      case 'f': options.framed = true; break;
+      case 'p': spi_status = true; break;
+      case 'n': count = std::strtoul(optarg, nullptr, 0); break;
+      case 'q': depth = std::max(1ul, std::strtoul(optarg, nullptr, 0)); break;
+      case 't': options.command_timeout_ms = std::max(1l, std::strtol(optarg, nullptr, 0)); break;
+      default:
+        std::fprintf(stderr, "usage: %s <device> [-b baud] [-s new_baud] [-f] [-p] [-n count] [-q depth] [-t timeout_ms]\n", argv[0]);
+        return 1;
+    }
+  }
+  if (optind >= argc) {
+    std::fprintf(stderr, "missing device\n");
+    return 1;
+  }
+
+  ncp::Reactor reactor;
+  ncp::SerialPort port;
+  port.open(argv[optind], baudrate);
+  ncp::Host host(reactor, port, options);
+  unsigned events = 0;
+  host.on_any_event([&events](const ncp::Packet&) { events++; });
+
+  if (new_baudrate != 0) {
+    if (switch_baudrate(reactor, host, port, baudrate, new_baudrate)) {
+      std::printf("switched to %u baud\n", new_baudrate);
+    } else {
+      std::printf("baud rate switch failed, staying at %u baud\n", baudrate);
+    }
+  }
+
+  struct InFlight {
+    std::future<ncp::Host::Response> future;
+    Clock::time_point start;
+  };
+  std::deque<InFlight> in_flight;
+  std::vector<double> latency_us;
+  latency_us.reserve(count);
+  unsigned sent = 0;
+  unsigned failed = 0;
+  Clock::time_point begin = Clock::now();
+
+  while (latency_us.size() + failed < count) {
+    while (sent < count && in_flight.size() < depth) {
+      in_flight.push_back({ host.command(ncp::Command::system_hello, nullptr, 0), Clock::now() });
+      sent++;
+    }
+    reactor.run_once(10);
+    while (!in_flight.empty()
+           && in_flight.front().future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+      try {
+        in_flight.front().future.get();
+        latency_us.push_back(std::chrono::duration<double, std::micro>(
+                               Clock::now() - in_flight.front().start).count());
+      } catch (const std::exception&) {
+        failed++;
+      }
+      in_flight.pop_front();
+    }
+  }
+
+  double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+  std::sort(latency_us.begin(), latency_us.end());
+  auto percentile = [&latency_us](double p) {
+    return latency_us.empty() ? 0.0 : latency_us[size_t(p * (latency_us.size() - 1))];
+  };
+  std::printf("%zu commands in %.3f s: %.0f cmd/s, %u failed, %u events, %llu rx errors\n",
+              latency_us.size(), elapsed, latency_us.size() / elapsed, failed, events,
+              (unsigned long long)host.rx_errors());
+  std::printf("latency us: p50 %.0f  p90 %.0f  p99 %.0f  max %.0f\n",
+              percentile(0.5), percentile(0.9), percentile(0.99), percentile(1.0));
+
+  if (spi_status) {
+    auto status = host.user_command(kUserCmdSpiStatus, nullptr, 0);
+    try {
+      ncp::Host::Response rsp = wait(reactor, status);
+      // result, uint8array length, command code, three counters
+      if (result_of(rsp) != 0 || rsp.size() < 4 + 12) {
+        std::printf("SPI status not supported\n");
+        return 1;
+      }
+      std::printf("SPI: %u transfers, %u rx errors, %u aborted\n",
+                  u32_at(rsp, 4), u32_at(rsp, 8), u32_at(rsp, 12));
+    } catch (const std::exception& e) {
+      std::printf("SPI status: %s\n", e.what());
+      return 1;
+    }
+  }
+  return failed ? 1 : 0;
+}
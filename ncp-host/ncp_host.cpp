@@ -0,0 +1,291 @@
+/***************************************************************************//**
+ * @file
+ * @brief Asynchronous host library for the Silabs NCP target
+ ******************************************************************************/
+
+#include "ncp_host.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+extern "C" {
+#include "ncp_frame.h"
+}
+
+namespace ncp {
+
+namespace {
+
+// Device type bits of the first header byte, see gecko_dev_type_gecko
+constexpr uint8_t kDevTypeMask = 0x78;
+constexpr uint8_t kDevTypeGecko = 0x20;
+// Receive buffer, room for a worst case frame and the start of the next one
+constexpr size_t kRxBufferLen = 2 * NCP_FRAME_ENCODED_LEN(kMaxPacketLen);
+
+uint32_t read_header(const uint8_t* data)
+{
+  return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+} // namespace
+
+Host::Host(Reactor& reactor, SerialPort& port, Options options)
+  : reactor_(reactor),
+    port_(port),
+    options_(options),
+    timer_fd_(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+    rx_(kRxBufferLen)
+{
+  if (timer_fd_ < 0) {
+    throw std::system_error(errno, std::generic_category(), "timerfd_create");
+  }
+  reactor_.add(port_.fd(), EPOLLIN, [this](uint32_t events) { on_port(events); });
+  reactor_.add(timer_fd_, EPOLLIN, [this](uint32_t) { on_timer(); });
+}
+
+Host::~Host()
+{
+  reactor_.remove(port_.fd());
+  reactor_.remove(timer_fd_);
+  ::close(timer_fd_);
+}
+
+std::future<Host::Response> Host::command(Command id, const void* params, size_t len)
+{
+  return command(static_cast<uint32_t>(id), params, len);
+}
+
+std::future<Host::Response> Host::command(uint32_t id, const void* params, size_t len)
+{
+  if (len > kMaxPacketLen - kHeaderLen) {
+    throw std::length_error("NCP command too long");
+  }
+  std::vector<uint8_t> packet(kHeaderLen + len);
+  uint32_t header = id | ((len & 0xff) << 8) | ((len >> 8) & 0x7);
+  packet[0] = static_cast<uint8_t>(header);
+  packet[1] = static_cast<uint8_t>(header >> 8);
+  packet[2] = static_cast<uint8_t>(header >> 16);
+  packet[3] = static_cast<uint8_t>(header >> 24);
+  if (len > 0) {
+    std::memcpy(&packet[kHeaderLen], params, len);
+  }
+  if (options_.framed) {
+    // leading delimiter flushes any garbage the target received before
+    std::vector<uint8_t> frame(1 + NCP_FRAME_ENCODED_LEN(packet.size()));
+    frame[0] = NCP_FRAME_DELIMITER;
+    frame.resize(1 + ncp_frame_encode(packet.data(), packet.size(), &frame[1]));
+    packet.swap(frame);
+  }
+
+  queue_.push_back(Pending{ msg_id(id), std::move(packet), std::promise<Response>() });
+  std::future<Response> future = queue_.back().promise.get_future();
+  start_next();
+  return future;
+}
+
+std::future<Host::Response> Host::user_command(uint8_t code, const void* params, size_t len)
+{
+  if (len > 254) {
+    throw std::length_error("NCP user command too long");
+  }
+  // uint8array: length byte, then the command code and its parameters
+  std::vector<uint8_t> payload(2 + len);
+  payload[0] = static_cast<uint8_t>(1 + len);
+  payload[1] = code;
+  if (len > 0) {
+    std::memcpy(&payload[2], params, len);
+  }
+  return command(Command::user_message_to_target, payload.data(), payload.size());
+}
+
+void Host::on_event(Event id, EventHandler handler)
+{
+  handlers_[static_cast<uint32_t>(id)] = std::move(handler);
+}
+
+void Host::on_any_event(EventHandler handler)
+{
+  any_handler_ = std::move(handler);
+}
+
+void Host::on_port(uint32_t events)
+{
+  if (events & EPOLLOUT) {
+    flush();
+  }
+  if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+    size_t received;
+    while ((received = port_.read(&rx_[rx_len_], rx_.size() - rx_len_)) > 0) {
+      rx_len_ += received;
+      parse();
+    }
+  }
+}
+
+void Host::on_timer()
+{
+  uint64_t expirations;
+  if (::read(timer_fd_, &expirations, sizeof(expirations)) < 0) {
+    return;
+  }
+  if (draining_) {
+    // no late response, the target dropped the command
+    draining_ = false;
+    start_next();
+    return;
+  }
+  if (!in_flight_) {
+    return;
+  }
+  queue_.front().promise.set_exception(
+    std::make_exception_ptr(std::runtime_error("NCP command timeout")));
+  queue_.pop_front();
+  in_flight_ = false;
+  draining_ = true;
+  arm_timer(true);
+}
+
+void Host::parse()
+{
+  size_t consumed = options_.framed ? parse_framed(rx_.data(), rx_len_)
+                    : parse_raw(rx_.data(), rx_len_);
+  if (consumed > 0) {
+    std::memmove(rx_.data(), &rx_[consumed], rx_len_ - consumed);
+    rx_len_ -= consumed;
+  }
+}
+
+size_t Host::parse_raw(uint8_t* data, size_t len)
+{
+  size_t pos = 0;
+  while (len - pos >= kHeaderLen) {
+    if ((data[pos] & kDevTypeMask) != kDevTypeGecko) {
+      // not a packet start, resynchronize byte by byte
+      pos++;
+      rx_errors_++;
+      continue;
+    }
+    uint32_t header = read_header(&data[pos]);
+    size_t total = kHeaderLen + msg_len(header);
+    if (len - pos < total) {
+      break;
+    }
+    dispatch(Packet{ header, &data[pos + kHeaderLen], msg_len(header) });
+    pos += total;
+  }
+  return pos;
+}
+
+size_t Host::parse_framed(uint8_t* data, size_t len)
+{
+  size_t start = 0;
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] != NCP_FRAME_DELIMITER) {
+      continue;
+    }
+    if (i > start) {
+      // decode in place, the payload is never longer than the frame
+      uint32_t decoded = ncp_frame_decode(&data[start], i - start, &data[start], i - start);
+      if (decoded >= kHeaderLen
+          && msg_len(read_header(&data[start])) + kHeaderLen == decoded) {
+        uint32_t header = read_header(&data[start]);
+        dispatch(Packet{ header, &data[start + kHeaderLen], msg_len(header) });
+      } else {
+        rx_errors_++;
+      }
+    }
+    start = i + 1;
+  }
+  if (start == 0 && len == rx_.size()) {
+    // no delimiter in a full buffer
+    rx_errors_++;
+    return len;
+  }
+  return start;
+}
+
+void Host::dispatch(const Packet& packet)
+{
+  if (packet.is_event()) {
+    auto it = handlers_.find(packet.id());
+    if (it != handlers_.end()) {
+      it->second(packet);
+    } else if (any_handler_) {
+      any_handler_(packet);
+    }
+    return;
+  }
+  if (draining_) {
+    // late response to the command that timed out
+    rx_errors_++;
+    draining_ = false;
+    arm_timer(false);
+    start_next();
+    return;
+  }
+  if (!in_flight_ || queue_.front().id != packet.id()) {
+    // response to no command
+    rx_errors_++;
+    return;
+  }
+  arm_timer(false);
+  Pending done = std::move(queue_.front());
+  queue_.pop_front();
+  in_flight_ = false;
+  // write the next command before running any continuation of this one
+  start_next();
+  done.promise.set_value(Response(packet.payload, packet.payload + packet.len));
+}
+
+void Host::start_next()
+{
+  // a command that timed out while being written is finished first
+  if (in_flight_ || draining_ || queue_.empty() || tx_offset_ < tx_.size()) {
+    return;
+  }
+  in_flight_ = true;
+  tx_.swap(queue_.front().packet);
+  tx_offset_ = 0;
+  arm_timer(true);
+  flush();
+}
+
+void Host::flush()
+{
+  while (tx_offset_ < tx_.size()) {
+    size_t written = port_.write(&tx_[tx_offset_], tx_.size() - tx_offset_);
+    if (written == 0) {
+      if (!want_write_) {
+        reactor_.modify(port_.fd(), EPOLLIN | EPOLLOUT);
+        want_write_ = true;
+      }
+      return;
+    }
+    tx_offset_ += written;
+  }
+  if (want_write_) {
+    reactor_.modify(port_.fd(), EPOLLIN);
+    want_write_ = false;
+  }
+  if (!in_flight_) {
+    // the rest of a command that timed out went out
+    start_next();
+  }
+}
+
+void Host::arm_timer(bool enable)
+{
+  struct itimerspec spec = {};
+  if (enable) {
+    spec.it_value.tv_sec = options_.command_timeout_ms / 1000;
+    spec.it_value.tv_nsec = (options_.command_timeout_ms % 1000) * 1000000L;
+  }
+  timerfd_settime(timer_fd_, 0, &spec, nullptr);
+}
+
+} // namespace ncp
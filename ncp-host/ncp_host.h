@@ -0,0 +1,114 @@
+/***************************************************************************//**
+ * @file
+ * @brief Asynchronous host library for the Silabs NCP target
+ ******************************************************************************/
+
+#ifndef NCP_HOST_NCP_HOST_H_
+#define NCP_HOST_NCP_HOST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <unordered_map>
+#include <vector>
+
+#include "ncp_ids.h"
+#include "reactor.h"
+#include "serial_port.h"
+
+namespace ncp {
+
+// BGAPI packet header layout, see BGLIB_MSG_* in ncp_gecko.h
+constexpr size_t kHeaderLen = 4;
+constexpr size_t kMaxPacketLen = kHeaderLen + 0x7ff;
+constexpr uint32_t msg_id(uint32_t header) { return header & 0xffff00f8; }
+constexpr size_t msg_len(uint32_t header) { return ((header & 0x7) << 8) | ((header & 0xff00) >> 8); }
+
+// View of a packet in the receive buffer, only valid during the handler call
+struct Packet {
+  uint32_t header;
+  const uint8_t* payload;
+  size_t len;
+
+  uint32_t id() const { return msg_id(header); }
+  bool is_event() const { return (header & 0x80) != 0; }
+};
+
+class Host {
+public:
+  struct Options {
+    // COBS/CRC-16 framing, must match NCP_USART_FRAMING_ENABLED on the target
+    bool framed = false;
+    int command_timeout_ms = 1000;
+  };
+  using EventHandler = std::function<void(const Packet&)>;
+  using Response = std::vector<uint8_t>;
+
+  Host(Reactor& reactor, SerialPort& port, Options options);
+  Host(Reactor& reactor, SerialPort& port) : Host(reactor, port, Options()) {}
+  ~Host();
+  Host(const Host&) = delete;
+  Host& operator=(const Host&) = delete;
+
+  // Queue a command, the future gets the response payload. The target
+  // handles a single command at a time, so queued commands are pipelined
+  // on the host: the next one is written as soon as a response arrives.
+  std::future<Response> command(Command id, const void* params, size_t len);
+  std::future<Response> command(uint32_t id, const void* params, size_t len);
+  // Queue a user command (see user_command.h on the target)
+  std::future<Response> user_command(uint8_t code, const void* params, size_t len);
+
+  // Handlers run in the reactor thread, on_event() handlers take precedence
+  void on_event(Event id, EventHandler handler);
+  void on_any_event(EventHandler handler);
+
+  // Number of commands queued or waiting for a response
+  size_t pending() const { return queue_.size(); }
+  // Bytes dropped while resynchronizing and corrupted frames
+  uint64_t rx_errors() const { return rx_errors_; }
+
+private:
+  struct Pending {
+    uint32_t id;
+    std::vector<uint8_t> packet;
+    std::promise<Response> promise;
+  };
+
+  void on_port(uint32_t events);
+  void on_timer();
+  void parse();
+  size_t parse_raw(uint8_t* data, size_t len);
+  size_t parse_framed(uint8_t* data, size_t len);
+  void dispatch(const Packet& packet);
+  void start_next();
+  void flush();
+  void arm_timer(bool enable);
+
+  Reactor& reactor_;
+  SerialPort& port_;
+  Options options_;
+  int timer_fd_;
+
+  std::deque<Pending> queue_;
+  bool in_flight_ = false;
+  // A command timed out, the next one waits one more timeout for a late
+  // response so it cannot be taken for the response of a command with the
+  // same ID
+  bool draining_ = false;
+  std::vector<uint8_t> tx_;
+  size_t tx_offset_ = 0;
+  bool want_write_ = false;
+
+  std::vector<uint8_t> rx_;
+  size_t rx_len_ = 0;
+  uint64_t rx_errors_ = 0;
+
+  std::unordered_map<uint32_t, EventHandler> handlers_;
+  EventHandler any_handler_;
+};
+
+} // namespace ncp
+
+#endif // NCP_HOST_NCP_HOST_H_
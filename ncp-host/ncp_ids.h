@@ -0,0 +1,284 @@
+// Generated by gen_ids.py from ncp_gecko.h, do not edit.
+
+#ifndef NCP_IDS_H_
+#define NCP_IDS_H_
+
+#include <cstdint>
+
+namespace ncp {
+
+enum class Command : uint32_t {
+  dfu_reset = 0x00000020,
+  dfu_flash_set_address = 0x01000020,
+  dfu_flash_upload = 0x02000020,
+  dfu_flash_upload_finish = 0x03000020,
+  system_hello = 0x00010020,
+  system_reset = 0x01010020,
+  system_get_bt_address = 0x03010020,
+  system_set_bt_address = 0x04010020,
+  system_set_tx_power = 0x0a010020,
+  system_get_random_data = 0x0b010020,
+  system_halt = 0x0c010020,
+  system_set_device_name = 0x0d010020,
+  system_linklayer_configure = 0x0e010020,
+  system_get_counters = 0x0f010020,
+  system_set_identity_address = 0x13010020,
+  le_gap_open = 0x00030020,
+  le_gap_set_mode = 0x01030020,
+  le_gap_discover = 0x02030020,
+  le_gap_end_procedure = 0x03030020,
+  le_gap_set_adv_parameters = 0x04030020,
+  le_gap_set_conn_parameters = 0x05030020,
+  le_gap_set_scan_parameters = 0x06030020,
+  le_gap_set_adv_data = 0x07030020,
+  le_gap_set_adv_timeout = 0x08030020,
+  le_gap_bt5_set_mode = 0x0a030020,
+  le_gap_bt5_set_adv_parameters = 0x0b030020,
+  le_gap_bt5_set_adv_data = 0x0c030020,
+  le_gap_set_privacy_mode = 0x0d030020,
+  le_gap_set_advertise_timing = 0x0e030020,
+  le_gap_set_advertise_channel_map = 0x0f030020,
+  le_gap_set_advertise_report_scan_request = 0x10030020,
+  le_gap_set_advertise_phy = 0x11030020,
+  le_gap_set_advertise_configuration = 0x12030020,
+  le_gap_clear_advertise_configuration = 0x13030020,
+  le_gap_start_advertising = 0x14030020,
+  le_gap_stop_advertising = 0x15030020,
+  le_gap_set_discovery_timing = 0x16030020,
+  le_gap_set_discovery_type = 0x17030020,
+  le_gap_start_discovery = 0x18030020,
+  le_gap_set_data_channel_classification = 0x19030020,
+  le_gap_connect = 0x1a030020,
+  le_gap_set_advertise_tx_power = 0x1b030020,
+  le_gap_set_discovery_extended_scan_response = 0x1c030020,
+  le_gap_start_periodic_advertising = 0x1d030020,
+  le_gap_stop_periodic_advertising = 0x1f030020,
+  le_gap_enable_whitelisting = 0x21030020,
+  sync_open = 0x00420020,
+  sync_close = 0x01420020,
+  le_connection_set_parameters = 0x00080020,
+  le_connection_get_rssi = 0x01080020,
+  le_connection_disable_slave_latency = 0x02080020,
+  le_connection_set_phy = 0x03080020,
+  le_connection_close = 0x04080020,
+  gatt_set_max_mtu = 0x00090020,
+  gatt_discover_primary_services = 0x01090020,
+  gatt_discover_primary_services_by_uuid = 0x02090020,
+  gatt_discover_characteristics = 0x03090020,
+  gatt_discover_characteristics_by_uuid = 0x04090020,
+  gatt_set_characteristic_notification = 0x05090020,
+  gatt_discover_descriptors = 0x06090020,
+  gatt_read_characteristic_value = 0x07090020,
+  gatt_read_characteristic_value_by_uuid = 0x08090020,
+  gatt_write_characteristic_value = 0x09090020,
+  gatt_write_characteristic_value_without_response = 0x0a090020,
+  gatt_prepare_characteristic_value_write = 0x0b090020,
+  gatt_execute_characteristic_value_write = 0x0c090020,
+  gatt_send_characteristic_confirmation = 0x0d090020,
+  gatt_read_descriptor_value = 0x0e090020,
+  gatt_write_descriptor_value = 0x0f090020,
+  gatt_find_included_services = 0x10090020,
+  gatt_read_multiple_characteristic_values = 0x11090020,
+  gatt_read_characteristic_value_from_offset = 0x12090020,
+  gatt_prepare_characteristic_value_reliable_write = 0x13090020,
+  gatt_server_read_attribute_value = 0x000a0020,
+  gatt_server_read_attribute_type = 0x010a0020,
+  gatt_server_write_attribute_value = 0x020a0020,
+  gatt_server_send_user_read_response = 0x030a0020,
+  gatt_server_send_user_write_response = 0x040a0020,
+  gatt_server_send_characteristic_notification = 0x050a0020,
+  gatt_server_find_attribute = 0x060a0020,
+  gatt_server_set_capabilities = 0x080a0020,
+  hardware_set_soft_timer = 0x000c0020,
+  hardware_get_time = 0x0b0c0020,
+  hardware_set_lazy_soft_timer = 0x0c0c0020,
+  flash_ps_erase_all = 0x010d0020,
+  flash_ps_save = 0x020d0020,
+  flash_ps_load = 0x030d0020,
+  flash_ps_erase = 0x040d0020,
+  test_dtm_tx = 0x000e0020,
+  test_dtm_rx = 0x010e0020,
+  test_dtm_end = 0x020e0020,
+  sm_set_bondable_mode = 0x000f0020,
+  sm_configure = 0x010f0020,
+  sm_store_bonding_configuration = 0x020f0020,
+  sm_increase_security = 0x040f0020,
+  sm_delete_bonding = 0x060f0020,
+  sm_delete_bondings = 0x070f0020,
+  sm_enter_passkey = 0x080f0020,
+  sm_passkey_confirm = 0x090f0020,
+  sm_set_oob_data = 0x0a0f0020,
+  sm_list_all_bondings = 0x0b0f0020,
+  sm_bonding_confirm = 0x0e0f0020,
+  sm_set_debug_mode = 0x0f0f0020,
+  sm_set_passkey = 0x100f0020,
+  sm_use_sc_oob = 0x110f0020,
+  sm_set_sc_remote_oob_data = 0x120f0020,
+  sm_add_to_whitelist = 0x130f0020,
+  homekit_configure = 0x00130020,
+  homekit_advertise = 0x01130020,
+  homekit_delete_pairings = 0x02130020,
+  homekit_check_authcp = 0x03130020,
+  homekit_get_pairing_id = 0x04130020,
+  homekit_send_write_response = 0x05130020,
+  homekit_send_read_response = 0x06130020,
+  homekit_gsn_action = 0x07130020,
+  homekit_event_notification = 0x08130020,
+  homekit_broadcast_action = 0x09130020,
+  coex_set_options = 0x00200020,
+  coex_get_counters = 0x01200020,
+  l2cap_coc_send_connection_request = 0x01430020,
+  l2cap_coc_send_connection_response = 0x02430020,
+  l2cap_coc_send_le_flow_control_credit = 0x03430020,
+  l2cap_coc_send_disconnection_request = 0x04430020,
+  l2cap_coc_send_data = 0x05430020,
+  cte_transmitter_enable_cte_response = 0x00440020,
+  cte_transmitter_disable_cte_response = 0x01440020,
+  cte_transmitter_start_connectionless_cte = 0x02440020,
+  cte_transmitter_stop_connectionless_cte = 0x03440020,
+  cte_transmitter_set_dtm_parameters = 0x04440020,
+  cte_transmitter_clear_dtm_parameters = 0x05440020,
+  cte_receiver_configure = 0x00450020,
+  cte_receiver_start_iq_sampling = 0x01450020,
+  cte_receiver_stop_iq_sampling = 0x02450020,
+  cte_receiver_start_connectionless_iq_sampling = 0x03450020,
+  cte_receiver_stop_connectionless_iq_sampling = 0x04450020,
+  cte_receiver_set_dtm_parameters = 0x05450020,
+  cte_receiver_clear_dtm_parameters = 0x06450020,
+  user_message_to_target = 0x00ff0020,
+};
+
+enum class Event : uint32_t {
+  dfu_boot = 0x000000a0,
+  dfu_boot_failure = 0x010000a0,
+  system_boot = 0x000100a0,
+  system_external_signal = 0x030100a0,
+  system_awake = 0x040100a0,
+  system_hardware_error = 0x050100a0,
+  system_error = 0x060100a0,
+  le_gap_scan_response = 0x000300a0,
+  le_gap_adv_timeout = 0x010300a0,
+  le_gap_scan_request = 0x020300a0,
+  le_gap_extended_scan_response = 0x040300a0,
+  sync_opened = 0x004200a0,
+  sync_closed = 0x014200a0,
+  sync_data = 0x024200a0,
+  le_connection_opened = 0x000800a0,
+  le_connection_closed = 0x010800a0,
+  le_connection_parameters = 0x020800a0,
+  le_connection_rssi = 0x030800a0,
+  le_connection_phy_status = 0x040800a0,
+  gatt_mtu_exchanged = 0x000900a0,
+  gatt_service = 0x010900a0,
+  gatt_characteristic = 0x020900a0,
+  gatt_descriptor = 0x030900a0,
+  gatt_characteristic_value = 0x040900a0,
+  gatt_descriptor_value = 0x050900a0,
+  gatt_procedure_completed = 0x060900a0,
+  gatt_server_attribute_value = 0x000a00a0,
+  gatt_server_user_read_request = 0x010a00a0,
+  gatt_server_user_write_request = 0x020a00a0,
+  gatt_server_characteristic_status = 0x030a00a0,
+  gatt_server_execute_write_completed = 0x040a00a0,
+  hardware_soft_timer = 0x000c00a0,
+  test_dtm_completed = 0x000e00a0,
+  sm_passkey_display = 0x000f00a0,
+  sm_passkey_request = 0x010f00a0,
+  sm_confirm_passkey = 0x020f00a0,
+  sm_bonded = 0x030f00a0,
+  sm_bonding_failed = 0x040f00a0,
+  sm_list_bonding_entry = 0x050f00a0,
+  sm_list_all_bondings_complete = 0x060f00a0,
+  sm_confirm_bonding = 0x090f00a0,
+  homekit_setupcode_display = 0x001300a0,
+  homekit_paired = 0x011300a0,
+  homekit_pair_verified = 0x021300a0,
+  homekit_connection_opened = 0x031300a0,
+  homekit_connection_closed = 0x041300a0,
+  homekit_identify = 0x051300a0,
+  homekit_write_request = 0x061300a0,
+  homekit_read_request = 0x071300a0,
+  homekit_disconnection_required = 0x081300a0,
+  homekit_pairing_removed = 0x091300a0,
+  homekit_setuppayload_display = 0x0a1300a0,
+  l2cap_coc_connection_request = 0x014300a0,
+  l2cap_coc_connection_response = 0x024300a0,
+  l2cap_coc_le_flow_control_credit = 0x034300a0,
+  l2cap_coc_channel_disconnected = 0x044300a0,
+  l2cap_coc_data = 0x054300a0,
+  l2cap_command_rejected = 0x064300a0,
+  cte_receiver_iq_report = 0x004500a0,
+  user_message_to_host = 0x00ff00a0,
+};
+
+// Name of an event ID, nullptr if unknown
+inline const char* event_name(uint32_t id)
+{
+  switch (id) {
+    case 0x000000a0: return "dfu_boot";
+    case 0x010000a0: return "dfu_boot_failure";
+    case 0x000100a0: return "system_boot";
+    case 0x030100a0: return "system_external_signal";
+    case 0x040100a0: return "system_awake";
+    case 0x050100a0: return "system_hardware_error";
+    case 0x060100a0: return "system_error";
+    case 0x000300a0: return "le_gap_scan_response";
+    case 0x010300a0: return "le_gap_adv_timeout";
+    case 0x020300a0: return "le_gap_scan_request";
+    case 0x040300a0: return "le_gap_extended_scan_response";
+    case 0x004200a0: return "sync_opened";
+    case 0x014200a0: return "sync_closed";
+    case 0x024200a0: return "sync_data";
+    case 0x000800a0: return "le_connection_opened";
+    case 0x010800a0: return "le_connection_closed";
+    case 0x020800a0: return "le_connection_parameters";
+    case 0x030800a0: return "le_connection_rssi";
+    case 0x040800a0: return "le_connection_phy_status";
+    case 0x000900a0: return "gatt_mtu_exchanged";
+    case 0x010900a0: return "gatt_service";
+    case 0x020900a0: return "gatt_characteristic";
+    case 0x030900a0: return "gatt_descriptor";
+    case 0x040900a0: return "gatt_characteristic_value";
+    case 0x050900a0: return "gatt_descriptor_value";
+    case 0x060900a0: return "gatt_procedure_completed";
+    case 0x000a00a0: return "gatt_server_attribute_value";
+    case 0x010a00a0: return "gatt_server_user_read_request";
+    case 0x020a00a0: return "gatt_server_user_write_request";
+    case 0x030a00a0: return "gatt_server_characteristic_status";
+    case 0x040a00a0: return "gatt_server_execute_write_completed";
+    case 0x000c00a0: return "hardware_soft_timer";
+    case 0x000e00a0: return "test_dtm_completed";
+    case 0x000f00a0: return "sm_passkey_display";
+    case 0x010f00a0: return "sm_passkey_request";
+    case 0x020f00a0: return "sm_confirm_passkey";
+    case 0x030f00a0: return "sm_bonded";
+    case 0x040f00a0: return "sm_bonding_failed";
+    case 0x050f00a0: return "sm_list_bonding_entry";
+    case 0x060f00a0: return "sm_list_all_bondings_complete";
+    case 0x090f00a0: return "sm_confirm_bonding";
+    case 0x001300a0: return "homekit_setupcode_display";
+    case 0x011300a0: return "homekit_paired";
+    case 0x021300a0: return "homekit_pair_verified";
+    case 0x031300a0: return "homekit_connection_opened";
+    case 0x041300a0: return "homekit_connection_closed";
+    case 0x051300a0: return "homekit_identify";
+    case 0x061300a0: return "homekit_write_request";
+    case 0x071300a0: return "homekit_read_request";
+    case 0x081300a0: return "homekit_disconnection_required";
+    case 0x091300a0: return "homekit_pairing_removed";
+    case 0x0a1300a0: return "homekit_setuppayload_display";
+    case 0x014300a0: return "l2cap_coc_connection_request";
+    case 0x024300a0: return "l2cap_coc_connection_response";
+    case 0x034300a0: return "l2cap_coc_le_flow_control_credit";
+    case 0x044300a0: return "l2cap_coc_channel_disconnected";
+    case 0x054300a0: return "l2cap_coc_data";
+    case 0x064300a0: return "l2cap_command_rejected";
+    case 0x004500a0: return "cte_receiver_iq_report";
+    case 0x00ff00a0: return "user_message_to_host";
+    default: return nullptr;
+  }
+}
+
+} // namespace ncp
+
+#endif // NCP_IDS_H_
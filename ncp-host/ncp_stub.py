@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+"""Simulated NCP target behind a pty, to run the host library without a module.
+
+Prints the pty path and answers BGAPI commands on it the way
+BLE-ncp-empty-target does:
+
+    ./ncp_stub.py &
+    ./ncp_bench /dev/pts/5 -n 10000 -q 8
+
+system_hello succeeds, the UART baud rate user commands succeed (the pty has
+no baud rate, the switch only exercises the host side) and every other command
+gets bg_err_not_implemented. --drop and --delay-ms leave commands unanswered
+or answer them late to exercise the command timeout of the host, --events
+sends le_gap_scan_response events between the responses.
+"""
+
+import argparse
+import os
+import select
+import struct
+import sys
+import time
+import tty
+
+DEV_TYPE_MASK = 0x78
+DEV_TYPE_GECKO = 0x20
+MSG_TYPE_EVT = 0x80
+HEADER_LEN = 4
+
+CMD_SYSTEM_HELLO = 0x00010020
+CMD_USER_MESSAGE_TO_TARGET = 0x00ff0020
+EVT_SYSTEM_BOOT = 0x000100a0
+EVT_LE_GAP_SCAN_RESPONSE = 0x000300a0
+
+# user_command.h of the target
+USER_CMD_UART_BAUD_SET = 0x10
+USER_CMD_UART_BAUD_CONFIRM = 0x11
+
+BG_ERR_SUCCESS = 0x0000
+BG_ERR_INVALID_PARAM = 0x0180
+BG_ERR_NOT_IMPLEMENTED = 0x020e
+
+FRAME_DELIMITER = 0x00
+
+
+def msg_id(header):
+    return header & 0xffff00f8
+
+
+def msg_len(header):
+    return ((header & 0x7) << 8) | ((header & 0xff00) >> 8)
+
+
+def packet(msg, payload=b''):
+    header = msg | ((len(payload) & 0xff) << 8) | ((len(payload) >> 8) & 0x7)
+    return struct.pack('<I', header) + payload
+
+
+def crc16(data, crc=0xffff):
+    """CRC-16/CCITT-FALSE, the same as ncp_frame_crc16()"""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+        crc &= 0xffff
+    return crc
+
+
+def frame_encode(payload):
+    """COBS with the CRC appended, the same as ncp_frame_encode()"""
+    data = payload + struct.pack('<H', crc16(payload))
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out += bytes([len(block) + 1]) + block
+            block = bytearray()
+        else:
+            block.append(byte)
+            if len(block) == 0xfe:
+                out += b'\xff' + block
+                block = bytearray()
+    out += bytes([len(block) + 1]) + block
+    out.append(FRAME_DELIMITER)
+    return bytes(out)
+
+
+def frame_decode(frame):
+    """Payload of a frame without its delimiter, None if corrupted"""
+    out = bytearray()
+    pos = 0
+    while pos < len(frame):
+        code = frame[pos]
+        block = frame[pos + 1:pos + code]
+        if code == 0 or len(block) != code - 1 or FRAME_DELIMITER in block:
+            return None
+        out += block
+        pos += code
+        if code != 0xff and pos < len(frame):
+            out.append(0)
+    if len(out) < 2 or crc16(out[:-2]) != struct.unpack('<H', out[-2:])[0]:
+        return None
+    return bytes(out[:-2])
+
+
+class Target:
+    def __init__(self, fd, args):
+        self.fd = fd
+        self.args = args
+        self.rx = bytearray()
+        self.commands = 0
+        self.delayed = []
+        self.events = 0
+
+    def send(self, data):
+        if self.args.framed:
+            data = frame_encode(data)
+        view = memoryview(data)
+        while view:
+            try:
+                view = view[os.write(self.fd, view):]
+            except BlockingIOError:
+                select.select([], [self.fd], [])
+
+    def receive(self, data):
+        self.rx += data
+        if self.args.framed:
+            while FRAME_DELIMITER in self.rx:
+                end = self.rx.index(FRAME_DELIMITER)
+                frame = bytes(self.rx[:end])
+                del self.rx[:end + 1]
+                payload = frame_decode(frame) if frame else None
+                if payload is not None and len(payload) >= HEADER_LEN:
+                    self.command(payload)
+            return
+        while len(self.rx) >= HEADER_LEN:
+            if self.rx[0] & DEV_TYPE_MASK != DEV_TYPE_GECKO:
+                del self.rx[0]
+                continue
+            total = HEADER_LEN + msg_len(struct.unpack_from('<I', self.rx)[0])
+            if len(self.rx) < total:
+                break
+            self.command(bytes(self.rx[:total]))
+            del self.rx[:total]
+
+    def command(self, data):
+        header = struct.unpack_from('<I', data)[0]
+        params = data[HEADER_LEN:HEADER_LEN + msg_len(header)]
+        self.commands += 1
+        if self.args.drop and self.commands % self.args.drop == 0:
+            return
+        rsp = packet(msg_id(header), self.response(msg_id(header), params))
+        if self.args.delay_ms:
+            self.delayed.append((time.monotonic() + self.args.delay_ms / 1000.0, rsp))
+        else:
+            self.send(rsp)
+
+    def response(self, msg, params):
+        if msg == CMD_SYSTEM_HELLO:
+            return struct.pack('<H', BG_ERR_SUCCESS)
+        if msg == CMD_USER_MESSAGE_TO_TARGET and len(params) >= 2:
+            # uint8array: length, command code, parameters
+            code, data = params[1], params[2:1 + params[0]]
+            if code == USER_CMD_UART_BAUD_SET and len(data) >= 4:
+                return self.user_response(BG_ERR_SUCCESS, code, data[:4])
+            if code == USER_CMD_UART_BAUD_CONFIRM:
+                return self.user_response(BG_ERR_SUCCESS, code, data)
+            return self.user_response(BG_ERR_INVALID_PARAM, code, b'')
+        return struct.pack('<H', BG_ERR_NOT_IMPLEMENTED)
+
+    @staticmethod
+    def user_response(result, code, data):
+        return struct.pack('<HBB', result, 1 + len(data), code) + data
+
+    def event(self):
+        self.events += 1
+        # rssi, packet_type, address, address_type, bonding, data
+        payload = struct.pack('<bB6sBBB', -60, 0, struct.pack('<IH', self.events, 0),
+                              0, 0xff, 3) + b'\x02\x01\x06'
+        self.send(packet(EVT_LE_GAP_SCAN_RESPONSE, payload))
+
+    def poll(self):
+        now = time.monotonic()
+        while self.delayed and self.delayed[0][0] <= now:
+            self.send(self.delayed.pop(0)[1])
+        return (max(0.0, self.delayed[0][0] - now)) if self.delayed else None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-f', '--framed', action='store_true',
+                        help='COBS/CRC-16 framing, as NCP_USART_FRAMING_ENABLED')
+    parser.add_argument('--events', type=float, default=0,
+                        help='scan response events per second')
+    parser.add_argument('--drop', type=int, default=0, metavar='N',
+                        help='leave every Nth command unanswered')
+    parser.add_argument('--delay-ms', type=int, default=0,
+                        help='answer every command this late')
+    args = parser.parse_args()
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    os.set_blocking(master, False)
+    print(os.ttyname(slave), flush=True)
+
+    target = Target(master, args)
+    target.send(packet(EVT_SYSTEM_BOOT, struct.pack('<HHHHIHI', 2, 13, 0, 0, 0, 1, 0)))
+    next_event = time.monotonic()
+    while True:
+        timeout = target.poll()
+        if args.events:
+            wait = max(0.0, next_event - time.monotonic())
+            timeout = wait if timeout is None else min(timeout, wait)
+        readable, _, _ = select.select([master], [], [], timeout)
+        if readable:
+            try:
+                target.receive(os.read(master, 4096))
+            except BlockingIOError:
+                pass
+        if args.events and time.monotonic() >= next_event:
+            target.event()
+            next_event += 1.0 / args.events
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except KeyboardInterrupt:
+        sys.exit(0)
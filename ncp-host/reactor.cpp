@@ -0,0 +1,82 @@
+/***************************************************************************//**
+ * @file
+ * @brief epoll based event loop for the NCP host library
+ ******************************************************************************/
+
+#include "reactor.h"
+
+#include <cerrno>
+#include <system_error>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace ncp {
+
+Reactor::Reactor()
+  : epoll_fd_(epoll_create1(EPOLL_CLOEXEC))
+{
+  if (epoll_fd_ < 0) {
+    throw std::system_error(errno, std::generic_category(), "epoll_create1");
+  }
+}
+
+Reactor::~Reactor()
+{
+  ::close(epoll_fd_);
+}
+
+void Reactor::add(int fd, uint32_t events, Handler handler)
+{
+  struct epoll_event ev = {};
+  ev.events = events;
+  ev.data.fd = fd;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+    throw std::system_error(errno, std::generic_category(), "epoll_ctl add");
+  }
+  handlers_[fd] = std::make_shared<Handler>(std::move(handler));
+}
+
+void Reactor::modify(int fd, uint32_t events)
+{
+  struct epoll_event ev = {};
+  ev.events = events;
+  ev.data.fd = fd;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) < 0) {
+    throw std::system_error(errno, std::generic_category(), "epoll_ctl mod");
+  }
+}
+
+void Reactor::remove(int fd)
+{
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  handlers_.erase(fd);
+}
+
+void Reactor::run_once(int timeout_ms)
+{
+  struct epoll_event events[16];
+  int count = epoll_wait(epoll_fd_, events, 16, timeout_ms);
+  if (count < 0) {
+    if (errno == EINTR) {
+      return;
+    }
+    throw std::system_error(errno, std::generic_category(), "epoll_wait");
+  }
+  for (int i = 0; i < count; i++) {
+    auto it = handlers_.find(events[i].data.fd);
+    if (it != handlers_.end()) {
+      std::shared_ptr<Handler> handler = it->second;
+      (*handler)(events[i].events);
+    }
+  }
+}
+
+void Reactor::run()
+{
+  running_ = true;
+  while (running_) {
+    run_once(-1);
+  }
+}
+
+} // namespace ncp
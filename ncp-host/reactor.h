@@ -0,0 +1,46 @@
+/***************************************************************************//**
+ * @file
+ * @brief epoll based event loop for the NCP host library
+ ******************************************************************************/
+
+#ifndef NCP_HOST_REACTOR_H_
+#define NCP_HOST_REACTOR_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace ncp {
+
+// Single threaded reactor. Handlers run in the thread calling run() or
+// run_once() and receive the ready epoll events.
+class Reactor {
+public:
+  using Handler = std::function<void(uint32_t events)>;
+
+  Reactor();
+  ~Reactor();
+  Reactor(const Reactor&) = delete;
+  Reactor& operator=(const Reactor&) = delete;
+
+  void add(int fd, uint32_t events, Handler handler);
+  void modify(int fd, uint32_t events);
+  void remove(int fd);
+
+  // Wait up to timeout_ms (-1 forever) and dispatch ready handlers
+  void run_once(int timeout_ms);
+  // Dispatch until stop() is called
+  void run();
+  void stop() { running_ = false; }
+
+private:
+  int epoll_fd_;
+  bool running_ = false;
+  // shared so a handler may remove itself while running
+  std::unordered_map<int, std::shared_ptr<Handler>> handlers_;
+};
+
+} // namespace ncp
+
+#endif // NCP_HOST_REACTOR_H_
@@ -0,0 +1,90 @@
+/***************************************************************************//**
+ * @file
+ * @brief Non-blocking serial port for the NCP host library
+ ******************************************************************************/
+
+#include "serial_port.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <system_error>
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace ncp {
+
+SerialPort::~SerialPort()
+{
+  close();
+}
+
+void SerialPort::open(const std::string& path, uint32_t baudrate, bool flow_control)
+{
+  close();
+  fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (fd_ < 0) {
+    throw std::system_error(errno, std::generic_category(), "open " + path);
+  }
+  flow_control_ = flow_control;
+  set_baudrate(baudrate);
+}
+
+void SerialPort::close()
+{
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+void SerialPort::set_baudrate(uint32_t baudrate)
+{
+  // termios2 accepts any baud rate, not only the Bxxx constants
+  struct termios2 tio;
+  if (ioctl(fd_, TCGETS2, &tio) < 0) {
+    // not a tty, e.g. a socket used in place of a pty
+    return;
+  }
+  tio.c_iflag = 0;
+  tio.c_oflag = 0;
+  tio.c_lflag = 0;
+  tio.c_cflag = CS8 | CREAD | CLOCAL | BOTHER;
+  if (flow_control_) {
+    tio.c_cflag |= CRTSCTS;
+  }
+  tio.c_ispeed = baudrate;
+  tio.c_ospeed = baudrate;
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  // let pending output go out at the old baud rate first
+  if (ioctl(fd_, TCSETSW2, &tio) < 0) {
+    throw std::system_error(errno, std::generic_category(), "set baud rate");
+  }
+}
+
+size_t SerialPort::read(uint8_t* data, size_t len)
+{
+  ssize_t ret = ::read(fd_, data, len);
+  if (ret < 0) {
+    if (errno == EAGAIN || errno == EINTR) {
+      return 0;
+    }
+    throw std::system_error(errno, std::generic_category(), "read");
+  }
+  return static_cast<size_t>(ret);
+}
+
+size_t SerialPort::write(const uint8_t* data, size_t len)
+{
+  ssize_t ret = ::write(fd_, data, len);
+  if (ret < 0) {
+    if (errno == EAGAIN || errno == EINTR) {
+      return 0;
+    }
+    throw std::system_error(errno, std::generic_category(), "write");
+  }
+  return static_cast<size_t>(ret);
+}
+
+} // namespace ncp
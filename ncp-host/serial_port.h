@@ -0,0 +1,44 @@
+/***************************************************************************//**
+ * @file
+ * @brief Non-blocking serial port for the NCP host library
+ ******************************************************************************/
+
+#ifndef NCP_HOST_SERIAL_PORT_H_
+#define NCP_HOST_SERIAL_PORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+namespace ncp {
+
+// Raw, non-blocking serial port or pty. Hardware flow control is enabled
+// when requested so the NCP target can use RTS/CTS.
+class SerialPort {
+public:
+  SerialPort() = default;
+  ~SerialPort();
+  SerialPort(const SerialPort&) = delete;
+  SerialPort& operator=(const SerialPort&) = delete;
+
+  // Throws std::system_error on failure
+  void open(const std::string& path, uint32_t baudrate, bool flow_control = false);
+  void close();
+  // Reprogram the baud rate, e.g. after USER_CMD_UART_BAUD_SET
+  void set_baudrate(uint32_t baudrate);
+
+  // Return the number of bytes transferred, 0 if the call would block
+  size_t read(uint8_t* data, size_t len);
+  size_t write(const uint8_t* data, size_t len);
+
+  int fd() const { return fd_; }
+
+private:
+  int fd_ = -1;
+  bool flow_control_ = false;
+};
+
+} // namespace ncp
+
+#endif // NCP_HOST_SERIAL_PORT_H_
@@ -0,0 +1,43 @@
+// Host build of the NCP SPI transport, see spi_sim.c
+#ifndef SPI_SIM_DMADRV_H_
+#define SPI_SIM_DMADRV_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint32_t Ecode_t;
+
+#define ECODE_EMDRV_DMADRV_OK                   0
+#define ECODE_EMDRV_DMADRV_ALREADY_INITIALIZED  1
+
+typedef enum {
+  dmadrvPeripheralSignal_USART0_RXDATAV,
+  dmadrvPeripheralSignal_USART0_TXBL,
+  dmadrvPeripheralSignal_USART1_RXDATAV,
+  dmadrvPeripheralSignal_USART1_TXBL,
+  dmadrvPeripheralSignal_USART2_RXDATAV,
+  dmadrvPeripheralSignal_USART2_TXBL,
+  dmadrvPeripheralSignal_USART3_RXDATAV,
+  dmadrvPeripheralSignal_USART3_TXBL,
+} DMADRV_PeripheralSignal_t;
+
+typedef enum {
+  dmadrvDataSize1,
+} DMADRV_DataSize_t;
+
+typedef bool (*DMADRV_Callback_t)(unsigned int channel, unsigned int sequenceNo, void *userParam);
+
+Ecode_t DMADRV_Init(void);
+Ecode_t DMADRV_AllocateChannel(unsigned int *channelId, void *capabilities);
+Ecode_t DMADRV_PeripheralMemory(unsigned int channelId, DMADRV_PeripheralSignal_t peripheralSignal,
+                                void *dst, void *src, bool dstInc, int len,
+                                DMADRV_DataSize_t size, DMADRV_Callback_t callback,
+                                void *cbUserParam);
+Ecode_t DMADRV_MemoryPeripheral(unsigned int channelId, DMADRV_PeripheralSignal_t peripheralSignal,
+                                void *dst, void *src, bool srcInc, int len,
+                                DMADRV_DataSize_t size, DMADRV_Callback_t callback,
+                                void *cbUserParam);
+Ecode_t DMADRV_StopTransfer(unsigned int channelId);
+Ecode_t DMADRV_TransferRemainingCount(unsigned int channelId, int *remaining);
+
+#endif
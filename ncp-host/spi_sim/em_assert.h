@@ -0,0 +1,9 @@
+// Host build of the NCP SPI transport, see spi_sim.c
+#ifndef SPI_SIM_EM_ASSERT_H_
+#define SPI_SIM_EM_ASSERT_H_
+
+#include <assert.h>
+
+#define EFM_ASSERT(expr)    assert(expr)
+
+#endif
@@ -0,0 +1,21 @@
+// Host build of the NCP SPI transport, see spi_sim.c
+#ifndef SPI_SIM_EM_CMU_H_
+#define SPI_SIM_EM_CMU_H_
+
+#include <stdbool.h>
+
+typedef enum {
+  cmuClock_GPIO,
+  cmuClock_USART0,
+  cmuClock_USART1,
+  cmuClock_USART2,
+  cmuClock_USART3,
+} CMU_Clock_TypeDef;
+
+static inline void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable)
+{
+  (void)clock;
+  (void)enable;
+}
+
+#endif
@@ -0,0 +1,13 @@
+// Host build of the NCP SPI transport, see spi_sim.c. The simulation runs
+// the interrupt handlers between the main loop steps, never inside them, so
+// the critical sections need no lock.
+#ifndef SPI_SIM_EM_CORE_H_
+#define SPI_SIM_EM_CORE_H_
+
+#define CORE_DECLARE_IRQ_STATE          int irqState = 0
+#define CORE_ENTER_ATOMIC()             (void)irqState
+#define CORE_EXIT_ATOMIC()              (void)irqState
+#define CORE_ENTER_CRITICAL()           (void)irqState
+#define CORE_EXIT_CRITICAL()            (void)irqState
+
+#endif
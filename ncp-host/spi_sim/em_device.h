@@ -0,0 +1,33 @@
+// Host build of the NCP SPI transport, see spi_sim.c
+#ifndef SPI_SIM_EM_DEVICE_H_
+#define SPI_SIM_EM_DEVICE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+  volatile uint32_t CMD;
+  volatile uint32_t RXDATA;
+  volatile uint32_t TXDATA;
+  volatile uint32_t ROUTELOC0;
+  volatile uint32_t ROUTEPEN;
+} USART_TypeDef;
+
+extern USART_TypeDef spi_sim_usart;
+#define USART0                          (&spi_sim_usart)
+#define USART1                          (&spi_sim_usart)
+#define USART2                          (&spi_sim_usart)
+#define USART3                          (&spi_sim_usart)
+
+#define USART_CMD_CLEARRX               (1 << 11)
+#define USART_CMD_CLEARTX               (1 << 10)
+#define _USART_ROUTELOC0_RXLOC_SHIFT    0
+#define _USART_ROUTELOC0_TXLOC_SHIFT    8
+#define _USART_ROUTELOC0_CSLOC_SHIFT    16
+#define _USART_ROUTELOC0_CLKLOC_SHIFT   24
+#define USART_ROUTEPEN_RXPEN            (1 << 0)
+#define USART_ROUTEPEN_TXPEN            (1 << 1)
+#define USART_ROUTEPEN_CSPEN            (1 << 2)
+#define USART_ROUTEPEN_CLKPEN           (1 << 3)
+
+#endif
@@ -0,0 +1,31 @@
+// Host build of the NCP SPI transport, see spi_sim.c
+#ifndef SPI_SIM_EM_GPIO_H_
+#define SPI_SIM_EM_GPIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+  gpioPortA,
+  gpioPortB,
+  gpioPortC,
+  gpioPortD,
+  gpioPortE,
+  gpioPortF,
+} GPIO_Port_TypeDef;
+
+typedef enum {
+  gpioModeInput,
+  gpioModeInputPull,
+  gpioModePushPull,
+} GPIO_Mode_TypeDef;
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode,
+                     unsigned int out);
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_ExtIntConfig(GPIO_Port_TypeDef port, unsigned int pin, unsigned int intNo,
+                       bool risingEdge, bool fallingEdge, bool enable);
+
+#endif
@@ -0,0 +1,40 @@
+// Host build of the NCP SPI transport, see spi_sim.c
+#ifndef SPI_SIM_EM_USART_H_
+#define SPI_SIM_EM_USART_H_
+
+#include "em_device.h"
+
+typedef enum {
+  usartDisable,
+  usartEnable,
+} USART_Enable_TypeDef;
+
+typedef enum {
+  usartClockMode0,
+  usartClockMode1,
+  usartClockMode2,
+  usartClockMode3,
+} USART_ClockMode_TypeDef;
+
+typedef struct {
+  USART_Enable_TypeDef enable;
+  bool master;
+  bool msbf;
+  USART_ClockMode_TypeDef clockMode;
+} USART_InitSync_TypeDef;
+
+#define USART_INITSYNC_DEFAULT          { usartEnable, true, false, usartClockMode0 }
+
+static inline void USART_InitSync(USART_TypeDef *usart, const USART_InitSync_TypeDef *init)
+{
+  (void)usart;
+  (void)init;
+}
+
+static inline void USART_Enable(USART_TypeDef *usart, USART_Enable_TypeDef enable)
+{
+  (void)usart;
+  (void)enable;
+}
+
+#endif
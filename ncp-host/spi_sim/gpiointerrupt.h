@@ -0,0 +1,12 @@
+// Host build of the NCP SPI transport, see spi_sim.c
+#ifndef SPI_SIM_GPIOINTERRUPT_H_
+#define SPI_SIM_GPIOINTERRUPT_H_
+
+#include <stdint.h>
+
+typedef void (*GPIOINT_IrqCallbackPtr_t)(uint8_t pin);
+
+void GPIOINT_Init(void);
+void GPIOINT_CallbackRegister(uint8_t pin, GPIOINT_IrqCallbackPtr_t callbackPtr);
+
+#endif
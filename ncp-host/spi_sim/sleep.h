@@ -0,0 +1,17 @@
+// Host build of the NCP SPI transport, see spi_sim.c
+#ifndef SPI_SIM_SLEEP_H_
+#define SPI_SIM_SLEEP_H_
+
+typedef enum {
+  sleepEM0,
+  sleepEM1,
+  sleepEM2,
+  sleepEM3,
+} SLEEP_EnergyMode_t;
+
+static inline void SLEEP_SleepBlockBegin(SLEEP_EnergyMode_t mode)
+{
+  (void)mode;
+}
+
+#endif
@@ -0,0 +1,585 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host simulation of the NCP SPI transport
+ *
+ * Runs ncp_spi.c and ncp.c of BLE-ncp-empty-target on the host, with the
+ * USART, LDMA and GPIO replaced by a model of the wires, and plays the SPI
+ * master of ncp_spi.h. The NCP byte stream of the host is taken from a pty,
+ * so ncp_bench drives it like a module on a serial port:
+ *
+ *   spi_sim [-a abort_percent] [-e events] [-s seed] > pty.txt &
+ *   ncp_bench $(cat pty.txt) -p
+ *
+ * Every transfer checks the length prefixes of both directions. Transfers
+ * are cut short at a random byte with the given probability, the master
+ * then sends its data again and drops what it got, and the target must send
+ * its data again. Each command is followed by a burst of events on the
+ * event and bulk lanes, numbered so the master can check that none is lost,
+ * repeated or reordered by a retransmission. The main loop of the target
+ * also runs in the middle of transfers, so packets are queued while the
+ * transfer buffer is being clocked out.
+ *
+ * On SIGINT or SIGTERM the counters of ncp_spi.c are compared with the
+ * transfers, errors and aborts the master saw. The simulation stops at the
+ * first mismatch, exiting with 1.
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "ncp_spi.h"
+#include "user_command.h"
+#include "dmadrv.h"
+#include "gpiointerrupt.h"
+
+#define HOST_INT_ASSERTED       (NCP_SPI_HOST_INT_POLARITY ? 1 : 0)
+#define SIM_EVT_ID              gecko_evt_user_message_to_host_id
+#define SIM_BULK_ID             gecko_evt_le_gap_scan_response_id
+#define STREAM_LEN              4096
+
+#define FAIL(...)                                   \
+  do {                                              \
+    fprintf(stderr, "spi_sim: FAIL: " __VA_ARGS__); \
+    fprintf(stderr, "\n");                          \
+    exit(1);                                        \
+  } while (0)
+
+/*******************************************************************************
+ * Wires: USART, LDMA and GPIO
+ ******************************************************************************/
+
+USART_TypeDef spi_sim_usart;
+
+typedef struct {
+  bool active;
+  uint8_t *buf;
+  int len;
+  int done;
+} dma_channel_t;
+
+static dma_channel_t dma[2];
+static unsigned int dma_allocated = 0;
+static uint8_t gpio_in[6][16];
+static uint8_t gpio_out[6][16];
+static GPIOINT_IrqCallbackPtr_t gpio_callbacks[16];
+
+Ecode_t DMADRV_Init(void)
+{
+  return ECODE_EMDRV_DMADRV_OK;
+}
+
+Ecode_t DMADRV_AllocateChannel(unsigned int *channelId, void *capabilities)
+{
+  (void)capabilities;
+  *channelId = dma_allocated++;
+  return ECODE_EMDRV_DMADRV_OK;
+}
+
+Ecode_t DMADRV_PeripheralMemory(unsigned int channelId, DMADRV_PeripheralSignal_t peripheralSignal,
+                                void *dst, void *src, bool dstInc, int len,
+                                DMADRV_DataSize_t size, DMADRV_Callback_t callback,
+                                void *cbUserParam)
+{
+  (void)peripheralSignal, (void)src, (void)dstInc, (void)size, (void)callback, (void)cbUserParam;
+  dma[channelId] = (dma_channel_t){ true, dst, len, 0 };
+  return ECODE_EMDRV_DMADRV_OK;
+}
+
+Ecode_t DMADRV_MemoryPeripheral(unsigned int channelId, DMADRV_PeripheralSignal_t peripheralSignal,
+                                void *dst, void *src, bool srcInc, int len,
+                                DMADRV_DataSize_t size, DMADRV_Callback_t callback,
+                                void *cbUserParam)
+{
+  (void)peripheralSignal, (void)dst, (void)srcInc, (void)size, (void)callback, (void)cbUserParam;
+  dma[channelId] = (dma_channel_t){ true, src, len, 0 };
+  return ECODE_EMDRV_DMADRV_OK;
+}
+
+Ecode_t DMADRV_StopTransfer(unsigned int channelId)
+{
+  dma[channelId].active = false;
+  return ECODE_EMDRV_DMADRV_OK;
+}
+
+Ecode_t DMADRV_TransferRemainingCount(unsigned int channelId, int *remaining)
+{
+  *remaining = dma[channelId].len - dma[channelId].done;
+  return ECODE_EMDRV_DMADRV_OK;
+}
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode,
+                     unsigned int out)
+{
+  if (mode == gpioModePushPull) {
+    gpio_out[port][pin] = out;
+  } else if (mode == gpioModeInputPull) {
+    gpio_in[port][pin] = out;
+  }
+}
+
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  return gpio_in[port][pin];
+}
+
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  gpio_out[port][pin] = 1;
+}
+
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  gpio_out[port][pin] = 0;
+}
+
+void GPIO_ExtIntConfig(GPIO_Port_TypeDef port, unsigned int pin, unsigned int intNo,
+                       bool risingEdge, bool fallingEdge, bool enable)
+{
+  (void)port, (void)pin, (void)intNo, (void)risingEdge, (void)fallingEdge, (void)enable;
+}
+
+void GPIOINT_Init(void)
+{
+}
+
+void GPIOINT_CallbackRegister(uint8_t pin, GPIOINT_IrqCallbackPtr_t callbackPtr)
+{
+  gpio_callbacks[pin] = callbackPtr;
+}
+
+// The USART in slave mode: one byte in on MOSI, one byte out on MISO
+static uint8_t spi_clock(uint8_t mosi)
+{
+  dma_channel_t *rx = &dma[0];
+  dma_channel_t *tx = &dma[1];
+  // TX underflow repeats nothing useful, the master ignores it
+  uint8_t miso = 0xff;
+
+  if (tx->active && tx->done < tx->len) {
+    miso = tx->buf[tx->done++];
+  }
+  if (rx->active && rx->done < rx->len) {
+    rx->buf[rx->done++] = mosi;
+  }
+  return miso;
+}
+
+static void spi_chip_select(bool asserted)
+{
+  gpio_in[BSP_SPINCP_CS_PORT][BSP_SPINCP_CS_PIN] = asserted ? 0 : 1;
+  gpio_callbacks[BSP_SPINCP_CS_PIN](BSP_SPINCP_CS_PIN);
+}
+
+/*******************************************************************************
+ * Stack: commands, responses and events
+ ******************************************************************************/
+
+static uint32_t rsp_buf[(NCP_CMD_SIZE + 3) / 4];
+void* gecko_rsp_msg_buf = rsp_buf;
+
+static uint32_t signals = 0;
+static uint32_t commands = 0;
+static uint32_t evt_seq = 0;
+static uint32_t bulk_seq = 0;
+// Sequence numbers of the events accepted into the event lane, which never
+// drops a packet it accepted, in the order they must arrive
+static uint32_t evt_accepted[1024];
+static uint32_t evt_accepted_read = 0;
+static uint32_t evt_accepted_write = 0;
+
+static void set_response(uint32_t id, const uint8_t *payload, uint32_t len)
+{
+  struct gecko_cmd_packet *rsp = (struct gecko_cmd_packet *)gecko_rsp_msg_buf;
+
+  rsp->header = id | ((len & 0xff) << 8) | ((len >> 8) & 0x7);
+  memcpy(&rsp->data, payload, len);
+}
+
+void gecko_handle_command(uint32_t header, void* payload)
+{
+  uint8_t result[2] = { 0, 0 };
+
+  (void)payload;
+  commands++;
+  if (BGLIB_MSG_ID(header) != gecko_cmd_system_hello_id) {
+    result[0] = (uint8_t)bg_err_not_implemented;
+    result[1] = (uint8_t)(bg_err_not_implemented >> 8);
+  }
+  // responses carry the ID of their command
+  set_response(BGLIB_MSG_ID(header), result, sizeof(result));
+}
+
+void handle_user_command(uint8_t* data)
+{
+  // result, uint8array: length, command code, data
+  uint8_t rsp[4 + 12] = { 0, 0, 1, data[1] };
+  uint32_t counters[3];
+
+  commands++;
+  if (data[0] < 1 || data[1] != USER_CMD_SPI_STATUS) {
+    rsp[0] = (uint8_t)bg_err_not_implemented;
+    rsp[1] = (uint8_t)(bg_err_not_implemented >> 8);
+    set_response(gecko_rsp_user_message_to_target_id, rsp, 4);
+    return;
+  }
+  counters[0] = ncp_spi_transfers();
+  counters[1] = ncp_spi_rx_errors();
+  counters[2] = ncp_spi_tx_aborts();
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 4; j++) {
+      rsp[4 + 4 * i + j] = (uint8_t)(counters[i] >> (8 * j));
+    }
+  }
+  rsp[2] = 1 + 12;
+  set_response(gecko_rsp_user_message_to_target_id, rsp, sizeof(rsp));
+}
+
+void gecko_external_signal(uint32 sig)
+{
+  signals |= sig;
+}
+
+// Room for the events of the simulation
+typedef union {
+  struct gecko_cmd_packet packet;
+  uint8_t buf[BGLIB_MSG_HEADER_LEN + 16];
+} sim_evt_t;
+
+static void queue_event(uint32_t id, uint32_t seq)
+{
+  sim_evt_t sim_evt = { 0 };
+  struct gecko_cmd_packet *evt = &sim_evt.packet;
+  uint8_t *payload = (uint8_t *)&evt->data;
+  uint32_t len;
+
+  if (id == SIM_EVT_ID) {
+    // uint8array with the sequence number
+    payload[0] = 4;
+    memcpy(&payload[1], &seq, 4);
+    len = 5;
+  } else {
+    // rssi, packet_type, address with the sequence number, address_type,
+    // bonding, empty data
+    payload[0] = (uint8_t)-60;
+    memcpy(&payload[2], &seq, 4);
+    payload[9] = 0xff;
+    len = 11;
+  }
+  evt->header = id | (len << 8);
+  if (ncp_transmit_enqueue(evt) && id == SIM_EVT_ID) {
+    if (evt_accepted_write - evt_accepted_read == sizeof(evt_accepted) / sizeof(evt_accepted[0])) {
+      FAIL("event lane holds more events than sent");
+    }
+    evt_accepted[evt_accepted_write++ % 1024] = seq;
+  }
+}
+
+// One pass of the main loop of main.c
+static void target_main_loop(int events)
+{
+  if (ncp_command_received()) {
+    ncp_handle_command();
+    for (int i = 0; i < events; i++) {
+      if (i & 1) {
+        queue_event(SIM_BULK_ID, ++bulk_seq);
+      } else {
+        queue_event(SIM_EVT_ID, ++evt_seq);
+      }
+    }
+  }
+  if (signals) {
+    sim_evt_t sim_evt = { 0 };
+    struct gecko_cmd_packet *evt = &sim_evt.packet;
+    evt->header = gecko_evt_system_external_signal_id | (4 << 8);
+    evt->data.evt_system_external_signal.extsignals = signals;
+    signals = 0;
+    if (!ncp_handle_event(evt)) {
+      FAIL("external signal not handled");
+    }
+  }
+  ncp_transmit();
+}
+
+/*******************************************************************************
+ * SPI master
+ ******************************************************************************/
+
+static int pty = -1;
+// NCP stream from the host, and from the target
+static uint8_t host_stream[STREAM_LEN];
+static uint32_t host_len = 0;
+static uint8_t target_stream[STREAM_LEN];
+static uint32_t target_len = 0;
+// Bytes of the target stream checked as complete packets, and written out
+static uint32_t target_checked = 0;
+static uint32_t target_out = 0;
+
+static uint32_t transfers = 0;
+static uint32_t rx_errors = 0;
+static uint32_t tx_aborts = 0;
+static uint32_t cut_transfers = 0;
+static uint64_t bytes_to_target = 0;
+static uint64_t bytes_from_target = 0;
+static uint32_t responses = 0;
+static uint32_t evt_received = 0;
+static uint32_t bulk_received = 0;
+static uint32_t bulk_last = 0;
+
+static uint32_t read_u32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Bytes of the host stream up to the end of the command at its start, the
+// target takes a single command at a time
+static uint32_t host_command_len(void)
+{
+  uint32_t len;
+
+  if (host_len < BGLIB_MSG_HEADER_LEN) {
+    return host_len;
+  }
+  len = BGLIB_MSG_HEADER_LEN + BGLIB_MSG_LEN(read_u32(host_stream));
+  return len < host_len ? len : host_len;
+}
+
+// Check the complete packets of the target stream
+static void target_packets(void)
+{
+  while (target_len - target_checked >= BGLIB_MSG_HEADER_LEN) {
+    uint32_t header = read_u32(&target_stream[target_checked]);
+    uint32_t len = BGLIB_MSG_HEADER_LEN + BGLIB_MSG_LEN(header);
+    const uint8_t *payload = &target_stream[target_checked + BGLIB_MSG_HEADER_LEN];
+
+    if ((target_stream[target_checked] & 0x78) != gecko_dev_type_gecko) {
+      FAIL("target stream out of sync at byte %llu",
+           (unsigned long long)(bytes_from_target - target_len + target_checked));
+    }
+    if (target_len - target_checked < len) {
+      break;
+    }
+    if (BGLIB_MSG_ID(header) == SIM_EVT_ID) {
+      uint32_t seq = read_u32(&payload[1]);
+      if (evt_accepted_read == evt_accepted_write
+          || evt_accepted[evt_accepted_read % 1024] != seq) {
+        FAIL("event %u out of order", seq);
+      }
+      evt_accepted_read++;
+      evt_received++;
+    } else if (BGLIB_MSG_ID(header) == SIM_BULK_ID) {
+      uint32_t seq = read_u32(&payload[2]);
+      if (seq <= bulk_last || seq > bulk_seq) {
+        FAIL("bulk event %u after %u", seq, bulk_last);
+      }
+      bulk_last = seq;
+      bulk_received++;
+    } else if (!(header & gecko_msg_type_evt)) {
+      if (++responses > commands) {
+        FAIL("more responses than commands");
+      }
+    }
+    target_checked += len;
+  }
+}
+
+// Run a transfer as specified in ncp_spi.h, cut short with the given
+// probability
+static void spi_transfer(int abort_percent, int events)
+{
+  uint8_t rx[NCP_SPI_MAX_TRANSFER];
+  uint32_t out_len = host_command_len();
+  uint32_t in_len;
+  uint32_t total;
+  uint32_t clocked;
+  bool cut;
+
+  if (out_len > NCP_SPI_MAX_TRANSFER - NCP_SPI_HEADER_LEN) {
+    out_len = NCP_SPI_MAX_TRANSFER - NCP_SPI_HEADER_LEN;
+  }
+  spi_chip_select(true);
+  transfers++;
+  // the main loop keeps running while chip select is asserted
+  if (rand() % 4 == 0) {
+    target_main_loop(events);
+  }
+  cut = (rand() % 100 < abort_percent);
+  // length the target sends, read off MISO even if the master stops early
+  in_len = dma[1].active ? dma[1].buf[0] | (dma[1].buf[1] << 8) : 0;
+  clocked = NCP_SPI_HEADER_LEN;
+  if (cut && rand() % 8 == 0) {
+    // chip select deasserted during the lengths
+    clocked = rand() % NCP_SPI_HEADER_LEN;
+  }
+  for (uint32_t i = 0; i < clocked; i++) {
+    uint8_t miso = spi_clock((uint8_t)(out_len >> (8 * i)));
+    if (miso != (uint8_t)(in_len >> (8 * i))) {
+      FAIL("length byte %u is 0x%02x, armed 0x%04x", i, miso, in_len);
+    }
+  }
+  if (in_len > NCP_SPI_MAX_TRANSFER - NCP_SPI_HEADER_LEN) {
+    FAIL("target length %u over the maximum transfer", in_len);
+  }
+  total = NCP_SPI_HEADER_LEN + (in_len > out_len ? in_len : out_len);
+  if (clocked < NCP_SPI_HEADER_LEN) {
+    total = clocked;
+  } else if (cut && total > NCP_SPI_HEADER_LEN) {
+    // anywhere from the first data byte to the last
+    total = NCP_SPI_HEADER_LEN + rand() % (total - NCP_SPI_HEADER_LEN);
+  } else {
+    cut = false;
+  }
+  cut_transfers += cut;
+  if (rand() % 4 == 0) {
+    target_main_loop(events);
+  }
+  for (; clocked < total; clocked++) {
+    uint32_t pos = clocked - NCP_SPI_HEADER_LEN;
+    rx[pos] = spi_clock(pos < out_len ? host_stream[pos] : 0);
+  }
+  spi_chip_select(false);
+
+  // what the target makes of the transfer
+  if (clocked >= NCP_SPI_HEADER_LEN && out_len > clocked - NCP_SPI_HEADER_LEN) {
+    rx_errors++;
+  }
+  if (in_len > 0 && clocked < NCP_SPI_HEADER_LEN + in_len) {
+    tx_aborts++;
+  }
+
+  if (clocked >= NCP_SPI_HEADER_LEN + out_len) {
+    memmove(host_stream, &host_stream[out_len], host_len - out_len);
+    host_len -= out_len;
+    bytes_to_target += out_len;
+  }
+  if (clocked >= NCP_SPI_HEADER_LEN + in_len) {
+    memcpy(&target_stream[target_len], rx, in_len);
+    target_len += in_len;
+    bytes_from_target += in_len;
+    target_packets();
+  }
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig)
+{
+  (void)sig;
+  stop = 1;
+}
+
+static void check_counters(void)
+{
+  if (ncp_spi_transfers() != transfers || ncp_spi_rx_errors() != rx_errors
+      || ncp_spi_tx_aborts() != tx_aborts) {
+    FAIL("target counted %u transfers, %u rx errors, %u aborts, master %u, %u, %u",
+         ncp_spi_transfers(), ncp_spi_rx_errors(), ncp_spi_tx_aborts(),
+         transfers, rx_errors, tx_aborts);
+  }
+}
+
+// Read the host stream, and pass the checked packets of the target on
+static void pty_io(int timeout_ms)
+{
+  struct pollfd pfd = { pty, POLLIN, 0 };
+  ssize_t n;
+
+  if (target_out < target_checked) {
+    n = write(pty, &target_stream[target_out], target_checked - target_out);
+    if (n < 0 && errno != EAGAIN) {
+      FAIL("pty write: %s", strerror(errno));
+    }
+    if (n > 0) {
+      target_out += n;
+    }
+  }
+  memmove(target_stream, &target_stream[target_out], target_len - target_out);
+  target_len -= target_out;
+  target_checked -= target_out;
+  target_out = 0;
+
+  if (host_len < sizeof(host_stream) && poll(&pfd, 1, timeout_ms) > 0) {
+    n = read(pty, &host_stream[host_len], sizeof(host_stream) - host_len);
+    if (n > 0) {
+      host_len += n;
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int abort_percent = 0;
+  int events = 0;
+  unsigned int seed = 1;
+  int opt;
+  int slave;
+  struct termios tio;
+
+  while ((opt = getopt(argc, argv, "a:e:s:")) != -1) {
+    switch (opt) {
+      case 'a': abort_percent = atoi(optarg); break;
+      case 'e': events = atoi(optarg); break;
+      case 's': seed = strtoul(optarg, NULL, 0); break;
+      default:
+        fprintf(stderr, "usage: %s [-a abort_percent] [-e events] [-s seed]\n", argv[0]);
+        return 2;
+    }
+  }
+  srand(seed);
+
+  pty = posix_openpt(O_RDWR | O_NOCTTY);
+  if (pty < 0 || grantpt(pty) < 0 || unlockpt(pty) < 0) {
+    perror("posix_openpt");
+    return 2;
+  }
+  // keep the slave open, so the pty stays up between hosts
+  slave = open(ptsname(pty), O_RDWR | O_NOCTTY);
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+  fcntl(pty, F_SETFL, O_NONBLOCK);
+  printf("%s\n", ptsname(pty));
+  fflush(stdout);
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  ncp_spi_init();
+  while (!stop) {
+    bool host_int;
+
+    target_main_loop(events);
+    host_int = gpio_out[NCP_SPI_HOST_INT_PORT][NCP_SPI_HOST_INT_PIN] == HOST_INT_ASSERTED;
+    // wait for the host to read before clocking more target data
+    if ((host_len > 0 || host_int)
+        && sizeof(target_stream) - target_len >= NCP_SPI_MAX_TRANSFER) {
+      spi_transfer(abort_percent, events);
+      check_counters();
+      pty_io(0);
+    } else {
+      pty_io(10);
+    }
+  }
+
+  fprintf(stderr, "spi_sim: %u transfers, %u cut short, %u rx errors, %u aborts\n",
+          transfers, cut_transfers, rx_errors, tx_aborts);
+  fprintf(stderr, "spi_sim: %u commands, %u responses, %llu bytes in, %llu bytes out\n",
+          commands, responses, (unsigned long long)bytes_to_target,
+          (unsigned long long)bytes_from_target);
+  fprintf(stderr, "spi_sim: events %u of %u received, bulk %u of %u received, %u dropped\n",
+          evt_received, evt_seq, bulk_received, bulk_seq,
+          ncp_transmit_dropped(ncp_tx_lane_bulk));
+  fprintf(stderr, "spi_sim: PASS\n");
+  close(slave);
+  return 0;
+}
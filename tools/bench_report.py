@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Compare GATT throughput benchmark runs.
+
+Reads Benchmark Result values of the BLE-soc-basic throughput service, one
+run per line as hex, optionally preceded by a label such as the phone or
+central used, and prints a table per parameter set:
+
+    ./bench_report.py results.txt
+    ./bench_report.py --by label,mode,phy results/*.txt
+
+A line looks like
+
+    pixel3 0100f400f7000600...
+
+Blank lines and lines starting with # are skipped.
+"""
+
+import argparse
+import struct
+import sys
+from collections import OrderedDict
+
+# Layout documented in BLE-soc-basic/gatt_bench.h
+RESULT = struct.Struct('<BBHHHIIIIIII')
+FIELDS = ('mode', 'phy', 'payload', 'mtu', 'interval', 'span_ms', 'packets', 'bytes',
+          'bps', 'min_gap_us', 'max_gap_us', 'jitter_us')
+
+MODES = {1: 'notify', 2: 'indicate', 3: 'write', 4: 'write-nr'}
+PHYS = {1: '1M', 2: '2M', 4: 'coded'}
+
+KEYS = ('label', 'mode', 'phy', 'mtu', 'interval', 'payload')
+
+
+def parse_line(line):
+    words = line.split()
+    label = ' '.join(words[:-1]) if len(words) > 1 else ''
+    data = bytes.fromhex(words[-1].replace(':', ''))
+    if len(data) != RESULT.size:
+        raise ValueError('expected %d bytes, got %d' % (RESULT.size, len(data)))
+    run = dict(zip(FIELDS, RESULT.unpack(data)))
+    run['label'] = label
+    run['mode'] = MODES.get(run['mode'], str(run['mode']))
+    run['phy'] = PHYS.get(run['phy'], str(run['phy']))
+    # connection interval in ms
+    run['interval'] = run['interval'] * 1.25
+    return run
+
+
+def load(paths):
+    runs = []
+    for path in paths:
+        with (sys.stdin if path == '-' else open(path)) as f:
+            for number, line in enumerate(f, 1):
+                line = line.strip()
+                if not line or line.startswith('#'):
+                    continue
+                try:
+                    runs.append(parse_line(line))
+                except ValueError as e:
+                    sys.stderr.write('%s:%d: %s\n' % (path, number, e))
+    return runs
+
+
+def mean(values):
+    return sum(values) / len(values) if values else 0
+
+
+def report(runs, keys, out):
+    groups = OrderedDict()
+    for run in sorted(runs, key=lambda r: tuple(r[k] for k in keys)):
+        groups.setdefault(tuple(run[k] for k in keys), []).append(run)
+
+    header = list(keys) + ['runs', 'kbps', 'min', 'max', 'packets', 'jitter_us', 'max_gap_us']
+    rows = []
+    for key, group in groups.items():
+        kbps = [r['bps'] / 1000.0 for r in group]
+        rows.append([str(k) for k in key] + [
+            str(len(group)),
+            '%.1f' % mean(kbps), '%.1f' % min(kbps), '%.1f' % max(kbps),
+            '%d' % mean([r['packets'] for r in group]),
+            '%d' % mean([r['jitter_us'] for r in group]),
+            '%d' % max(r['max_gap_us'] for r in group),
+        ])
+    widths = [max(len(h), *(len(r[i]) for r in rows)) if rows else len(h)
+              for i, h in enumerate(header)]
+    for row in [header] + rows:
+        out.write('  '.join(c.rjust(w) for c, w in zip(row, widths)).rstrip() + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('files', nargs='*', default=['-'],
+                        help='result files, standard input if none')
+    parser.add_argument('--by', default=','.join(KEYS),
+                        help='fields to group the runs by, from %s (default: all)'
+                        % ', '.join(KEYS))
+    args = parser.parse_args()
+
+    keys = [k.strip() for k in args.by.split(',') if k.strip()]
+    for k in keys:
+        if k not in KEYS:
+            parser.error('unknown field %s' % k)
+    runs = load(args.files)
+    if not runs:
+        sys.exit('no results')
+    report(runs, keys, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""Report the flash and RAM footprint of a firmware image per source file.
+
+Reads the GNU ld map file written next to the .axf by the
+"GNU ARM v7.2.1 - Default" build and attributes every input section to the
+object or library member it comes from:
+
+    ./footprint.py "../BLE-soc-basic/GNU ARM v7.2.1 - Default/BLE-soc-basic.map"
+    ./footprint.py --by component app.map
+    ./footprint.py --json app.map > baseline.json
+    ./footprint.py --diff baseline.json app.map
+
+Sections in a writable memory region count as RAM, the others as flash.
+Initialized data counts as both, it is copied from flash at startup.
+"""
+
+import argparse
+import json
+import re
+import sys
+from collections import defaultdict
+
+REGION = re.compile(r'^(\S+)\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s*(\S*)$')
+OUTPUT_SECTION = re.compile(r'^(\.\S+|COMMON)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)'
+                            r'(?:\s+load address (0x[0-9a-f]+))?)?\s*$')
+INPUT_SECTION = re.compile(r'^ (\.\S+|COMMON|\*fill\*)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s*(.*))?$')
+INPUT_CONTINUATION = re.compile(r'^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*)$')
+
+# Sections without contents in the image, they take RAM but no flash
+NOBITS = ('.bss', 'COMMON', '.heap', '.stack', '.noinit')
+
+FILL = '(fill)'
+
+# First match wins, tested against the object path with forward slashes
+COMPONENTS = (
+    ('gatt_db', re.compile(r'(^|/)gatt_db\.o$')),
+    ('emlib', re.compile(r'platform/emlib/')),
+    ('emdrv', re.compile(r'platform/emdrv/')),
+    ('stack', re.compile(r'protocol/bluetooth/|platform/radio/')),
+    ('device', re.compile(r'platform/Device/')),
+    ('bsp', re.compile(r'hardware/kit/')),
+    # short_name() strips the toolchain paths
+    ('toolchain', re.compile(r'^(lib\w+\.a\(|crt\w*\.o$)')),
+    ('fill', re.compile(r'^\(fill\)$')),
+)
+
+
+def component(path):
+    for name, pattern in COMPONENTS:
+        if pattern.search(path):
+            return name
+    return 'app'
+
+
+def short_name(path):
+    """Path relative to the build directory, toolchain files by name only."""
+    path = path.replace('\\', '/')
+    if path.startswith('./'):
+        return path[2:]
+    if '/arm-none-eabi/' in path or '/gnu_arm/' in path:
+        return path.rsplit('/', 1)[-1]
+    # Archives from the SDK are referenced by absolute path, keep the part
+    # from the SDK tree on
+    match = re.search(r'/((?:protocol|platform|hardware)/.*)$', path)
+    return match.group(1) if match else path
+
+
+class Region(object):
+    def __init__(self, name, origin, length, attributes):
+        self.name = name
+        self.origin = origin
+        self.length = length
+        self.writable = 'w' in attributes
+
+    def contains(self, addr):
+        return self.origin <= addr < self.origin + self.length
+
+
+def parse_map(path):
+    """Return {file: [flash, ram]} for a GNU ld map file."""
+    with open(path, errors='replace') as f:
+        lines = f.read().splitlines()
+
+    regions = []
+    i = 0
+    while i < len(lines) and lines[i].strip() != 'Memory Configuration':
+        i += 1
+    if i == len(lines):
+        raise ValueError('%s: not a GNU ld map file' % path)
+    i += 1
+    while i < len(lines) and lines[i].strip() != 'Linker script and memory map':
+        match = REGION.match(lines[i].strip())
+        if match and match.group(1) not in ('Name', '*default*'):
+            regions.append(Region(match.group(1), int(match.group(2), 16),
+                                  int(match.group(3), 16), match.group(4)))
+        i += 1
+
+    def region(addr):
+        for r in regions:
+            if r.contains(addr):
+                return r
+        return None
+
+    sizes = defaultdict(lambda: [0, 0])
+    out_name = None
+    out_vma = None
+    out_lma = None
+
+    def account(name, addr, size, obj):
+        if size == 0 or out_vma is None:
+            return
+        vma = region(addr)
+        if vma is None:
+            return
+        key = FILL if name == '*fill*' else short_name(obj)
+        nobits = out_name.startswith(NOBITS) or name.startswith(NOBITS)
+        if not vma.writable:
+            sizes[key][0] += size
+            return
+        sizes[key][1] += size
+        lma = region(out_lma) if out_lma is not None else None
+        if lma is not None and not lma.writable and not nobits:
+            sizes[key][0] += size
+
+    for i in range(i + 1, len(lines)):
+        line = lines[i]
+        # Debug sections follow, they are not loaded
+        if line.startswith('OUTPUT('):
+            break
+        if line and not line[0].isspace():
+            match = OUTPUT_SECTION.match(line)
+            if match:
+                out_name = match.group(1)
+                out_vma = out_lma = None
+                head = match
+                if head.group(2) is None and i + 1 < len(lines):
+                    head = OUTPUT_SECTION.match(out_name + lines[i + 1])
+                if head and head.group(2) is not None:
+                    out_vma = int(head.group(2), 16)
+                    if head.group(4):
+                        out_lma = int(head.group(4), 16)
+            continue
+        match = INPUT_SECTION.match(line)
+        if not match:
+            continue
+        name, addr, size, obj = match.groups()
+        if addr is None:
+            # Long section names put the address on the next line
+            if i + 1 >= len(lines):
+                continue
+            cont = INPUT_CONTINUATION.match(lines[i + 1])
+            if not cont:
+                continue
+            addr, size, obj = cont.groups()
+        account(name, int(addr, 16), int(size, 16), obj.strip())
+    return dict(sizes)
+
+
+def load(path):
+    """Read a map file or a report saved with --json."""
+    if path.endswith('.json'):
+        with open(path) as f:
+            return {k: list(v) for k, v in json.load(f).items()}
+    return parse_map(path)
+
+
+def group(sizes, by):
+    if by == 'file':
+        return sizes
+    grouped = defaultdict(lambda: [0, 0])
+    for path, (flash, ram) in sizes.items():
+        grouped[component(path)][0] += flash
+        grouped[component(path)][1] += ram
+    return dict(grouped)
+
+
+def print_report(sizes, by, out):
+    label = 'file' if by == 'file' else 'component'
+    out.write('%8s %8s  %s\n' % ('flash', 'ram', label))
+    for key, (flash, ram) in sorted(sizes.items(), key=lambda kv: (-kv[1][0] - kv[1][1], kv[0])):
+        out.write('%8d %8d  %s\n' % (flash, ram, key))
+    out.write('%8d %8d  total\n' % (sum(v[0] for v in sizes.values()),
+                                    sum(v[1] for v in sizes.values())))
+
+
+def print_diff(old, new, by, out):
+    label = 'file' if by == 'file' else 'component'
+    rows = []
+    for key in set(old) | set(new):
+        o = old.get(key, [0, 0])
+        n = new.get(key, [0, 0])
+        if o != n:
+            rows.append((n[0] - o[0], n[1] - o[1], n[0], n[1], key))
+    out.write('%8s %8s %8s %8s  %s\n' % ('flash', 'ram', 'd.flash', 'd.ram', label))
+    for dflash, dram, flash, ram, key in sorted(rows, key=lambda r: (-abs(r[0]) - abs(r[1]), r[4])):
+        out.write('%8d %8d %+8d %+8d  %s\n' % (flash, ram, dflash, dram, key))
+    out.write('%8d %8d %+8d %+8d  total\n' % (
+        sum(v[0] for v in new.values()), sum(v[1] for v in new.values()),
+        sum(r[0] for r in rows), sum(r[1] for r in rows)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('maps', nargs='+', metavar='map',
+                        help='GNU ld map file, or a report saved with --json')
+    parser.add_argument('--by', choices=('file', 'component'), default='file',
+                        help='attribute bytes per file (default) or per component')
+    parser.add_argument('--diff', action='store_true',
+                        help='compare two builds, the old one first')
+    parser.add_argument('--json', action='store_true',
+                        help='write the per file sizes as JSON, to diff against later')
+    args = parser.parse_args()
+
+    if args.diff != (len(args.maps) == 2) or len(args.maps) > 2:
+        parser.error('give one map, or two with --diff')
+    try:
+        reports = [load(path) for path in args.maps]
+    except (IOError, ValueError) as e:
+        sys.exit(str(e))
+
+    if args.json:
+        json.dump(reports[-1], sys.stdout, indent=1, sort_keys=True)
+        sys.stdout.write('\n')
+    elif args.diff:
+        print_diff(group(reports[0], args.by), group(reports[1], args.by), args.by, sys.stdout)
+    else:
+        print_report(group(reports[0], args.by), args.by, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,815 @@
+#!/usr/bin/env python3
+"""Compile gatt.xml into the GATT database of the Bluetooth stack.
+
+Writes the bg_gattdb_def tables and the gattdb_ handle defines, the same
+database the GATT configurator of Simplicity Studio generates, laid out to
+take less memory:
+
+  - the values of all dynamic attributes share one RAM arena, zero
+    initialized values in .bss, the others in .data, instead of an array
+    each
+  - identical constant values are stored once
+  - every UUID is stored once
+
+With gatt_caching the Database Hash is computed here and stored as the
+initial value of the characteristic. The generated file also has O(1)
+lookups from a UUID to its handle, gattdb_find_uuid16() on a sorted table
+and gattdb_find_uuid128() on a perfect hash of the 128-bit UUIDs.
+
+The output files are named by the out and header attributes of the gatt
+element, next to gatt.xml, unless given:
+
+    ./gattdb.py ../BLE-soc-basic/gatt.xml
+    ./gattdb.py --report ../BLE-soc-basic/gatt.xml
+    ./gattdb.py -o gatt_db.c --header gatt_db.h gatt.xml
+
+The output only depends on gatt.xml, so it can be regenerated by a build
+step and checked into the tree.
+"""
+
+import argparse
+import os
+import sys
+import xml.etree.ElementTree as ET
+
+UUID_PRIMARY_SERVICE = 0x2800
+UUID_SECONDARY_SERVICE = 0x2801
+UUID_CHARACTERISTIC = 0x2803
+UUID_CLIENT_CONFIG = 0x2902
+
+# enum gatt_att_datatype in bg_gattdb_def.h
+DATATYPE_CONST = 0x00
+DATATYPE_DYNAMIC = 0x01
+DATATYPE_DYNAMIC_VARLEN = 0x02
+DATATYPE_CLIENTCONFIG = 0x03
+DATATYPE_USER = 0x07
+
+# enum gatt_att_perm
+PERM_READ = 0x0001
+PERM_WRITE = 0x0002
+PERM_WRITE_NO_RESPONSE = 0x0004
+PERM_DISCOVERABLE = 0x0800
+PERM_SECURITY = (
+    ('encrypted_read', 0x0010),
+    ('authenticated_read', 0x0020),
+    ('bonded_read', 0x0040),
+    ('encrypted_write', 0x0100),
+    ('authenticated_write', 0x0200),
+    ('bonded_write', 0x0400),
+    ('encrypted_notify', 0x1000),
+    ('authenticated_notify', 0x2000),
+    ('bonded_notify', 0x4000),
+)
+
+# enum gatt_char_prop
+PROP_READ = 0x02
+PROP_WRITE_NO_RESPONSE = 0x04
+PROP_WRITE = 0x08
+PROP_NOTIFY = 0x10
+PROP_INDICATE = 0x20
+
+# Attributes the Database Hash covers, Core 5.1 Vol 3 Part G 7.3.1: the
+# declarations and the extended properties with their value, the user
+# description, configuration and format descriptors with only the handle and
+# the type. Values and other descriptors are left out.
+HASH_WITH_VALUE = (UUID_PRIMARY_SERVICE, UUID_SECONDARY_SERVICE, 0x2802,
+                   UUID_CHARACTERISTIC, 0x2900)
+HASH_WITHOUT_VALUE = (0x2901, UUID_CLIENT_CONFIG, 0x2903, 0x2904, 0x2905)
+
+# Multipliers tried for each table size of the 128-bit UUID lookup
+HASH_ATTEMPTS = 10000
+
+# Sizes on the target, for the report
+SIZEOF_ATTRIBUTE = 12
+SIZEOF_CHRVALUE = 8
+
+PREFIX = 'bg_gattdb_data'
+
+
+class GattError(Exception):
+    pass
+
+
+def uuid_bytes(uuid):
+    """UUID in the little endian order it has on air."""
+    digits = uuid.replace('-', '')
+    if len(digits) not in (4, 32):
+        raise GattError('bad UUID %s' % uuid)
+    return bytes.fromhex(digits)[::-1]
+
+
+def parse_value(element, length):
+    """Initial value of a value element, padded to its length."""
+    if element is None:
+        return bytes(length)
+    text = (element.text or '').strip()
+    kind = element.get('type', 'hex')
+    if kind == 'user':
+        return b''
+    if kind == 'utf-8':
+        data = text.encode('utf-8')
+    else:
+        if text[:2].lower() == '0x':
+            text = text[2:]
+        if len(text) % 2:
+            text = '0' + text
+        data = bytes.fromhex(text)
+    if len(data) > length:
+        raise GattError('value %r longer than length %d' % (text, length))
+    return data + bytes(length - len(data))
+
+
+def flag(element, name):
+    return element is not None and element.get(name) == 'true'
+
+
+class Attribute(object):
+    """One row of the attribute table, the handle is its index + 1."""
+
+    def __init__(self, uuid, permissions, datatype):
+        self.uuid = uuid            # UUID as bytes
+        self.permissions = permissions
+        self.datatype = datatype
+        self.data = b''             # const data, or initial dynamic value
+        self.max_len = 0
+        self.properties = 0
+        self.index = None           # dynamic index
+        self.config = None          # (flags, index, clientconfig_index)
+        self.id = None
+        self.value_type = None      # type attribute of the value element
+        self.char_properties = 0    # properties of the characteristic
+        self.name = None            # name in gatt.xml, None for the ones of the stack
+        self.length = 0             # length of the value in gatt.xml
+
+
+class Database(object):
+    def __init__(self, root):
+        self.root = root
+        self.attributes = []
+        self.uuid16 = [UUID_PRIMARY_SERVICE, UUID_SECONDARY_SERVICE, UUID_CHARACTERISTIC]
+        self.uuid128 = []
+        self.advertised = []
+        self.dynamic = []
+        self.client_configs = 0
+        self.hash = None
+        self._build()
+        if self.root.get('gatt_caching') == 'true':
+            self.hash = database_hash(self)
+            for attribute in self.attributes:
+                if attribute.id == 'database_hash':
+                    attribute.data = self.hash
+
+    # UUIDs are numbered in the order the GATT configurator uses: the ones in
+    # gatt.xml, then the Generic Attribute service, then the client
+    # configuration descriptor if it is only added implicitly
+    def uuid_index(self, uuid):
+        if len(uuid) == 2:
+            value = uuid[0] | (uuid[1] << 8)
+            if value not in self.uuid16:
+                self.uuid16.append(value)
+            return self.uuid16.index(value)
+        if uuid not in self.uuid128:
+            self.uuid128.append(uuid)
+        return 0x8000 | self.uuid128.index(uuid)
+
+    def add(self, uuid, permissions, datatype):
+        attribute = Attribute(uuid, permissions, datatype)
+        self.attributes.append(attribute)
+        return attribute
+
+    def add_dynamic(self, attribute):
+        attribute.index = len(self.dynamic)
+        self.dynamic.append(attribute)
+
+    def _build(self):
+        services = self.root.findall('service')
+        for service in services:
+            self.uuid_index(uuid_bytes(service.get('uuid')))
+            for char in service.findall('characteristic'):
+                self.uuid_index(uuid_bytes(char.get('uuid')))
+                for desc in char.findall('descriptor'):
+                    self.uuid_index(uuid_bytes(desc.get('uuid')))
+
+        if self.root.get('generic_attribute_service') == 'true':
+            self._generic_attribute_service(self.root.get('gatt_caching') == 'true')
+        for service in services:
+            self._service(service)
+
+    def _generic_attribute_service(self, caching):
+        chars = [('service_changed_char', '2a05', PROP_INDICATE, 4)]
+        if caching:
+            chars.append(('database_hash', '2b2a', PROP_READ, 16))
+            chars.append(('client_support_features', '2b29', PROP_READ | PROP_WRITE, 1))
+        for uuid in ['1801'] + [c[1] for c in chars]:
+            self.uuid_index(uuid_bytes(uuid))
+        self._declaration(UUID_PRIMARY_SERVICE, uuid_bytes('1801'))
+        for name, uuid, properties, length in chars:
+            value = self._characteristic(uuid_bytes(uuid), properties, {}, name)
+            value.datatype = DATATYPE_DYNAMIC
+            value.max_len = length
+            value.data = bytes(length)
+            self.add_dynamic(value)
+            if properties & (PROP_NOTIFY | PROP_INDICATE):
+                self._client_config(value, 0x807)
+
+    def _declaration(self, uuid16, value):
+        attribute = self.add(uuid16.to_bytes(2, 'little'), PERM_DISCOVERABLE | PERM_READ,
+                             DATATYPE_CONST)
+        attribute.data = value
+        return attribute
+
+    def _characteristic(self, uuid, properties, props, name):
+        declaration = self._declaration(UUID_CHARACTERISTIC, b'')
+        handle = len(self.attributes) + 1
+        declaration.data = bytes([properties]) + handle.to_bytes(2, 'little') + uuid
+        permissions = PERM_DISCOVERABLE
+        if properties & PROP_READ:
+            permissions |= PERM_READ
+        if properties & PROP_WRITE:
+            permissions |= PERM_WRITE
+        if properties & PROP_WRITE_NO_RESPONSE:
+            permissions |= PERM_WRITE_NO_RESPONSE
+        for key, bit in PERM_SECURITY:
+            if props.get(key) == 'true':
+                permissions |= bit
+        value = self.add(uuid, permissions, DATATYPE_DYNAMIC)
+        value.properties = properties
+        value.char_properties = properties
+        value.id = name
+        return value
+
+    def _client_config(self, value, permissions):
+        attribute = self.add(UUID_CLIENT_CONFIG.to_bytes(2, 'little'), permissions,
+                             DATATYPE_CLIENTCONFIG)
+        self.uuid_index(attribute.uuid)
+        flags = (value.properties & (PROP_NOTIFY | PROP_INDICATE)) >> 4
+        attribute.config = (flags, value.index, self.client_configs)
+        self.client_configs += 1
+        return attribute
+
+    def _service(self, service):
+        uuid = uuid_bytes(service.get('uuid'))
+        kind = UUID_SECONDARY_SERVICE if service.get('type') == 'secondary' else UUID_PRIMARY_SERVICE
+        self._declaration(kind, uuid)
+        if service.get('advertise') == 'true':
+            self.advertised.append(uuid)
+        for char in service.findall('characteristic'):
+            self._char(char)
+
+    def _char(self, char):
+        props_element = char.find('properties')
+        props = dict(props_element.attrib) if props_element is not None else {}
+        if props.get('reliable_write') == 'true':
+            raise GattError('%s: reliable write is not supported' % char.get('uuid'))
+        properties = 0
+        for key, bit in (('read', PROP_READ), ('write_no_response', PROP_WRITE_NO_RESPONSE),
+                         ('write', PROP_WRITE), ('notify', PROP_NOTIFY),
+                         ('indicate', PROP_INDICATE)):
+            if props.get(key) == 'true':
+                properties |= bit
+        value_element = char.find('value')
+        value = self._characteristic(uuid_bytes(char.get('uuid')), properties, props,
+                                     char.get('id'))
+        value.name = char.get('name')
+        self._value(value, value_element, flag(props_element, 'const'))
+
+        descriptors = char.findall('descriptor')
+        explicit_config = any(uuid_bytes(d.get('uuid')) == UUID_CLIENT_CONFIG.to_bytes(2, 'little')
+                              for d in descriptors)
+        if properties & (PROP_NOTIFY | PROP_INDICATE) and not explicit_config:
+            self._client_config(value, 0x807)
+        for desc in descriptors:
+            self._descriptor(desc, value)
+
+    def _value(self, attribute, element, const):
+        length = int(element.get('length', '0')) if element is not None else 0
+        attribute.value_type = element.get('type', 'hex') if element is not None else 'hex'
+        attribute.max_len = length
+        attribute.length = length
+        if const:
+            attribute.datatype = DATATYPE_CONST
+            attribute.data = parse_value(element, length)
+        elif attribute.value_type == 'user':
+            attribute.datatype = DATATYPE_USER
+            attribute.max_len = 0
+            self.add_dynamic(attribute)
+        else:
+            if element is not None and element.get('variable_length') == 'true':
+                attribute.datatype = DATATYPE_DYNAMIC_VARLEN
+                attribute.data = parse_value(element, 0) if (element.text or '').strip() else b''
+                if len(attribute.data) > length:
+                    raise GattError('value longer than length %d' % length)
+            else:
+                attribute.data = parse_value(element, length)
+            self.add_dynamic(attribute)
+
+    def _descriptor(self, desc, value):
+        props_element = desc.find('properties')
+        permissions = PERM_DISCOVERABLE
+        properties = 0
+        if flag(props_element, 'read'):
+            permissions |= PERM_READ
+            properties |= PROP_READ
+        if flag(props_element, 'write'):
+            permissions |= PERM_WRITE
+            properties |= PROP_WRITE
+        uuid = uuid_bytes(desc.get('uuid'))
+        if uuid == UUID_CLIENT_CONFIG.to_bytes(2, 'little'):
+            self._client_config(value, permissions)
+            return
+        attribute = self.add(uuid, permissions, DATATYPE_DYNAMIC)
+        attribute.properties = properties
+        attribute.id = desc.get('id')
+        attribute.name = desc.get('name')
+        self._value(attribute, desc.find('value'), flag(props_element, 'const'))
+
+
+# AES-128 encryption, enough for the AES-CMAC of the Database Hash
+
+def _xtime(b):
+    return ((b << 1) ^ 0x1b) & 0xff if b & 0x80 else b << 1
+
+
+def _sbox():
+    box = [0] * 256
+    p = q = 1
+    while True:
+        p = p ^ ((p << 1) & 0xff) ^ (0x1b if p & 0x80 else 0)
+        q ^= q << 1
+        q ^= q << 2
+        q ^= q << 4
+        q &= 0xff
+        if q & 0x80:
+            q ^= 0x09
+        x = q ^ ((q << 1) | (q >> 7)) ^ ((q << 2) | (q >> 6)) ^ ((q << 3) | (q >> 5)) \
+            ^ ((q << 4) | (q >> 4))
+        box[p] = (x ^ 0x63) & 0xff
+        if p == 1:
+            break
+    box[0] = 0x63
+    return box
+
+
+SBOX = _sbox()
+
+
+def aes_encrypt(key, block):
+    words = [list(key[i:i + 4]) for i in range(0, 16, 4)]
+    rcon = 1
+    for i in range(4, 44):
+        word = list(words[i - 1])
+        if i % 4 == 0:
+            word = [SBOX[b] for b in word[1:] + word[:1]]
+            word[0] ^= rcon
+            rcon = _xtime(rcon)
+        words.append([a ^ b for a, b in zip(words[i - 4], word)])
+    keys = [sum(words[r * 4:r * 4 + 4], []) for r in range(11)]
+
+    state = [b ^ k for b, k in zip(block, keys[0])]
+    for r in range(1, 11):
+        state = [SBOX[b] for b in state]
+        state = [state[(i + 4 * (i % 4)) % 16] for i in range(16)]
+        if r < 10:
+            mixed = []
+            for c in range(0, 16, 4):
+                a = state[c:c + 4]
+                t = a[0] ^ a[1] ^ a[2] ^ a[3]
+                mixed += [a[i] ^ t ^ _xtime(a[i] ^ a[(i + 1) % 4]) for i in range(4)]
+            state = mixed
+        state = [b ^ k for b, k in zip(state, keys[r])]
+    return bytes(state)
+
+
+def aes_cmac(key, message):
+    """AES-CMAC of RFC 4493."""
+    def double(block):
+        value = int.from_bytes(block, 'big') << 1
+        if value >> 128:
+            value ^= 0x87
+        return (value & ((1 << 128) - 1)).to_bytes(16, 'big')
+
+    k1 = double(aes_encrypt(key, bytes(16)))
+    k2 = double(k1)
+    blocks = [message[i:i + 16] for i in range(0, len(message), 16)] or [b'']
+    if len(blocks[-1]) == 16:
+        last = bytes(a ^ b for a, b in zip(blocks[-1], k1))
+    else:
+        padded = blocks[-1] + b'\x80' + bytes(15 - len(blocks[-1]))
+        last = bytes(a ^ b for a, b in zip(padded, k2))
+    mac = bytes(16)
+    for block in blocks[:-1] + [last]:
+        mac = aes_encrypt(key, bytes(a ^ b for a, b in zip(mac, block)))
+    return mac
+
+
+def database_hash(db):
+    """Database Hash of Core 5.1 Vol 3 Part G 7.3 over the attribute table."""
+    with_value = [u.to_bytes(2, 'little') for u in HASH_WITH_VALUE]
+    without_value = [u.to_bytes(2, 'little') for u in HASH_WITHOUT_VALUE]
+    message = b''
+    for handle, attribute in enumerate(db.attributes, 1):
+        if attribute.uuid in with_value:
+            message += handle.to_bytes(2, 'little') + attribute.uuid + attribute.data
+        elif attribute.uuid in without_value:
+            message += handle.to_bytes(2, 'little') + attribute.uuid
+    return aes_cmac(bytes(16), message)
+
+
+# UUID lookup tables
+
+def uuid_handles(db):
+    """First handle of each UUID: the declaration of a service, the value of
+    a characteristic, the descriptor itself."""
+    handles = {}
+    for handle, attribute in enumerate(db.attributes, 1):
+        if attribute.uuid in (UUID_PRIMARY_SERVICE.to_bytes(2, 'little'),
+                              UUID_SECONDARY_SERVICE.to_bytes(2, 'little')):
+            uuid = attribute.data
+        elif attribute.uuid in (UUID_CHARACTERISTIC.to_bytes(2, 'little'),
+                                UUID_CLIENT_CONFIG.to_bytes(2, 'little')):
+            continue
+        else:
+            uuid = attribute.uuid
+        handles.setdefault(uuid, handle)
+    return handles
+
+
+def uuid128_key(uuid):
+    # The first and the last word, 16-bit UUIDs on the Bluetooth base UUID
+    # only differ in the last one
+    return int.from_bytes(uuid[0:4], 'little') ^ int.from_bytes(uuid[12:16], 'little')
+
+
+def perfect_hash(keys):
+    """Multiplier and table size giving every key its own slot."""
+    bits = 1
+    while (1 << bits) < len(keys):
+        bits += 1
+    while True:
+        seed = 0x9e3779b1
+        for _ in range(HASH_ATTEMPTS):
+            slots = set(((key * seed) & 0xffffffff) >> (32 - bits) for key in keys)
+            if len(slots) == len(keys):
+                return seed, bits
+            seed = (seed * 0x2c1b3c6d + 0x297a2d39) & 0xffffffff | 1
+        bits += 1
+
+
+def c_bytes(data, per_line=16, indent='  '):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ' '.join('0x%02x,' % b for b in data[i:i + per_line]))
+    return '\n'.join(lines)
+
+
+def align(offset, alignment):
+    return (offset + alignment - 1) & ~(alignment - 1)
+
+
+def value_alignment(attribute):
+    if attribute.datatype == DATATYPE_DYNAMIC_VARLEN:
+        return 2
+    if attribute.max_len % 4 == 0:
+        return 4
+    if attribute.max_len % 2 == 0:
+        return 2
+    return 1
+
+
+class Layout(object):
+    """Placement of the constant values and of the dynamic values in RAM."""
+
+    def __init__(self, db):
+        # Identical constant values share a buffer
+        self.const_buffers = []
+        self.const_of = {}
+        for i, attribute in enumerate(db.attributes):
+            if attribute.datatype == DATATYPE_CONST:
+                if attribute.data not in self.const_buffers:
+                    self.const_buffers.append(attribute.data)
+                self.const_of[i] = self.const_buffers.index(attribute.data)
+
+        # Values are placed by decreasing alignment so no padding is needed
+        # between them, initialized ones in their own arena
+        self.arenas = {'init': bytearray(), 'zero': bytearray()}
+        self.offset_of = {}
+        stored = [a for a in db.dynamic if a.datatype != DATATYPE_USER]
+        for attribute in sorted(stored, key=lambda a: (-value_alignment(a), a.index)):
+            if attribute.datatype == DATATYPE_DYNAMIC_VARLEN:
+                content = len(attribute.data).to_bytes(2, 'little') + attribute.data
+                content += bytes(2 + attribute.max_len - len(content))
+            else:
+                content = attribute.data
+            arena = self.arenas['init' if any(content) else 'zero']
+            arena.extend(bytes(align(len(arena), value_alignment(attribute)) - len(arena)))
+            self.offset_of[attribute.index] = ('init' if any(content) else 'zero', len(arena))
+            arena.extend(content)
+
+
+def write_c(db, layout, source_name, prefix, out):
+    w = out.write
+    w('// Generated by gattdb.py from %s, do not edit.\n\n' % source_name)
+    w('#include <stddef.h>\n#include <stdint.h>\n#include <string.h>\n#include "bg_gattdb_def.h"\n'
+      '#include "%s"\n\n' % db.root.get('header', 'gatt_db.h'))
+    w('#ifdef __GNUC__\n'
+      '#define GATT_HEADER(F) F __attribute__ ((section (".gatt_header")))\n'
+      '#define GATT_DATA(F) F __attribute__ ((section (".gatt_data")))\n'
+      '#define GATT_ARENA(F) F __attribute__ ((aligned (4)))\n'
+      '#else\n#ifdef __ICCARM__\n'
+      '#define GATT_HEADER(F) _Pragma("location=\\".gatt_header\\"") F\n'
+      '#define GATT_DATA(F) _Pragma("location=\\".gatt_data\\"") F\n'
+      '#define GATT_ARENA(F) _Pragma("data_alignment=4") F\n'
+      '#else\n'
+      '#define GATT_HEADER(F) F\n#define GATT_DATA(F) F\n#define GATT_ARENA(F) F\n'
+      '#endif\n#endif\n\n')
+
+    w('GATT_DATA(const uint16_t %s_uuidtable_16_map[]) = {\n' % PREFIX)
+    for uuid in db.uuid16:
+        w('  0x%04x,\n' % uuid)
+    w('};\n\n')
+    w('GATT_DATA(const uint8_t %s_uuidtable_128_map[]) = {\n' % PREFIX)
+    w((c_bytes(b''.join(db.uuid128)) if db.uuid128 else '  0x0 // IAR workaround for empty array')
+      + '\n};\n\n')
+
+    w('// Values of the dynamic attributes\n')
+    for name in ('init', 'zero'):
+        arena = layout.arenas[name]
+        if not arena:
+            continue
+        w('GATT_ARENA(static uint8_t %s_arena_%s[%d])' % (PREFIX, name, len(arena)))
+        if name == 'init':
+            w(' = {\n%s\n}' % c_bytes(bytes(arena)))
+        w(';\n')
+    w('\n')
+
+    for k, data in enumerate(layout.const_buffers):
+        w('GATT_DATA(const struct bg_gattdb_buffer_with_len %s_const_%d) = {\n' % (PREFIX, k))
+        w('  .len = %d,\n' % len(data))
+        if data:
+            w('  .data = { %s }\n' % ' '.join('0x%02x,' % b for b in data))
+        w('};\n')
+    w('\n')
+
+    for attribute in db.dynamic:
+        w('GATT_DATA(const struct bg_gattdb_attribute_chrvalue %s_value_%d) = {\n'
+          % (PREFIX, attribute.index))
+        w('  .properties = 0x%02x,\n  .index = %d,\n  .max_len = %d,\n'
+          % (attribute.properties, attribute.index, attribute.max_len))
+        if attribute.datatype == DATATYPE_USER:
+            w('  .data = NULL,\n')
+        else:
+            arena, offset = layout.offset_of[attribute.index]
+            if attribute.datatype == DATATYPE_DYNAMIC_VARLEN:
+                w('  .data_varlen = (struct bg_gattdb_buffer_with_len *)&%s_arena_%s[%d],\n'
+                  % (PREFIX, arena, offset))
+            else:
+                w('  .data = &%s_arena_%s[%d],\n' % (PREFIX, arena, offset))
+        w('};\n')
+    w('\n')
+
+    w('GATT_DATA(const struct bg_gattdb_attribute %s_attributes_map[]) = {\n' % PREFIX)
+    for i, attribute in enumerate(db.attributes):
+        w('  { .uuid = 0x%04x, .permissions = 0x%03x, .caps = 0xffff, .datatype = 0x%02x, '
+          '.min_key_size = 0x00, '
+          % (db.uuid_index(attribute.uuid), attribute.permissions, attribute.datatype))
+        if attribute.datatype == DATATYPE_CONST:
+            w('.constdata = &%s_const_%d },' % (PREFIX, layout.const_of[i]))
+        elif attribute.datatype == DATATYPE_CLIENTCONFIG:
+            w('.configdata = { .flags = 0x%02x, .index = 0x%02x, .clientconfig_index = 0x%02x } },'
+              % attribute.config)
+        else:
+            w('.dynamicdata = &%s_value_%d },' % (PREFIX, attribute.index))
+        w(' // %d\n' % (i + 1))
+    w('};\n\n')
+
+    w('GATT_DATA(const uint16_t %s_attributes_dynamic_mapping_map[]) = {\n' % PREFIX)
+    for attribute in db.dynamic:
+        w('  0x%04x,\n' % (db.attributes.index(attribute) + 1))
+    w('};\n\n')
+
+    adv16 = [u for u in db.advertised if len(u) == 2]
+    adv128 = [u for u in db.advertised if len(u) == 16]
+    for name, uuids in (('uuid16', adv16), ('uuid128', adv128)):
+        data = b''.join(uuids)
+        w('GATT_DATA(const uint8_t %s_adv_%s_map[]) = { %s };\n'
+          % (PREFIX, name, ' '.join('0x%02x,' % b for b in data) if data else '0x0'))
+    w('\n')
+
+    w('GATT_HEADER(const struct bg_gattdb_def %s) = {\n' % PREFIX)
+    w('  .attributes = %s_attributes_map,\n' % PREFIX)
+    w('  .attributes_max = %d,\n' % len(db.attributes))
+    w('  .uuidtable_16_size = %d,\n' % len(db.uuid16))
+    w('  .uuidtable_16 = %s_uuidtable_16_map,\n' % PREFIX)
+    w('  .uuidtable_128_size = %d,\n' % len(db.uuid128))
+    w('  .uuidtable_128 = %s_uuidtable_128_map,\n' % PREFIX)
+    w('  .attributes_dynamic_max = %d,\n' % len(db.dynamic))
+    w('  .attributes_dynamic_mapping = %s_attributes_dynamic_mapping_map,\n' % PREFIX)
+    w('  .adv_uuid16 = %s_adv_uuid16_map,\n' % PREFIX)
+    w('  .adv_uuid16_num = %d,\n' % len(adv16))
+    w('  .adv_uuid128 = %s_adv_uuid128_map,\n' % PREFIX)
+    w('  .adv_uuid128_num = %d,\n' % len(adv128))
+    w('  .caps_mask = 0xffff,\n')
+    w('  .enabled_caps = 0xffff,\n')
+    w('};\n\n')
+    w('const struct bg_gattdb_def *bg_gattdb = &%s;\n' % PREFIX)
+    write_lookup(db, prefix, out)
+
+
+def write_lookup(db, prefix, out):
+    w = out.write
+    if db.hash is not None:
+        w('\nconst uint8_t %sdatabase_hash_value[16] = {\n%s\n};\n' % (prefix, c_bytes(db.hash)))
+
+    handles = uuid_handles(db)
+    uuid16 = sorted((u[0] | (u[1] << 8), h) for u, h in handles.items() if len(u) == 2)
+    w('\n// UUID and handle, sorted by UUID\n')
+    w('static const uint16_t %suuid16_index[][2] = {\n' % prefix)
+    for uuid, handle in uuid16:
+        w('  { 0x%04x, %d },\n' % (uuid, handle))
+    w('};\n\n')
+    w('uint16_t %sfind_uuid16(uint16_t uuid)\n{\n' % prefix)
+    w('  uint16_t low = 0;\n  uint16_t high = %d;\n\n' % len(uuid16))
+    w('  while (low < high) {\n'
+      '    uint16_t mid = (low + high) / 2;\n\n'
+      '    if (%suuid16_index[mid][0] == uuid) {\n'
+      '      return %suuid16_index[mid][1];\n'
+      '    } else if (%suuid16_index[mid][0] < uuid) {\n'
+      '      low = mid + 1;\n'
+      '    } else {\n'
+      '      high = mid;\n'
+      '    }\n'
+      '  }\n'
+      '  return 0;\n}\n' % (prefix, prefix, prefix))
+
+    uuid128 = [(db.uuid128.index(u), h) for u, h in handles.items() if len(u) == 16]
+    w('\nuint16_t %sfind_uuid128(const uint8_t *uuid)\n{\n' % prefix)
+    if not uuid128:
+        w('  (void)uuid;\n  return 0;\n}\n')
+        return
+    seed, bits = perfect_hash([uuid128_key(db.uuid128[i]) for i, _ in uuid128])
+    slots = [(0, 0)] * (1 << bits)
+    for index, handle in uuid128:
+        slot = ((uuid128_key(db.uuid128[index]) * seed) & 0xffffffff) >> (32 - bits)
+        slots[slot] = (index, handle)
+    w('  // Index in the UUID table and handle, by the hash of the UUID\n')
+    w('  static const uint16_t slots[%d][2] = {\n' % len(slots))
+    for index, handle in slots:
+        w('    { %d, %d },\n' % (index, handle))
+    w('  };\n')
+    w('  uint32_t key = (uuid[0] | (uuid[1] << 8) | (uuid[2] << 16) | ((uint32_t)uuid[3] << 24))\n'
+      '                 ^ (uuid[12] | (uuid[13] << 8) | (uuid[14] << 16) | ((uint32_t)uuid[15] << 24));\n')
+    w('  const uint16_t *slot = slots[(uint32_t)(key * 0x%08xUL) >> %d];\n\n' % (seed, 32 - bits))
+    w('  if (slot[1] != 0\n'
+      '      && memcmp(&%s_uuidtable_128_map[16 * slot[0]], uuid, 16) == 0) {\n'
+      '    return slot[1];\n'
+      '  }\n'
+      '  return 0;\n}\n' % PREFIX)
+
+
+def write_h(db, source_name, prefix, out):
+    w = out.write
+    w('// Generated by gattdb.py from %s, do not edit.\n\n' % source_name)
+    w('#ifndef __GATT_DB_H\n#define __GATT_DB_H\n\n#include "bg_gattdb_def.h"\n\n')
+    w('extern const struct bg_gattdb_def %s;\n\n' % PREFIX)
+    if db.hash is not None:
+        w('// Database Hash, also the initial value of %sdatabase_hash\n' % prefix)
+        w('extern const uint8_t %sdatabase_hash_value[16];\n\n' % prefix)
+    w('// Handle of a service declaration, characteristic value or descriptor by\n'
+      '// its UUID, 0 if there is none. The first one if the UUID is used twice.\n')
+    w('uint16_t %sfind_uuid16(uint16_t uuid);\n' % prefix)
+    w('// uuid is 16 bytes, little endian\n')
+    w('uint16_t %sfind_uuid128(const uint8_t *uuid);\n\n' % prefix)
+    names = [(prefix + a.id, i + 1) for i, a in enumerate(db.attributes) if a.id]
+    width = max([len(n) for n, _ in names] + [0])
+    for name, handle in names:
+        w('#define %-*s %d\n' % (width, name, handle))
+    w('\n#endif\n')
+
+
+def access_param(attribute):
+    """Parameter list, length and byte array expression of an accessor."""
+    if attribute.datatype == DATATYPE_DYNAMIC and attribute.value_type == 'hex':
+        if attribute.length in (1, 2, 4):
+            ctype = 'uint%d_t' % (8 * attribute.length)
+            data = ', '.join(('(uint8_t)value' if i == 0 else '(uint8_t)(value >> %d)' % (8 * i))
+                             for i in range(attribute.length))
+            return '%s value' % ctype, str(attribute.length), '{ %s }' % data
+        return ('const uint8_t (*value)[%d]' % attribute.length, str(attribute.length), None)
+    return 'const uint8_t *value, uint8_t len', 'len', None
+
+
+def write_access_function(w, prefix, name, attribute, kind):
+    params, length, data = access_param(attribute)
+    if kind == 'write':
+        w('static inline uint16_t %swrite_%s(%s)\n{\n' % (prefix, name, params))
+        call = 'gecko_cmd_gatt_server_write_attribute_value(%s%s, 0, %s, %%s)->result' \
+               % (prefix, name, length)
+    else:
+        w('static inline uint16_t %snotify_%s(uint8_t connection, %s)\n{\n'
+          % (prefix, name, params))
+        call = 'gecko_cmd_gatt_server_send_characteristic_notification(connection, %s%s, %s, %%s)' \
+               '->result' % (prefix, name, length)
+    if data:
+        w('  const uint8_t data[%s] = %s;\n\n  return %s;\n}\n\n' % (length, data, call % 'data'))
+    elif length == 'len':
+        w('  return %s;\n}\n\n' % (call % 'value'))
+    else:
+        w('  return %s;\n}\n\n' % (call % '*value'))
+
+
+def write_access(db, source_name, prefix, header, out):
+    """Typed accessors of the characteristics and descriptors with an id.
+
+    Writes exist for the values stored by the stack, notifications for
+    characteristics which can notify or indicate. Integers of 1, 2 and 4
+    bytes are encoded little endian, other fixed length values are taken as
+    a pointer to an array of their length, so a value of another type or
+    size does not compile.
+    """
+    w = out.write
+    guard = '__' + os.path.basename(out.name).upper().replace('.', '_')
+    w('// Generated by gattdb.py from %s, do not edit.\n\n' % source_name)
+    w('#ifndef %s\n#define %s\n\n' % (guard, guard))
+    w('#include <stdint.h>\n#include "native_gecko.h"\n#include "%s"\n\n' % header)
+    for attribute in db.attributes:
+        if not attribute.id or not attribute.name:
+            continue
+        write = attribute.datatype in (DATATYPE_DYNAMIC, DATATYPE_DYNAMIC_VARLEN)
+        notify = attribute.char_properties & (PROP_NOTIFY | PROP_INDICATE)
+        if not write and not notify:
+            continue
+        size = ('up to %d bytes' % attribute.length
+                if access_param(attribute)[1] == 'len' else '%d bytes' % attribute.length)
+        w('// %s, %s\n' % (attribute.name, size))
+        if write:
+            write_access_function(w, prefix, attribute.id, attribute, 'write')
+        if notify:
+            write_access_function(w, prefix, attribute.id, attribute, 'notify')
+    w('#endif\n')
+
+
+def report(db, layout, out):
+    """Memory use of the generated tables against the configurator layout."""
+    const_sizes = [align(2 + len(d), 2) for d in layout.const_buffers]
+    stored = [a for a in db.dynamic if a.datatype != DATATYPE_USER]
+    config_layout_ram = sum(align(2 + a.max_len if a.datatype == DATATYPE_DYNAMIC_VARLEN
+                                  else a.max_len, 4) for a in stored)
+    config_layout_const = sum(align(2 + len(a.data), 4) for a in db.attributes
+                              if a.datatype == DATATYPE_CONST)
+    arena_init = len(layout.arenas['init'])
+    arena_zero = len(layout.arenas['zero'])
+    rows = [
+        ('attributes', len(db.attributes), len(db.attributes) * SIZEOF_ATTRIBUTE, 0),
+        ('16-bit UUIDs', len(db.uuid16), 2 * len(db.uuid16), 0),
+        ('128-bit UUIDs', len(db.uuid128), 16 * len(db.uuid128), 0),
+        ('constant values', len(layout.const_buffers), sum(const_sizes), 0),
+        ('dynamic attributes', len(db.dynamic), (SIZEOF_CHRVALUE + 2) * len(db.dynamic), 0),
+        ('initialized values', None, arena_init, arena_init),
+        ('zeroed values', None, 0, arena_zero),
+    ]
+    out.write('%-20s %6s %6s %6s\n' % ('', 'count', 'flash', 'ram'))
+    for name, count, flash, ram in rows:
+        out.write('%-20s %6s %6d %6d\n' % (name, '' if count is None else count, flash, ram))
+    out.write('%-20s %6s %6d %6d\n' % ('total', '', sum(r[2] for r in rows), sum(r[3] for r in rows)))
+    constants = len([a for a in db.attributes if a.datatype == DATATYPE_CONST])
+    out.write('\n%d constant values stored as %d, %d bytes instead of %d\n'
+              % (constants, len(layout.const_buffers), sum(const_sizes), config_layout_const))
+    out.write('dynamic values take %d bytes of RAM instead of %d with an array each\n'
+              % (arena_init + arena_zero, config_layout_ram))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('xml', help='gatt.xml')
+    parser.add_argument('-o', '--output', help='C file, default: the out attribute of gatt.xml')
+    parser.add_argument('--header', help='header file, default: the header attribute of gatt.xml')
+    parser.add_argument('--access', metavar='HEADER',
+                        help='also write typed write and notify functions to this header')
+    parser.add_argument('--report', action='store_true', help='print the memory use')
+    args = parser.parse_args()
+
+    try:
+        root = ET.parse(args.xml).getroot()
+        db = Database(root)
+    except (IOError, ET.ParseError, GattError, ValueError) as e:
+        sys.exit('%s: %s' % (args.xml, e))
+    layout = Layout(db)
+
+    base = os.path.dirname(args.xml)
+    source_name = os.path.basename(args.xml)
+    output = args.output or os.path.join(base, root.get('out', 'gatt_db.c'))
+    header = args.header or os.path.join(base, root.get('header', 'gatt_db.h'))
+    prefix = root.get('prefix', 'gattdb_')
+    with open(output, 'w', newline='\n') as out:
+        write_c(db, layout, source_name, prefix, out)
+    with open(header, 'w', newline='\n') as out:
+        write_h(db, source_name, prefix, out)
+    if args.access:
+        with open(args.access, 'w', newline='\n') as out:
+            write_access(db, source_name, prefix, os.path.basename(header), out)
+    if args.report:
+        report(db, layout, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,406 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host test of the IEEE 11073 SFLOAT and FLOAT conversions
+ *
+ * Checks BLE-soc-basic/ieee11073.c against exact integer arithmetic:
+ * - every one of the 65536 SFLOATs decoded at every exponent, and encoded
+ *   back from its own mantissa and exponent
+ * - the encoding of every value with up to 6 digits and of the values
+ *   around each rounding tie, mantissa limit and power of ten of the int32_t
+ *   range, at the exponents around the ends of both ranges
+ * - FLOATs at the ends of the mantissa and exponent ranges, and random ones
+ * - the array encoders against the scalar ones
+ *
+ * An encoded value must be the input rounded half away from zero at the
+ * smallest exponent which fits it, or the next exponents of the range, 0 if
+ * it rounds to 0 at the smallest exponent and infinity if it does not fit
+ * the largest one.
+ *
+ *   cc -O2 -IBLE-soc-basic tools/ieee11073_test.c BLE-soc-basic/ieee11073.c -o ieee11073_test
+ *   ./ieee11073_test
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ieee11073.h"
+
+typedef __int128 wide_t;
+
+typedef struct {
+  const char *name;
+  int32_t mantissa_max;
+  int32_t exponent_min;
+  int32_t exponent_max;
+  int mantissa_bits;
+} format_t;
+
+static const format_t sfloat_format = {
+  "SFLOAT", IEEE11073_SFLOAT_MANTISSA_MAX, IEEE11073_SFLOAT_EXPONENT_MIN,
+  IEEE11073_SFLOAT_EXPONENT_MAX, 12
+};
+static const format_t float_format = {
+  "FLOAT", IEEE11073_FLOAT_MANTISSA_MAX, IEEE11073_FLOAT_EXPONENT_MIN,
+  IEEE11073_FLOAT_EXPONENT_MAX, 24
+};
+
+static unsigned long checks = 0;
+static unsigned long failures = 0;
+
+#define CHECK(cond, ...)                       \
+  do {                                         \
+    checks++;                                  \
+    if (!(cond)) {                             \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                     \
+      printf("\n");                            \
+      if (++failures > 20) {                   \
+        exit(1);                               \
+      }                                        \
+    }                                          \
+  } while (0)
+
+static wide_t pow10w(int n)
+{
+  wide_t p = 1;
+
+  while (n-- > 0) {
+    p *= 10;
+  }
+  return p;
+}
+
+static wide_t abs_w(wide_t v)
+{
+  return v < 0 ? -v : v;
+}
+
+// Reference division by 10^digits rounding half away from zero
+static wide_t div_round(wide_t v, int digits)
+{
+  wide_t p;
+  wide_t q;
+
+  if (digits <= 0) {
+    return v;
+  }
+  if (digits > 36) {
+    // every int32_t * 10^4 is below 0.5 * 10^36
+    return 0;
+  }
+  p = pow10w(digits);
+  q = abs_w(v) / p;
+  if (2 * (abs_w(v) % p) >= p) {
+    q++;
+  }
+  return v < 0 ? -q : q;
+}
+
+// Reference fixed point value of m * 10^e at exponent x, false if it is out
+// of the int32_t range
+static bool ref_decode(int32_t m, int32_t e, int32_t x, int32_t *value)
+{
+  wide_t v;
+
+  if (m == 0) {
+    *value = 0;
+    return true;
+  }
+  if (e >= x) {
+    if (e - x > 10) {
+      return false;
+    }
+    v = (wide_t)m * pow10w(e - x);
+  } else {
+    v = div_round(m, x - e);
+  }
+  if (v > INT32_MAX || v < INT32_MIN) {
+    return false;
+  }
+  *value = (int32_t)v;
+  return true;
+}
+
+static void split_sfloat(uint16_t s, int32_t *m, int32_t *e)
+{
+  *m = (int32_t)((s & 0x0fffU) ^ 0x0800U) - 0x0800;
+  *e = (int32_t)((s >> 12) ^ 0x8U) - 0x8;
+}
+
+static void split_float(uint32_t f, int32_t *m, int32_t *e)
+{
+  *m = (int32_t)((f & 0x00ffffffUL) ^ 0x00800000UL) - 0x00800000L;
+  *e = (int8_t)(f >> 24);
+}
+
+static bool sfloat_special(uint16_t s)
+{
+  uint16_t raw = s & 0x0fffU;
+  return raw >= IEEE11073_SFLOAT_POSITIVE_INF && raw <= IEEE11073_SFLOAT_NEGATIVE_INF;
+}
+
+static bool float_special(uint32_t f)
+{
+  uint32_t raw = f & 0x00ffffffUL;
+  return raw >= IEEE11073_FLOAT_POSITIVE_INF && raw <= IEEE11073_FLOAT_NEGATIVE_INF;
+}
+
+// Check an encoding of value * 10^x given as mantissa and exponent, or as
+// infinity in the direction of inf
+static void check_encoding(const format_t *fmt, int32_t value, int32_t x,
+                           int inf, int32_t m, int32_t e)
+{
+  // smallest exponent at which the rounded value fits the mantissa
+  int32_t fit = x;
+  wide_t rounded;
+
+  while (abs_w(div_round(value, fit - x)) > fmt->mantissa_max) {
+    fit++;
+  }
+  if (fit < fmt->exponent_min) {
+    fit = fmt->exponent_min;
+  }
+  rounded = div_round(value, fit - x);
+
+  if (inf) {
+    // does not fit even with the mantissa as large as possible
+    CHECK(rounded != 0 && fit > fmt->exponent_max
+          && (fit - fmt->exponent_max > 7
+              || abs_w(rounded) * pow10w(fit - fmt->exponent_max) > fmt->mantissa_max)
+          && (inf > 0) == (value > 0),
+          "%s %d e%d: infinity", fmt->name, value, x);
+    return;
+  }
+  CHECK(m >= -fmt->mantissa_max && m <= fmt->mantissa_max,
+        "%s %d e%d: mantissa %d", fmt->name, value, x, m);
+  CHECK(e >= fmt->exponent_min && e <= fmt->exponent_max,
+        "%s %d e%d: exponent %d", fmt->name, value, x, e);
+  if (rounded == 0) {
+    CHECK(m == 0 && e == 0, "%s %d e%d: %d e%d instead of 0", fmt->name, value, x, m, e);
+    return;
+  }
+  // the same value as the rounded one, digits moved back into the mantissa
+  // only to stay below the largest exponent
+  if (fit <= fmt->exponent_max) {
+    CHECK(m == rounded && e == fit, "%s %d e%d: %d e%d instead of %lld e%d",
+          fmt->name, value, x, m, e, (long long)rounded, fit);
+  } else {
+    CHECK(e == fmt->exponent_max && (wide_t)m == rounded * pow10w(fit - e),
+          "%s %d e%d: %d e%d instead of %lld e%d", fmt->name, value, x, m, e,
+          (long long)rounded, fit);
+  }
+}
+
+static void check_sfloat_encode(int32_t value, int32_t x)
+{
+  uint16_t s = ieee11073_sfloat_encode(value, (int8_t)x);
+  int32_t m;
+  int32_t e;
+  int inf = 0;
+
+  if (s == IEEE11073_SFLOAT_POSITIVE_INF) {
+    inf = 1;
+  } else if (s == IEEE11073_SFLOAT_NEGATIVE_INF) {
+    inf = -1;
+  } else {
+    CHECK(!sfloat_special(s), "SFLOAT %d e%d: special 0x%04x", value, x, s);
+  }
+  split_sfloat(s, &m, &e);
+  check_encoding(&sfloat_format, value, x, inf, m, e);
+}
+
+static void check_float_encode(int32_t value, int32_t x)
+{
+  uint32_t f = ieee11073_float_encode(value, (int8_t)x);
+  int32_t m;
+  int32_t e;
+  int inf = 0;
+
+  if (f == IEEE11073_FLOAT_POSITIVE_INF) {
+    inf = 1;
+  } else if (f == IEEE11073_FLOAT_NEGATIVE_INF) {
+    inf = -1;
+  } else {
+    CHECK(!float_special(f), "FLOAT %d e%d: special 0x%08lx", value, x, (unsigned long)f);
+  }
+  split_float(f, &m, &e);
+  check_encoding(&float_format, value, x, inf, m, e);
+}
+
+static void check_encode(int32_t value, int32_t x)
+{
+  check_sfloat_encode(value, x);
+  check_float_encode(value, x);
+}
+
+static void test_all_sfloats(void)
+{
+  for (uint32_t s = 0; s <= 0xffff; s++) {
+    int32_t m;
+    int32_t e;
+    int32_t value;
+    int32_t expected;
+    bool ok;
+
+    split_sfloat((uint16_t)s, &m, &e);
+    for (int32_t x = INT8_MIN; x <= INT8_MAX; x++) {
+      ok = ieee11073_sfloat_decode((uint16_t)s, (int8_t)x, &value);
+      if (sfloat_special((uint16_t)s)) {
+        CHECK(!ok, "SFLOAT 0x%04x e%d: special decoded", s, x);
+      } else if (ref_decode(m, e, x, &expected)) {
+        CHECK(ok && value == expected, "SFLOAT 0x%04x e%d: %d instead of %d", s, x,
+              ok ? value : 0, expected);
+      } else {
+        CHECK(!ok, "SFLOAT 0x%04x e%d: out of range decoded", s, x);
+      }
+    }
+    if (!sfloat_special((uint16_t)s)) {
+      // back from its own mantissa and exponent, and scaled ones
+      check_encode(m, e);
+      for (int32_t x = e - 6; x < e; x++) {
+        check_encode(m * (int32_t)pow10w(e - x), x);
+      }
+    }
+  }
+}
+
+static void test_float_decode(void)
+{
+  static const int32_t mantissas[] = {
+    0, 1, -1, 2, 5, -5, 9, 10, 15, -15, 25, 99, 100, 12345, -12345, 5000000,
+    IEEE11073_FLOAT_MANTISSA_MAX, -IEEE11073_FLOAT_MANTISSA_MAX,
+    IEEE11073_FLOAT_MANTISSA_MAX - 1, -IEEE11073_FLOAT_MANTISSA_MAX + 1,
+    (int32_t)0x800003 - 0x1000000, 4294967, -4294967, 2147483, -2147483, 2147484, -2147484
+  };
+  static const uint32_t specials[] = {
+    IEEE11073_FLOAT_NAN, IEEE11073_FLOAT_NRES, IEEE11073_FLOAT_POSITIVE_INF,
+    IEEE11073_FLOAT_NEGATIVE_INF, 0x00800001UL
+  };
+  int32_t value;
+  int32_t expected;
+  bool ok;
+
+  for (size_t i = 0; i < sizeof(mantissas) / sizeof(mantissas[0]); i++) {
+    for (int32_t e = INT8_MIN; e <= INT8_MAX; e++) {
+      uint32_t f = IEEE11073_FLOAT(mantissas[i], e);
+      for (int32_t x = INT8_MIN; x <= INT8_MAX; x++) {
+        ok = ieee11073_float_decode(f, (int8_t)x, &value);
+        if (ref_decode(mantissas[i], e, x, &expected)) {
+          CHECK(ok && value == expected, "FLOAT %d e%d at e%d: %d instead of %d",
+                mantissas[i], e, x, ok ? value : 0, expected);
+        } else {
+          CHECK(!ok, "FLOAT %d e%d at e%d: out of range decoded", mantissas[i], e, x);
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < sizeof(specials) / sizeof(specials[0]); i++) {
+    for (int32_t e = INT8_MIN; e <= INT8_MAX; e++) {
+      CHECK(!ieee11073_float_decode(specials[i] | ((uint32_t)(uint8_t)e << 24), 0, &value),
+            "FLOAT special 0x%06lx e%d decoded", (unsigned long)specials[i], e);
+    }
+  }
+}
+
+static void test_encode_boundaries(void)
+{
+  static const int32_t exponents[] = {
+    -128, -127, -126, -20, -16, -15, -14, -13, -12, -11, -10, -9, -8, -7, -6, -5, -4,
+    -3, -2, -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 120, 121, 122, 123, 124, 125, 126, 127
+  };
+
+  for (size_t i = 0; i < sizeof(exponents) / sizeof(exponents[0]); i++) {
+    int32_t x = exponents[i];
+
+    // every value with up to 6 digits at the ends of the SFLOAT range
+    if (x >= -14 && x <= 10) {
+      for (int32_t v = -999999; v <= 999999; v++) {
+        check_sfloat_encode(v, x);
+      }
+    }
+    for (int32_t v = -3000; v <= 3000; v++) {
+      check_float_encode(v, x);
+    }
+    // around the powers of ten, the ties and the mantissa limits of both
+    // formats scaled to every digit count of the int32_t range
+    for (int d = 0; d <= 9; d++) {
+      int64_t p = (int64_t)pow10w(d);
+      int64_t centers[] = {
+        p, 5 * p, 15 * p, 25 * p, IEEE11073_SFLOAT_MANTISSA_MAX * p,
+        (IEEE11073_SFLOAT_MANTISSA_MAX + 1) * p, 2 * IEEE11073_SFLOAT_MANTISSA_MAX * p,
+        (int64_t)IEEE11073_FLOAT_MANTISSA_MAX * p, (int64_t)(IEEE11073_FLOAT_MANTISSA_MAX + 1) * p,
+        20455 * p / 10, 83886055 * p / 10, INT32_MAX
+      };
+      for (size_t c = 0; c < sizeof(centers) / sizeof(centers[0]); c++) {
+        for (int64_t v = centers[c] - 3; v <= centers[c] + 3; v++) {
+          if (v <= INT32_MAX && -v >= INT32_MIN) {
+            check_encode((int32_t)v, x);
+            check_encode((int32_t)-v, x);
+          }
+        }
+      }
+    }
+    check_encode(INT32_MIN, x);
+  }
+}
+
+static void test_encode_random(void)
+{
+  uint32_t state = 2463534242UL;
+
+  for (int i = 0; i < 20000000; i++) {
+    // xorshift32, a uniform exponent and a value of a uniform digit count
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    int32_t x = (int8_t)(state >> 24);
+    int32_t v = (int32_t)(state ^ (state << 7)) >> (state % 31);
+    check_encode(v, x);
+  }
+}
+
+static void test_arrays(void)
+{
+  int32_t values[] = { 0, 1, -1, 2045, 2046, -2046, 123456, -8388605, 8388606, INT32_MAX, INT32_MIN };
+  size_t count = sizeof(values) / sizeof(values[0]);
+  uint8_t out[4 * sizeof(values) / sizeof(values[0])];
+
+  for (int32_t x = -3; x <= 3; x++) {
+    CHECK(ieee11073_sfloat_encode_array(out, values, (int8_t)x, count) == out + 2 * count,
+          "SFLOAT array end");
+    for (size_t i = 0; i < count; i++) {
+      CHECK((out[2 * i] | (out[2 * i + 1] << 8)) == ieee11073_sfloat_encode(values[i], (int8_t)x),
+            "SFLOAT array %zu e%d", i, x);
+    }
+    CHECK(ieee11073_float_encode_array(out, values, (int8_t)x, count) == out + 4 * count,
+          "FLOAT array end");
+    for (size_t i = 0; i < count; i++) {
+      uint32_t f = out[4 * i] | (out[4 * i + 1] << 8) | (out[4 * i + 2] << 16)
+                   | ((uint32_t)out[4 * i + 3] << 24);
+      CHECK(f == ieee11073_float_encode(values[i], (int8_t)x), "FLOAT array %zu e%d", i, x);
+    }
+  }
+}
+
+static void test_constants(void)
+{
+  // the macros give the same values as the encoders
+  CHECK(IEEE11073_SFLOAT(-1234, -2) == ieee11073_sfloat_encode(-1234, -2), "SFLOAT macro");
+  CHECK(IEEE11073_SFLOAT(2045, 7) == ieee11073_sfloat_encode(2045, 7), "SFLOAT macro max");
+  CHECK(IEEE11073_SFLOAT(-5, -8) == ieee11073_sfloat_encode(-5, -8), "SFLOAT macro min");
+  CHECK(IEEE11073_FLOAT(-1234567, -3) == ieee11073_float_encode(-1234567, -3), "FLOAT macro");
+  CHECK(IEEE11073_FLOAT(8388605, 127) == ieee11073_float_encode(8388605, 127), "FLOAT macro max");
+  CHECK(IEEE11073_FLOAT(-1, -128) == ieee11073_float_encode(-1, -128), "FLOAT macro min");
+}
+
+int main(void)
+{
+  test_constants();
+  test_all_sfloats();
+  test_float_decode();
+  test_encode_boundaries();
+  test_encode_random();
+  test_arrays();
+  printf("%s, %lu checks, %lu failures\n", failures ? "FAIL" : "PASS", checks, failures);
+  return failures ? 1 : 0;
+}